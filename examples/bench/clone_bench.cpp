@@ -0,0 +1,203 @@
+// Micro-benchmark: time per model clone with each of the clone paths of
+// efscape::impl::cloneModel().
+//
+//   json    cloneModelUsingJSON: a cereal JSON archive written to a string
+//           and parsed back (the former clone path)
+//   binary  a binary snapshot (saveAdevsToBinary) written to and read back
+//           from a reused memory buffer (the fallback for models without a
+//           deep copy)
+//   clone   cloneModel(): the deep copy of models that are Cloneable
+//
+// Two models are cloned: the gpt example (a CompiledDigraph of a genr, a
+// proc and a transd), and a synthetic CompiledDigraph of N atomic models
+// (10,000 by default) coupled in a ring.
+#include <efscape/impl/efscapelib.hpp>
+#include <efscape/impl/Cloneable.hpp>
+#include <efscape/impl/CompiledDigraph.hpp>
+#include <efscape/utils/MemoryBuffer.hpp>
+
+#include <gpt/genr.hpp>
+#include <gpt/proc.hpp>
+#include <gpt/transd.hpp>
+
+#include <adevs_cereal.hpp>
+#include <cereal/types/base_class.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using efscape::impl::DEVS;
+using efscape::impl::DEVSPtr;
+using efscape::impl::IO_Type;
+using efscape::impl::PortType;
+
+//----------------------------------------------------------------------------
+// synthetic atomic model, with a little state to copy
+//----------------------------------------------------------------------------
+class cell : public adevs::Atomic<IO_Type>,
+	     public efscape::impl::CerealCloneable<cell>
+{
+public:
+  cell() : mi_count(0), md_value(0.), mC1_history(8, 0.) {}
+  explicit cell(int ai_id) : mi_count(ai_id), md_value(0.5*ai_id),
+			     mC1_history(8, 0.25*ai_id) {}
+
+  void delta_int() { mi_count++; }
+  void delta_ext(double e, const adevs::Bag<IO_Type>& xb) { md_value += e; }
+  void delta_conf(const adevs::Bag<IO_Type>& xb) { delta_int(); }
+  void output_func(adevs::Bag<IO_Type>& yb) {}
+  double ta() { return 1.; }
+  void gc_output(adevs::Bag<IO_Type>& g) {}
+
+  static const PortType in;
+  static const PortType out;
+
+private:
+  friend class cereal::access;
+
+  template<class Archive>
+  void serialize(Archive & ar)
+  {
+    ar( cereal::make_nvp("adevs::Atomic",
+			 cereal::base_class<DEVS>(this) ),
+	CEREAL_NVP(mi_count),
+	CEREAL_NVP(md_value),
+	CEREAL_NVP(mC1_history) );
+  }
+
+  int mi_count;
+  double md_value;
+  std::vector<double> mC1_history;
+};
+
+const PortType cell::in("in");
+const PortType cell::out("out");
+
+namespace cereal
+{
+  template <class Archive>
+  struct specialize<Archive, cell, cereal::specialization::member_serialize> {};
+}
+
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/archives/json.hpp>
+#include <cereal/archives/xml.hpp>
+CEREAL_REGISTER_TYPE(cell);
+CEREAL_REGISTER_POLYMORPHIC_RELATION(efscape::impl::ATOMIC, cell);
+
+//----------------------------------------------------------------------------
+// models
+//----------------------------------------------------------------------------
+DEVSPtr make_gpt()
+{
+  efscape::impl::CompiledDigraph* lCp_digraph =
+    new efscape::impl::CompiledDigraph;
+  gpt::genr* lCp_genr = new gpt::genr(1.0);
+  gpt::transd* lCp_transd = new gpt::transd(10.0);
+  gpt::proc* lCp_proc = new gpt::proc(2.0);
+  lCp_digraph->add(lCp_genr);
+  lCp_digraph->add(lCp_transd);
+  lCp_digraph->add(lCp_proc);
+  lCp_digraph->couple(lCp_genr, gpt::genr::out, lCp_transd, gpt::transd::ariv);
+  lCp_digraph->couple(lCp_genr, gpt::genr::out, lCp_proc, gpt::proc::in);
+  lCp_digraph->couple(lCp_proc, gpt::proc::out, lCp_transd, gpt::transd::solved);
+  lCp_digraph->couple(lCp_transd, gpt::transd::out, lCp_genr, gpt::genr::stop);
+  return DEVSPtr(lCp_digraph);
+}
+
+DEVSPtr make_ring(int ai_atomics)
+{
+  efscape::impl::CompiledDigraph* lCp_digraph =
+    new efscape::impl::CompiledDigraph;
+  std::vector<cell*> lC1_cells;
+  for (int i = 0; i < ai_atomics; i++) {
+    lC1_cells.push_back(new cell(i));
+    lCp_digraph->add(lC1_cells.back());
+  }
+  for (int i = 0; i < ai_atomics; i++)
+    lCp_digraph->couple(lC1_cells[i], cell::out,
+			lC1_cells[(i+1) % ai_atomics], cell::in);
+  if (ai_atomics > 0) {
+    lCp_digraph->couple(lCp_digraph, cell::in, lC1_cells[0], cell::in);
+    lCp_digraph->couple(lC1_cells.back(), cell::out, lCp_digraph, cell::out);
+  }
+  return DEVSPtr(lCp_digraph);
+}
+
+//----------------------------------------------------------------------------
+// clone paths
+//----------------------------------------------------------------------------
+DEVSPtr clone_binary(const DEVSPtr& aCp_model)
+{
+  static efscape::utils::MemoryBuffer lC_buffer;
+  lC_buffer.reset();
+  {
+    std::ostream lC_out(&lC_buffer);
+    efscape::impl::saveAdevsToBinary(aCp_model, lC_out);
+  }
+  lC_buffer.rewind();
+  std::istream lC_in(&lC_buffer);
+  return efscape::impl::loadAdevsFromBinary(lC_in);
+}
+
+// returns the time per clone (in microseconds), or a negative time if the
+// clone path fails
+double time_clone(const std::function<DEVSPtr(const DEVSPtr&)>& aCr_clone,
+		  const DEVSPtr& aCp_model, int ai_clones)
+{
+  std::chrono::steady_clock::time_point lC_t0 =
+    std::chrono::steady_clock::now();
+  for (int i = 0; i < ai_clones; i++) {
+    DEVSPtr lCp_clone = aCr_clone(aCp_model);
+    if (!lCp_clone)
+      return -1.;
+  }
+  std::chrono::steady_clock::time_point lC_t1 =
+    std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::micro>(lC_t1 - lC_t0).count()/
+    ai_clones;
+}
+
+void report(const char* acp_name, const DEVSPtr& aCp_model, int ai_clones)
+{
+  double ld_json = time_clone(efscape::impl::cloneModelUsingJSON, aCp_model,
+			      ai_clones);
+  double ld_binary = time_clone(clone_binary, aCp_model, ai_clones);
+  double ld_clone = time_clone(efscape::impl::cloneModel, aCp_model,
+			       ai_clones);
+
+  std::cout << std::left << std::setw(12) << acp_name << std::right
+	    << std::fixed << std::setprecision(1)
+	    << std::setw(14) << ld_json
+	    << std::setw(14) << ld_binary
+	    << std::setw(14) << ld_clone
+	    << std::setw(10) << std::setprecision(1)
+	    << (ld_clone > 0. ? ld_json/ld_clone : 0.) << "x" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  int li_atomics = (argc > 1 ? std::atoi(argv[1]) : 10000);
+  int li_clones = (argc > 2 ? std::atoi(argv[2]) : 20);
+
+  std::cout << "clones per run: " << li_clones
+	    << " (gpt: " << li_clones*100 << ")\n\n"
+	    << std::left << std::setw(12) << "model" << std::right
+	    << std::setw(14) << "us/json"
+	    << std::setw(14) << "us/binary"
+	    << std::setw(14) << "us/clone"
+	    << std::setw(11) << "speedup" << std::endl;
+
+  report("gpt", make_gpt(), li_clones*100);
+  report(("ring-" + std::to_string(li_atomics)).c_str(),
+	 make_ring(li_atomics), li_clones);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,184 @@
+// Micro-benchmark: heap allocations and time per port event when the port
+// value is held by boost::any versus efscape::impl::Payload.
+//
+// Each "event" follows the path a value takes through a simulation step:
+// it is wrapped in a port value, inserted into an output bag, copied into
+// the input bag of the receiving model, and finally read back by the
+// receiver. Bags are reused between events, as the adevs simulator does.
+//
+// Json::Value rows show the cost of deep-copying a document at each hop;
+// SharedJson rows show the same document passed as a shared handle.
+#include <adevs.h>
+
+#include <efscape/impl/PortSymbol.hpp>
+#include <efscape/impl/Payload.hpp>
+#include <efscape/impl/SharedJson.hpp>
+
+#include <gpt/job.hpp>
+
+#include <boost/any.hpp>
+#include <json/json.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+
+//----------------------------------------------------------------------------
+// allocation counter
+//----------------------------------------------------------------------------
+static unsigned long long gl_allocations = 0;
+
+void* operator new(std::size_t size)
+{
+  ++gl_allocations;
+  if (void* p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+//----------------------------------------------------------------------------
+// value access for each holder type
+//----------------------------------------------------------------------------
+template <typename T>
+const T* get_value(const boost::any& aCr_value)
+{
+  return boost::any_cast<T>(&aCr_value);
+}
+
+template <typename T>
+const T* get_value(const efscape::impl::Payload& aCr_value)
+{
+  return aCr_value.get<T>();
+}
+
+// folds a value into a checksum so the work cannot be optimized away
+inline double fold(double x) { return x; }
+inline double fold(const gpt::job& j) { return j.id + j.t; }
+inline double fold(const Json::Value& v) { return v["id"].asDouble(); }
+inline double fold(const efscape::impl::SharedJson& v) { return fold(*v); }
+
+inline gpt::job make_value(gpt::job*, int i)
+{
+  gpt::job j(i);
+  j.t = 0.5*i;
+  return j;
+}
+
+inline double make_value(double*, int i) { return 0.5*i; }
+
+inline Json::Value make_value(Json::Value*, int i)
+{
+  Json::Value v;
+  v["event"] = "start job";
+  v["id"] = i;
+  v["time"] = 0.5*i;
+  return v;
+}
+
+inline efscape::impl::SharedJson make_value(efscape::impl::SharedJson*, int i)
+{
+  return efscape::impl::SharedJson( make_value((Json::Value*)0, i) );
+}
+
+struct Result
+{
+  double allocs_per_event;
+  double ns_per_event;
+  double checksum;
+};
+
+template <typename Holder, typename T>
+Result run(int ai_events)
+{
+  typedef adevs::PortValue<Holder, efscape::impl::PortSymbol> PortValue;
+
+  const efscape::impl::PortSymbol lC_out("out");
+  const efscape::impl::PortSymbol lC_in("in");
+
+  adevs::Bag<PortValue> lC_output;
+  adevs::Bag<PortValue> lC_input;
+
+  // warm up: let the bags reach their steady-state capacity
+  for (int i = 0; i < 16; i++) {
+    lC_output.insert(PortValue(lC_out, make_value((T*)0, i)));
+    lC_input.insert(PortValue(lC_in, make_value((T*)0, i)));
+  }
+  lC_output.clear();
+  lC_input.clear();
+
+  // values are built outside of the timed loop: only the cost of moving
+  // them through the bags is measured
+  T lC_value = make_value((T*)0, 1);
+
+  Result lC_result = { 0., 0., 0. };
+  unsigned long long ll_start = gl_allocations;
+  std::chrono::steady_clock::time_point lC_t0 =
+    std::chrono::steady_clock::now();
+
+  for (int i = 0; i < ai_events; i++) {
+    lC_output.insert(PortValue(lC_out, lC_value));	// output_func
+    for (typename adevs::Bag<PortValue>::iterator iter = lC_output.begin();
+	 iter != lC_output.end(); iter++)		// routing
+      lC_input.insert(PortValue(lC_in, (*iter).value));
+    for (typename adevs::Bag<PortValue>::iterator iter = lC_input.begin();
+	 iter != lC_input.end(); iter++) {		// delta_ext
+      if ((*iter).port == lC_in) {
+	const T* lCp_value = get_value<T>((*iter).value);
+	if (lCp_value)
+	  lC_result.checksum += fold(*lCp_value);
+      }
+    }
+    lC_output.clear();
+    lC_input.clear();
+  }
+
+  std::chrono::steady_clock::time_point lC_t1 =
+    std::chrono::steady_clock::now();
+  lC_result.allocs_per_event =
+    double(gl_allocations - ll_start)/ai_events;
+  lC_result.ns_per_event =
+    std::chrono::duration<double, std::nano>(lC_t1 - lC_t0).count()/ai_events;
+
+  return lC_result;
+}
+
+template <typename T>
+void report(const char* acp_name, int ai_events)
+{
+  Result lC_any = run<boost::any, T>(ai_events);
+  Result lC_payload = run<efscape::impl::Payload, T>(ai_events);
+
+  std::cout << std::left << std::setw(12) << acp_name << std::right
+	    << std::fixed << std::setprecision(2)
+	    << std::setw(12) << lC_any.allocs_per_event
+	    << std::setw(12) << lC_payload.allocs_per_event
+	    << std::setw(12) << std::setprecision(1) << lC_any.ns_per_event
+	    << std::setw(12) << lC_payload.ns_per_event
+	    << (lC_any.checksum == lC_payload.checksum ? "" : "  MISMATCH")
+	    << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  int li_events = (argc > 1 ? std::atoi(argv[1]) : 1000000);
+
+  std::cout << "events per run: " << li_events << "\n\n"
+	    << std::left << std::setw(12) << "value" << std::right
+	    << std::setw(12) << "allocs/any"
+	    << std::setw(12) << "allocs/pl"
+	    << std::setw(12) << "ns/any"
+	    << std::setw(12) << "ns/pl" << std::endl;
+
+  report<double>("double", li_events);
+  report<gpt::job>("gpt::job", li_events);
+  report<Json::Value>("Json::Value", li_events/10);
+  report<efscape::impl::SharedJson>("SharedJson", li_events);
+
+  return EXIT_SUCCESS;
+}
@@ -144,13 +144,20 @@ namespace gpt {
       std::shared_ptr<efscape::impl::DEVS> lCp_model;
       lCp_model.reset( efscape::impl::buildModelFromJSON(lC_config) );
 
-      // serialize model to snapshot file prior to run
+      // serialize model to snapshot file prior to run (an efscape binary
+      // snapshot if <out_file> has the .efb extension)
+      bool lb_binary = (lC_out_file_path.extension().string() == ".efb");
       fs::path lC_archive_file_path =
         lC_out_file_path.parent_path().string() +
-        lC_out_file_path.stem().string() + ".json";
+        lC_out_file_path.stem().string() + (lb_binary ? ".efb" : ".json");
 
-      std::ofstream lC_archive_file(lC_archive_file_path.string());
-      {
+      if (lb_binary) {
+	std::ofstream lC_archive_file(lC_archive_file_path.string(),
+				      std::ios::out | std::ios::binary);
+	efscape::impl::saveAdevsToBinary(lCp_model, lC_archive_file);
+      }
+      else {
+	std::ofstream lC_archive_file(lC_archive_file_path.string());
 	efscape::impl::saveAdevsToJSON(lCp_model, lC_archive_file);
       }
 
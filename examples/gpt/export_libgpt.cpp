@@ -34,6 +34,7 @@ namespace cereal
   struct specialize<Archive, gpt::transd, cereal::specialization::member_serialize> {};
 }
 
+#include <cereal/archives/portable_binary.hpp>
 #include <cereal/archives/json.hpp>
 #include <cereal/archives/xml.hpp>
 CEREAL_REGISTER_TYPE(gpt::genr);
@@ -120,8 +120,10 @@ namespace gpt {
       if ((*iter).port == properties_in) {
 	LOG4CXX_DEBUG(efscape::impl::ModelHomeI::getLogger(),
 		      "Loading properties for genr...");
-	try {
-	  Json::Value args = boost::any_cast<Json::Value>( (*iter).value );
+	const Json::Value* lCp_args =
+	  efscape::impl::json_value_cast( &(*iter).value );
+	if (lCp_args) {
+	  const Json::Value& args = *lCp_args;
 	  Json::Value lC_property = args["genr_period"];
 	  if (lC_property.isDouble()) {
 	    period = lC_property.asDouble();
@@ -132,7 +134,7 @@ namespace gpt {
 	    
 	  }
 	}
-	catch(const boost::bad_any_cast &) {
+	else {
 	  LOG4CXX_ERROR(efscape::impl::ModelHomeI::getLogger(),
 			"Unable to cast input as <Json::Value>");
 	}
@@ -3,6 +3,8 @@
 
 #include <efscape/impl/efscapelib.hpp>
 #include <efscape/impl/ModelType.hpp>
+#include <efscape/impl/Checkpointable.hpp>
+#include <efscape/impl/Cloneable.hpp>
 #include "job.hpp"
 
 #include <adevs_cereal.hpp>
@@ -23,7 +25,9 @@ namespace gpt {
     It stops producing jobs when it receives an input on its
     stop port.  Jobs appear on the out port.
   */
-  class genr: public adevs::Atomic<efscape::impl::IO_Type>
+  class genr: public adevs::Atomic<efscape::impl::IO_Type>,
+	      public efscape::impl::CerealCheckpointable<genr>,
+	      public efscape::impl::CerealCloneable<genr>
   {
   public:
     /// Constructor.  The generator period is provided here.
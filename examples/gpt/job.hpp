@@ -30,18 +30,8 @@ namespace gpt {
     {
     }
 
-    job(const job& src):
-      id(src.id),
-      t(src.t)
-    {
-    }
-
-    const job& operator=(const job& src)
-    {
-      id = src.id;
-      t = src.t;
-      return *this;
-    }
+    // note: relies on the implicit copy operations so that the job stays
+    // trivially copyable and can be held inline by efscape::impl::Payload
 
     //
     // cereal serialization function
@@ -178,13 +178,13 @@ int main()
 		  << (*i).port << ">...\n";
 
 	if ((*i).port == "gpt_log") {
-	  try {
-	    Json::Value lC_messages =
-	      boost::any_cast<Json::Value>( (*i).value );
+	  const Json::Value* lCp_messages =
+	    efscape::impl::json_value_cast( &(*i).value );
+	  if (lCp_messages) {
 	    std::cout << "rootmodel output=>"
-		      << lC_messages << std::endl;
+		      << *lCp_messages << std::endl;
 	  }
-	  catch(const boost::bad_any_cast &) {
+	  else {
 	    std::cout << "Unable to cast input as <Json::Value>\n";
 	  }
 	}
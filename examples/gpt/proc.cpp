@@ -97,8 +97,10 @@ namespace gpt {
       if ((*iter).port == properties_in) {
 	LOG4CXX_DEBUG(efscape::impl::ModelHomeI::getLogger(),
 		      "Loading properties for proc...");
-	try {
-	  Json::Value args = boost::any_cast<Json::Value>( (*iter).value );
+	const Json::Value* lCp_args =
+	  efscape::impl::json_value_cast( &(*iter).value );
+	if (lCp_args) {
+	  const Json::Value& args = *lCp_args;
 	  Json::Value lC_property = args["processing_period"];
 	  if (lC_property.isDouble()) {
 	    processing_time = lC_property.asDouble();
@@ -107,7 +109,7 @@ namespace gpt {
 			  << processing_time << " for proc...");
 	  }	  
 	}
-	catch(const boost::bad_any_cast &) {
+	else {
 	  LOG4CXX_ERROR(efscape::impl::ModelHomeI::getLogger(),
 			"Unable to cast input as <Json::Value>");
 	}
@@ -119,20 +121,22 @@ namespace gpt {
     if (sigma == DBL_MAX) {
       // Make a copy of the job (original will be destroyed by the
       // generator at the end of this simulation cycle).
-      try {
-	LOG4CXX_DEBUG(efscape::impl::ModelHomeI::getLogger(),
-		      "Receiving input on port <"
-		      << (*(x.begin())).port << ">...");
+      LOG4CXX_DEBUG(efscape::impl::ModelHomeI::getLogger(),
+		    "Receiving input on port <"
+		    << (*(x.begin())).port << ">...");
+      const job* lCp_job =
+	efscape::impl::value_cast<job>( &(*(x.begin())).value );
+      if (lCp_job) {
 	LOG4CXX_DEBUG(efscape::impl::ModelHomeI::getLogger(),
 		      "Extracted job...");
-	val.reset(new job(boost::any_cast<job>( (*(x.begin())).value ) ) );
+	val.reset(new job(*lCp_job));
 	LOG4CXX_INFO(efscape::impl::ModelHomeI::getLogger(),
 		     "Received a new job");
 	// Wait for the required processing time before outputting the
 	// completed job
 	sigma = processing_time;
       }
-      catch(const boost::bad_any_cast &) {
+      else {
 	  LOG4CXX_ERROR(efscape::impl::ModelHomeI::getLogger(),
 			"Unable to cast input as <job>");
       }
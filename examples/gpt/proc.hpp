@@ -4,6 +4,8 @@
 // parent class and data member definitions
 #include <efscape/impl/efscapelib.hpp>
 #include <efscape/impl/ModelType.hpp>
+#include <efscape/impl/Checkpointable.hpp>
+#include <efscape/impl/Cloneable.hpp>
 #include "job.hpp"
 
 // serialization definitions
@@ -25,7 +27,9 @@ namespace gpt {
     The processor can serve only one job at a time.  It the processor
     is busy, it simply discards incoming jobs.
   */
-  class proc: public adevs::Atomic<efscape::impl::IO_Type>
+  class proc: public adevs::Atomic<efscape::impl::IO_Type>,
+	      public efscape::impl::CerealCheckpointable<proc>,
+	      public efscape::impl::CerealCloneable<proc>
   {
   public:
     /// Default Constructor
@@ -6,6 +6,10 @@
 #include <efscape/impl/ModelType.ipp>
 #include <efscape/utils/type.hpp>
 
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
 
 namespace gpt {
 
@@ -145,8 +149,9 @@ namespace gpt {
     adevs::Bag<efscape::impl::IO_Type>::iterator iter;
     for (iter = x.begin(); iter != x.end(); iter++) {
       if ((*iter).port == ariv) {
-	try {
-	  job j(boost::any_cast<job>( (*iter).value ));
+	const job* lCp_job = efscape::impl::value_cast<job>( &(*iter).value );
+	if (lCp_job) {
+	  job j(*lCp_job);
 	  j.t = t;
 	  std::cout << "Start job " << j.id << " @ t = " << t << std::endl;
 
@@ -159,7 +164,7 @@ namespace gpt {
 	  
 	  jobs_arrived.push_back(j);
 	}
-	catch(const boost::bad_any_cast &) {
+	else {
 	  LOG4CXX_ERROR(efscape::impl::ModelHomeI::getLogger(),
 			"Unable to cast input as <job>");
 	}
@@ -168,8 +173,9 @@ namespace gpt {
     // Compute time required to process completed jobs
     for (iter = x.begin(); iter != x.end(); iter++) {
       if ((*iter).port == solved) {
-	try {
-	  job j(boost::any_cast<job>( (*iter).value ));
+	const job* lCp_job = efscape::impl::value_cast<job>( &(*iter).value );
+	if (lCp_job) {
+	  job j(*lCp_job);
 	  std::vector<job>::iterator i = jobs_arrived.begin();
 	  for (; i != jobs_arrived.end(); i++) {
 	    if ((*i).id == j.id) {
@@ -189,7 +195,7 @@ namespace gpt {
 	  j.t = t;
 	  jobs_solved.push_back(j);
 	}
-	catch(const boost::bad_any_cast &) {
+	else {
 	  LOG4CXX_ERROR(efscape::impl::ModelHomeI::getLogger(),
 			"Unable to cast input as <job>");
 	}
@@ -201,8 +207,10 @@ namespace gpt {
       if ((*iter).port == properties_in) {
 	LOG4CXX_DEBUG(efscape::impl::ModelHomeI::getLogger(),
 		      "Loading properties for proc...");
-	try {
-	  Json::Value args = boost::any_cast<Json::Value>( (*iter).value );
+	const Json::Value* lCp_args =
+	  efscape::impl::json_value_cast( &(*iter).value );
+	if (lCp_args) {
+	  const Json::Value& args = *lCp_args;
 	  Json::Value lC_property = args["observ_time"];
 	  if (lC_property.isDouble()) {
 	    observation_time = lC_property.asDouble();
@@ -213,7 +221,7 @@ namespace gpt {
 	  }
 	  return;		// need to short-circuit normal processing
 	}
-	catch(const boost::bad_any_cast &) {
+	else {
 	  LOG4CXX_ERROR(efscape::impl::ModelHomeI::getLogger(),
 			"Unable to cast input as <Json::Value>");
 	}
@@ -238,9 +246,11 @@ namespace gpt {
   void transd::output_func(adevs::Bag<efscape::impl::IO_Type>& y)
   {
     if (!mC_messages.isNull()) {
-      efscape::impl::IO_Type pv(log, mC_messages);
+      // hand the accumulated messages over to a shared document (this
+      // also resets mC_messages)
+      efscape::impl::IO_Type
+	pv(log, efscape::impl::SharedJson( std::move(mC_messages) ));
       y.insert(pv);
-      mC_messages = Json::Value();
       
       // std::cout << mC_messages << std::endl;
       std::cout << "output_func() sigma = " << sigma << std::endl;
@@ -267,5 +277,51 @@ namespace gpt {
   }
 
   void transd::gc_output(adevs::Bag<efscape::impl::IO_Type>& g){}
+
+  /**
+   * Saves the state of the model. Unlike its serialized form, the state
+   * includes the messages not yet sent, since they determine the output
+   * and the time advance of the model.
+   *
+   * @param aCr_buffer receives the saved state
+   */
+  void transd::saveState(std::string& aCr_buffer) const
+  {
+    Json::StreamWriterBuilder lC_writer;
+    lC_writer["indentation"] = "";
+    std::string lC_messages = Json::writeString(lC_writer, mC_messages);
+
+    std::ostringstream lC_buffer_out;
+    {
+      cereal::BinaryOutputArchive oa( lC_buffer_out );
+      oa( const_cast<transd&>(*this), is_broadcasting, lC_messages );
+    }
+    aCr_buffer = lC_buffer_out.str();
+  }
+
+  /**
+   * Restores the state of the model.
+   *
+   * @param aCr_buffer state saved by saveState
+   */
+  void transd::restoreState(const std::string& aCr_buffer)
+  {
+    std::string lC_messages;
+    {
+      std::istringstream lC_buffer_in( aCr_buffer );
+      cereal::BinaryInputArchive ia( lC_buffer_in );
+      ia( *this, is_broadcasting, lC_messages );
+    }
+
+    Json::CharReaderBuilder lC_builder;
+    std::unique_ptr<Json::CharReader> lCp_reader(lC_builder.newCharReader());
+    std::string lC_errors;
+    mC_messages = Json::Value();
+    if ( !lCp_reader->parse(lC_messages.data(),
+			    lC_messages.data() + lC_messages.size(),
+			    &mC_messages, &lC_errors) )
+      throw std::logic_error("transd: unable to restore the messages: "
+			     + lC_errors);
+  }
  
 }
@@ -6,6 +6,8 @@
 
 #include <efscape/impl/efscapelib.hpp>
 #include <efscape/impl/ModelType.hpp>
+#include <efscape/impl/Checkpointable.hpp>
+#include <efscape/impl/Cloneable.hpp>
 
 #include "job.hpp"
 
@@ -28,7 +30,9 @@ namespace gpt {
     and generates an output on its out port when the observation
     interval has elapsed.
   */
-  class transd: public adevs::Atomic<efscape::impl::IO_Type>
+  class transd: public adevs::Atomic<efscape::impl::IO_Type>,
+		public efscape::impl::Checkpointable,
+		public efscape::impl::CerealCloneable<transd>
   {
   public:
     /// default Constructor
@@ -54,6 +58,12 @@ namespace gpt {
     
     /// Garbage collection. No heap allocation in output, so do nothing
     void gc_output(adevs::Bag<efscape::impl::IO_Type>& g);
+
+    /// Saves the state of the model (for rollback and checkpoints)
+    void saveState(std::string& aCr_buffer) const;
+
+    /// Restores the state of the model
+    void restoreState(const std::string& aCr_buffer);
     
     /// Destructor
     ~transd()
@@ -5,6 +5,7 @@
 // definitions for accessing the model factory
 #include <efscape/impl/ModelHomeI.hpp>
 #include <efscape/impl/ModelHomeSingleton.hpp>
+#include <efscape/impl/AtomicIndex.hpp>
 
 #include <repast_hpc/RepastProcess.h>
 #include <boost/mpi/environment.hpp>
@@ -92,7 +93,8 @@ namespace zombie {
       efscape::impl::IO_Type x("setup_in",
 			       "");
       xb.insert(x);
-      efscape::impl::inject_events(0., xb, lCp_model.get());
+      efscape::impl::AtomicIndex lC_atomics(lCp_model.get());
+      efscape::impl::inject_events(0., xb, lC_atomics);
 
       // create simulator
       LOG4CXX_DEBUG(efscape::impl::ModelHomeI::getLogger(),
@@ -123,23 +125,19 @@ namespace zombie {
       std::ostream lC_out(buf);
 	
       double ld_time = 0.;
+      adevs::Bag<efscape::impl::IO_Type> yb;	// reused for each step
       while ( (ld_time = lCp_simulator.nextEventTime())
 	      < ld_timeMax ) {
 	lCp_simulator.execNextEvent();
 
 	// 
-	adevs::Bag<efscape::impl::IO_Type> xb;
-	efscape::impl::get_output(xb, lCp_model.get());
-	// adevs::Bag<IO_Type>::iterator i = xb.begin();
-	for (auto i : xb) {
-	  try {
-	    Json::Value lC_messages =
-	      boost::any_cast<Json::Value>( i.value );
-	    lC_out << lC_messages << std::endl;
-	  }
-	  catch(const boost::bad_any_cast &) {
-	    ;
-	  }
+	yb.clear();
+	efscape::impl::get_output(yb, lC_atomics);
+	for (const auto& i : yb) {
+	  const Json::Value* lCp_messages =
+	    efscape::impl::json_value_cast( &i.value );
+	  if (lCp_messages)
+	    lC_out << *lCp_messages << std::endl;
 	}
       }
     }
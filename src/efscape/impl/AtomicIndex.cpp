@@ -0,0 +1,105 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : AtomicIndex.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/AtomicIndex.hpp>
+
+namespace efscape {
+
+  namespace impl {
+
+    namespace {
+
+      // appends the atomic models under a model, in traversal order
+      void collect_atomics(DEVS* aCp_model, std::vector<ATOMIC*>& aC1_atomics)
+      {
+	if (aCp_model == NULL)
+	  return;
+
+	ATOMIC* lCp_atomic = NULL;
+	if ( (lCp_atomic = aCp_model->typeIsAtomic()) != NULL ) {
+	  aC1_atomics.push_back(lCp_atomic);
+	  return;
+	}
+
+	NETWORK* lCp_network = NULL;
+	if ( (lCp_network = aCp_model->typeIsNetwork()) == NULL )
+	  return;
+
+	adevs::Set<DEVS*> components;
+	lCp_network->getComponents(components);
+	adevs::Set<DEVS*>::iterator iter = components.begin();
+	for (; iter != components.end(); iter++) {
+	  collect_atomics(*iter, aC1_atomics);
+	}
+      }
+
+    } // namespace
+
+    //
+    // AtomicIndex
+    //
+
+    AtomicIndex::AtomicIndex() :
+      mCp_root(NULL),
+      mb_isValid(false)
+    {}
+
+    AtomicIndex::AtomicIndex(DEVS* aCp_root) :
+      mCp_root(aCp_root),
+      mb_isValid(false)
+    {}
+
+    void AtomicIndex::reset(DEVS* aCp_root) {
+      mCp_root = aCp_root;
+      mb_isValid = false;
+    }
+
+    const std::vector<ATOMIC*>& AtomicIndex::atomics() {
+      if (!mb_isValid)
+	rebuild();
+      return mC1_atomics;
+    }
+
+    void AtomicIndex::rebuild() {
+      mC1_atomics.clear();	// keeps capacity
+      collect_atomics(mCp_root, mC1_atomics);
+      mb_isValid = true;
+    }
+
+    //
+    // indexed event injection and output collection
+    //
+
+    void inject_events(double e, const adevs::Bag<IO_Type>& xb,
+		       AtomicIndex& aCr_index)
+    {
+      const std::vector<ATOMIC*>& lC1_atomics = aCr_index.atomics();
+      for (std::size_t i = 0; i < lC1_atomics.size(); i++) {
+	lC1_atomics[i]->delta_ext(e, xb);
+      }
+    }
+
+    void get_output(adevs::Bag<IO_Type>& yb,
+		    AtomicIndex& aCr_index)
+    {
+      const std::vector<ATOMIC*>& lC1_atomics = aCr_index.atomics();
+      for (std::size_t i = 0; i < lC1_atomics.size(); i++) {
+	lC1_atomics[i]->output_func(yb);
+      }
+    }
+
+  } // namespace impl
+
+} // namespace efscape
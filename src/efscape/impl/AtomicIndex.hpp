@@ -0,0 +1,116 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : AtomicIndex.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_ATOMICINDEX_HPP
+#define EFSCAPE_IMPL_ATOMICINDEX_HPP
+
+#include <efscape/impl/efscapelib.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Implements a flattened index of the atomic models (leaves) under a
+     * root model, in the same order as a recursive traversal of the network
+     * hierarchy. The index is built lazily on first use and then reused, so
+     * that injecting events into or collecting output from a large
+     * hierarchy is a linear scan that does not allocate.
+     *
+     * The index does not observe the model: the owner must call
+     * invalidate() (or reset()) whenever components are added to or removed
+     * from the hierarchy.
+     */
+    class AtomicIndex
+    {
+    public:
+
+      /** default constructor (no root model) */
+      AtomicIndex();
+
+      /**
+       * constructor
+       *
+       * @param aCp_root handle to root model
+       */
+      explicit AtomicIndex(DEVS* aCp_root);
+
+      /**
+       * Sets the root model and invalidates the index.
+       *
+       * @param aCp_root handle to root model
+       */
+      void reset(DEVS* aCp_root);
+
+      /** Marks the index as stale after a change in model structure. */
+      void invalidate() { mb_isValid = false; }
+
+      /** @returns whether the index is up to date */
+      bool isValid() const { return mb_isValid; }
+
+      /** @returns handle to root model */
+      DEVS* getRoot() const { return mCp_root; }
+
+      /** @returns atomic models under the root, rebuilding if stale */
+      const std::vector<ATOMIC*>& atomics();
+
+      /** @returns number of atomic models under the root */
+      std::size_t size() { return atomics().size(); }
+
+    protected:
+
+      /** Rebuilds the index from the root model. */
+      void rebuild();
+
+    private:
+
+      /** handle to root model */
+      DEVS* mCp_root;
+
+      /** atomic models in traversal order */
+      std::vector<ATOMIC*> mC1_atomics;
+
+      /** whether the index is up to date */
+      bool mb_isValid;
+
+    };				// class AtomicIndex
+
+    /**
+     * Injects a bag of events into every atomic model in the index.
+     *
+     * @param e elapsed time
+     * @param xb bag of events
+     * @param aCr_index atomic model index
+     */
+    void inject_events(double e, const adevs::Bag<IO_Type>& xb,
+		       AtomicIndex& aCr_index);
+
+    /**
+     * Collects the output of every atomic model in the index.
+     *
+     * @param yb bag of events
+     * @param aCr_index atomic model index
+     */
+    void get_output(adevs::Bag<IO_Type>& yb,
+		    AtomicIndex& aCr_index);
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_ATOMICINDEX_HPP
@@ -0,0 +1,665 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : CheckpointWriter.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/CheckpointWriter.hpp>
+
+#include <efscape/impl/ModelHomeI.hpp>
+#include <efscape/impl/AtomicIndex.hpp>
+#include <efscape/impl/Checkpointable.hpp>
+#include <efscape/impl/DirtySet.hpp>
+#include <efscape/impl/SimRunner.hpp>
+#include <efscape/impl/Snapshot.hpp>
+#include <efscape/utils/type.hpp>
+
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/utility.hpp>
+#include <cereal/types/vector.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace fs = boost::filesystem;
+
+namespace efscape {
+
+  namespace impl {
+
+    /** sequence number placeholder of the file path template */
+    static const char gcp_sequenceTag[] = "{n}";
+
+    /** file name extension of incremental checkpoints */
+    static const char gcp_deltaExtension[] = ".delta";
+
+    /** leading bytes of an incremental checkpoint */
+    static const char gcp_deltaMagic[4] = { 'E', 'F', 'S', 'D' };
+
+    /** version of the incremental checkpoint format (2: states keyed by
+	model identity) */
+    static const std::uint32_t gi_deltaVersion = 2;
+
+    // checks the type of an (optional) field of the checkpoint policy
+    // before it is converted, since jsoncpp signals a conversion error with
+    // an exception of its own
+    static void check_field(const Json::Value& aCr_config,
+			    const char* acp_name,
+			    bool (Json::Value::*ap_isType)() const,
+			    const char* acp_type)
+    {
+      if (aCr_config.isMember(acp_name) &&
+	  !(aCr_config[acp_name].*ap_isType)())
+	throw std::logic_error(std::string("checkpoint policy <") + acp_name
+			       + "> is not " + acp_type);
+    }
+
+    // collects the identity of each atomic model under a model (the path of
+    // type names from the root), counting the models of each identity
+    static void
+    collect_identities(DEVS* aCp_model, const std::string& aCr_path,
+		       std::unordered_map<const ATOMIC*, std::string>&
+		       aCr_identities,
+		       std::unordered_map<std::string, std::size_t>& aCr_counts)
+    {
+      std::string lC_path = aCr_path;
+      if (!lC_path.empty())
+	lC_path += '/';
+      lC_path += efscape::utils::type<DEVS>(*aCp_model);
+
+      ATOMIC* lCp_atomic = NULL;
+      if ( (lCp_atomic = aCp_model->typeIsAtomic()) != NULL ) {
+	aCr_identities[lCp_atomic] = lC_path;
+	aCr_counts[lC_path]++;
+	return;
+      }
+
+      NETWORK* lCp_network = NULL;
+      if ( (lCp_network = aCp_model->typeIsNetwork()) == NULL )
+	return;
+
+      adevs::Set<DEVS*> components;
+      lCp_network->getComponents(components);
+      for (auto iter = components.begin(); iter != components.end(); iter++)
+	collect_identities(*iter, lC_path, aCr_identities, aCr_counts);
+    }
+
+    // returns whether a file name is that of an incremental checkpoint
+    static bool is_delta(const std::string& aCr_name)
+    {
+      std::size_t li_length = sizeof(gcp_deltaExtension)-1;
+      return ( aCr_name.size() > li_length &&
+	       aCr_name.compare(aCr_name.size() - li_length, li_length,
+				gcp_deltaExtension) == 0 );
+    }
+
+    /**
+     * constructor
+     *
+     * @param aCr_config checkpoint policy (JSON object)
+     * @throws std::logic_error if the policy is invalid
+     */
+    CheckpointWriter::CheckpointWriter(const Json::Value& aCr_config)
+      throw(std::logic_error) :
+      md_interval(0.),
+      md_wallInterval(0.),
+      mC_path("checkpoint-{n}.efb"),
+      ml_retain(2),
+      mb_async(true),
+      ml_deltas(0),
+      ml_chain(0),
+      ml_pruned(0),
+      mCp_identityRoot(NULL),
+      ml_sequence(0),
+      md_timeLast(0.),
+      mC_wallLast(std::chrono::steady_clock::now())
+    {
+      if (!aCr_config.isObject())
+	throw std::logic_error("checkpoint policy is not a JSON object");
+
+      check_field(aCr_config, "interval", &Json::Value::isNumeric, "a number");
+      check_field(aCr_config, "wallInterval", &Json::Value::isNumeric,
+		  "a number");
+      check_field(aCr_config, "path", &Json::Value::isString, "a string");
+      check_field(aCr_config, "retain", &Json::Value::isUInt64,
+		  "a non-negative integer");
+      check_field(aCr_config, "async", &Json::Value::isBool, "a boolean");
+      check_field(aCr_config, "deltas", &Json::Value::isUInt64,
+		  "a non-negative integer");
+
+      md_interval = aCr_config.get("interval", md_interval).asDouble();
+      md_wallInterval =
+	aCr_config.get("wallInterval", md_wallInterval).asDouble();
+      mC_path = aCr_config.get("path", mC_path).asString();
+      ml_retain = aCr_config.get("retain", Json::UInt64(ml_retain)).asUInt64();
+      mb_async = aCr_config.get("async", mb_async).asBool();
+      ml_deltas = aCr_config.get("deltas", Json::UInt64(ml_deltas)).asUInt64();
+
+      if (md_interval < 0. || md_wallInterval < 0.)
+	throw std::logic_error("checkpoint interval is negative");
+      if (mC_path.empty())
+	throw std::logic_error("checkpoint path is empty");
+      if (fs::path(mC_path).parent_path().string().find(gcp_sequenceTag)
+	  != std::string::npos)
+	throw std::logic_error("checkpoint path <" + mC_path
+			       + "> has a sequence number in its directory");
+      if (ml_deltas > 0 && mC_path.find(gcp_sequenceTag) == std::string::npos)
+	throw std::logic_error("checkpoint path <" + mC_path
+			       + "> has no sequence number: incremental "
+			       "checkpoints need one");
+
+      // the first checkpoint is a full one
+      ml_chain = ml_deltas;
+    }
+
+    /** destructor (waits for the pending checkpoint) */
+    CheckpointWriter::~CheckpointWriter()
+    {
+      wait();
+    }
+
+    /**
+     * Returns whether a checkpoint is due, either in simulation time or in
+     * wall-clock time.
+     *
+     * @param ad_time current simulation time
+     * @returns whether a checkpoint is due
+     */
+    bool CheckpointWriter::due(double ad_time) const
+    {
+      if (md_interval > 0. && ad_time >= md_timeLast + md_interval &&
+	  ad_time < adevs_inf<double>())
+	return true;
+
+      return ( md_wallInterval > 0. &&
+	       std::chrono::duration<double>(std::chrono::steady_clock::now()
+					     - mC_wallLast).count()
+	       >= md_wallInterval );
+    }
+
+    /**
+     * Writes a checkpoint of the model. With asynchronous writing, the
+     * model is copied and the copy is archived on a background thread;
+     * otherwise the model is archived before returning.
+     *
+     * If the atomic models that changed since the previous checkpoint are
+     * tracked, an incremental checkpoint of their states is written instead,
+     * up to the maximum number of incremental checkpoints in a row. The set
+     * of changed models is cleared.
+     *
+     * Failures are logged: a checkpoint that cannot be written does not
+     * stop the simulation.
+     *
+     * @param aCp_model handle to model
+     * @param ad_time current simulation time
+     * @param aCp_dirty atomic models changed since the previous checkpoint
+     *                  (optional)
+     */
+    void CheckpointWriter::write(const DEVSPtr& aCp_model, double ad_time,
+				 DirtySet* aCp_dirty)
+    {
+      // wait for the previous checkpoint
+      wait();
+
+      unsigned long ll_sequence = ml_sequence++;
+      md_timeLast = ad_time;
+      mC_wallLast = std::chrono::steady_clock::now();
+
+      if (mC_listener)
+	mC_listener(ll_sequence);
+
+      //------------------------------------------------------------------
+      // 1. an incremental checkpoint, if the changes are tracked
+      //------------------------------------------------------------------
+      DeltaPtr lCp_delta;
+      if (aCp_dirty != NULL && ml_chain < ml_deltas && !mC_last.empty())
+	lCp_delta = capture(*aCp_dirty, ad_time);
+
+      if (aCp_dirty != NULL)
+	aCp_dirty->clear();
+
+      if (lCp_delta) {
+	ml_chain++;
+	mC_last = path(ll_sequence) + gcp_deltaExtension;
+
+	LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+		      "Writing incremental checkpoint <" << mC_last
+		      << "> of " << lCp_delta->mC1_states.size()
+		      << " models at time " << ad_time);
+
+	if (mb_async)
+	  mC_pending = std::async(std::launch::async,
+				  &CheckpointWriter::saveDelta, this,
+				  lCp_delta, ll_sequence);
+	else {
+	  try {
+	    saveDelta(lCp_delta, ll_sequence);
+	  }
+	  catch (const std::exception& lC_exp) {
+	    LOG4CXX_ERROR(ModelHomeI::getLogger(),
+			  "Unable to write checkpoint <" << mC_last
+			  << ">: " << lC_exp.what());
+	  }
+	}
+	return;
+      }
+
+      //------------------------------------------------------------------
+      // 2. otherwise, a full checkpoint
+      //------------------------------------------------------------------
+      ml_chain = 0;
+      mC_last = path(ll_sequence);
+      mCC_full.push_back(ll_sequence);
+
+      LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+		    "Writing checkpoint <" << mC_last
+		    << "> at time " << ad_time);
+
+      if (mb_async) {
+	DEVSPtr lCp_copy = cloneModel(aCp_model);
+	if (lCp_copy) {
+	  mC_pending = std::async(std::launch::async,
+				  &CheckpointWriter::save, this,
+				  lCp_copy, ll_sequence);
+	  return;
+	}
+	LOG4CXX_WARN(ModelHomeI::getLogger(),
+		     "Unable to copy the model: writing checkpoint <"
+		     << mC_last << "> synchronously");
+      }
+
+      try {
+	save(aCp_model, ll_sequence);
+      }
+      catch (const std::exception& lC_exp) {
+	LOG4CXX_ERROR(ModelHomeI::getLogger(),
+		      "Unable to write checkpoint <" << mC_last
+		      << ">: " << lC_exp.what());
+      }
+      prune();
+    }
+
+    /**
+     * Waits for the checkpoint being written in the background, if any,
+     * then removes the checkpoints that are no longer retained.
+     */
+    void CheckpointWriter::wait()
+    {
+      if (!mC_pending.valid())
+	return;
+
+      try {
+	mC_pending.get();
+      }
+      catch (const std::exception& lC_exp) {
+	LOG4CXX_ERROR(ModelHomeI::getLogger(),
+		      "Unable to write checkpoint: " << lC_exp.what());
+      }
+      prune();
+    }
+
+    /**
+     * Returns the latest checkpoint file on disk, i.e. the file matching the
+     * path template with the highest sequence number.
+     *
+     * @param alp_sequence returns the sequence number of the file (optional)
+     * @returns path to the latest checkpoint file ("" if there is none)
+     */
+    std::string CheckpointWriter::latest(unsigned long* alp_sequence) const
+    {
+      fs::path lC_template(mC_path);
+      fs::path lC_dir = lC_template.parent_path();
+      std::string lC_name = lC_template.filename().string();
+
+      std::size_t li_tag = lC_name.find(gcp_sequenceTag);
+      if (li_tag == std::string::npos) {
+	if (!fs::exists(lC_template))
+	  return "";
+	if (alp_sequence)
+	  *alp_sequence = 0;
+	return mC_path;
+      }
+
+      std::string lC_prefix = lC_name.substr(0, li_tag);
+      std::string lC_suffix = lC_name.substr(li_tag + sizeof(gcp_sequenceTag)-1);
+
+      boost::system::error_code lC_error;
+      fs::directory_iterator iter(lC_dir.empty() ? fs::path(".") : lC_dir,
+				  lC_error);
+      if (lC_error)
+	return "";
+
+      std::string lC_latest;
+      unsigned long ll_latest = 0;
+      for ( ; iter != fs::directory_iterator(); iter.increment(lC_error)) {
+	if (lC_error)
+	  break;
+	std::string lC_file = iter->path().filename().string();
+	std::string lC_stem = lC_file;
+	if (is_delta(lC_stem))
+	  lC_stem.resize(lC_stem.size() - (sizeof(gcp_deltaExtension)-1));
+	if (lC_stem.size() <= lC_prefix.size() + lC_suffix.size() ||
+	    lC_stem.compare(0, lC_prefix.size(), lC_prefix) != 0 ||
+	    lC_stem.compare(lC_stem.size() - lC_suffix.size(),
+			    lC_suffix.size(), lC_suffix) != 0)
+	  continue;
+
+	std::string lC_digits =
+	  lC_stem.substr(lC_prefix.size(),
+			 lC_stem.size() - lC_prefix.size() - lC_suffix.size());
+	bool lb_number = true;
+	for (char c : lC_digits)
+	  lb_number = lb_number && std::isdigit((unsigned char)c);
+	if (!lb_number)
+	  continue;
+
+	unsigned long ll_sequence = std::strtoul(lC_digits.c_str(), NULL, 10);
+	if (lC_latest.empty() || ll_sequence > ll_latest) {
+	  ll_latest = ll_sequence;
+	  lC_latest = (lC_dir / lC_file).string();
+	}
+      }
+
+      if (alp_sequence && !lC_latest.empty())
+	*alp_sequence = ll_latest;
+
+      return lC_latest;
+    }
+
+    /**
+     * Returns the path of a (full) checkpoint file.
+     *
+     * @param al_sequence sequence number of the checkpoint
+     * @returns path of the checkpoint file
+     */
+    std::string CheckpointWriter::path(unsigned long al_sequence) const
+    {
+      std::string lC_path = mC_path;
+      std::size_t li_tag = lC_path.find(gcp_sequenceTag);
+      if (li_tag != std::string::npos)
+	lC_path.replace(li_tag, sizeof(gcp_sequenceTag)-1,
+			std::to_string(al_sequence));
+      return lC_path;
+    }
+
+    /**
+     * Resumes the checkpoints of a session restored from a checkpoint. The
+     * next checkpoint is a full one.
+     *
+     * @param al_sequence sequence number of the restored checkpoint
+     * @param ad_time simulation time of the restored checkpoint
+     */
+    void CheckpointWriter::resume(unsigned long al_sequence, double ad_time)
+    {
+      ml_sequence = al_sequence + 1;
+      md_timeLast = ad_time;
+      ml_chain = ml_deltas;
+      mC_last.clear();
+    }
+
+    /** @returns the checkpoint policy in JSON format */
+    Json::Value CheckpointWriter::toJSON() const
+    {
+      Json::Value lC_config;
+      lC_config["interval"] = md_interval;
+      lC_config["wallInterval"] = md_wallInterval;
+      lC_config["path"] = mC_path;
+      lC_config["retain"] = Json::UInt64(ml_retain);
+      lC_config["async"] = mb_async;
+      lC_config["deltas"] = Json::UInt64(ml_deltas);
+      return lC_config;
+    }
+
+    /**
+     * Restores a model from a checkpoint file. An incremental checkpoint is
+     * applied to the model restored from its base, which may itself be
+     * incremental.
+     *
+     * @param aCr_path path of the checkpoint file
+     * @returns handle to model (null if it could not be restored)
+     * @throws std::logic_error if an incremental checkpoint is invalid
+     */
+    DEVSPtr CheckpointWriter::restore(const std::string& aCr_path)
+      throw(std::logic_error)
+    {
+      // the archives and the models signal corrupt files with exceptions of
+      // their own (e.g. cereal::Exception)
+      try {
+	if (!is_delta(aCr_path))
+	  return loadModelSnapshot(aCr_path);
+
+	std::ifstream lC_in(aCr_path.c_str(), std::ios::binary);
+	char lc_magic[sizeof(gcp_deltaMagic)];
+	if (!lC_in.read(lc_magic, sizeof(lc_magic)) ||
+	    std::memcmp(lc_magic, gcp_deltaMagic, sizeof(lc_magic)) != 0)
+	  throw std::logic_error("<" + aCr_path
+				 + "> is not an incremental checkpoint");
+
+	std::uint32_t li_version = 0;
+	Delta lC_delta;
+	{
+	  cereal::PortableBinaryInputArchive ia(lC_in);
+	  ia( cereal::make_nvp("version", li_version) );
+	  if (li_version != gi_deltaVersion)
+	    throw std::logic_error("<" + aCr_path
+				   + ">: unsupported checkpoint version "
+				   + std::to_string(li_version));
+	  ia( cereal::make_nvp("base", lC_delta.mC_base),
+	      cereal::make_nvp("time", lC_delta.md_time),
+	      cereal::make_nvp("atomics", lC_delta.ml_atomics),
+	      cereal::make_nvp("states", lC_delta.mC1_states) );
+	}
+
+	DEVSPtr lCp_model =
+	  restore( (fs::path(aCr_path).parent_path()
+		    / lC_delta.mC_base).string() );
+	SimRunner* lCp_SimRunner = dynamic_cast<SimRunner*>(lCp_model.get());
+	if (lCp_SimRunner == NULL ||
+	    lCp_SimRunner->getWrappedModel().get() == NULL)
+	  throw std::logic_error("<" + aCr_path + ">: the base checkpoint is "
+				 "not a simulation session");
+
+	AtomicIndex lC_index(lCp_SimRunner->getWrappedModel().get());
+	const std::vector<ATOMIC*>& lC1_atomics = lC_index.atomics();
+	if (lC1_atomics.size() != lC_delta.ml_atomics)
+	  throw std::logic_error("<" + aCr_path + ">: the base checkpoint has "
+				 + std::to_string(lC1_atomics.size())
+				 + " atomic models instead of "
+				 + std::to_string(lC_delta.ml_atomics));
+
+	// the states are applied to the models of the same identity
+	std::unordered_map<const ATOMIC*, std::string> lCC_identities;
+	std::unordered_map<std::string, std::size_t> lCC_counts;
+	collect_identities(lCp_SimRunner->getWrappedModel().get(), "",
+			   lCC_identities, lCC_counts);
+	std::unordered_map<std::string, ATOMIC*> lCC_models;
+	for (ATOMIC* lCp_atomic : lC1_atomics)
+	  lCC_models[lCC_identities[lCp_atomic]] = lCp_atomic;
+
+	for (const auto& i : lC_delta.mC1_states) {
+	  auto lC_model = lCC_models.find(i.first);
+	  if (lC_model == lCC_models.end() || lCC_counts[i.first] != 1)
+	    throw std::logic_error("<" + aCr_path + ">: the base checkpoint "
+				   "has no unique atomic model <" + i.first
+				   + ">");
+	  Checkpointable* lCp_state =
+	    dynamic_cast<Checkpointable*>(lC_model->second);
+	  if (lCp_state == NULL)
+	    throw std::logic_error("<" + aCr_path + ">: atomic model <"
+				   + i.first + "> cannot be restored");
+	  lCp_state->restoreState(i.second);
+	}
+
+	lCp_SimRunner->restoreTime(lC_delta.md_time);
+
+	return lCp_model;
+      }
+      catch (const std::logic_error&) {
+	throw;
+      }
+      catch (const std::exception& lC_excp) {
+	throw std::logic_error("<" + aCr_path + ">: unable to restore the "
+			       "checkpoint: " + lC_excp.what());
+      }
+    }
+
+    /**
+     * Captures the states of the changed models for an incremental
+     * checkpoint.
+     *
+     * @param aCr_dirty atomic models changed since the previous checkpoint
+     * @param ad_time simulation time of the checkpoint
+     * @returns state of the checkpoint (null if a changed model is not
+     *          Checkpointable or has no unique identity)
+     */
+    CheckpointWriter::DeltaPtr
+    CheckpointWriter::capture(DirtySet& aCr_dirty, double ad_time) const
+    {
+      const std::vector<ATOMIC*>& lC1_atomics = aCr_dirty.atomics();
+
+      // the identities are kept while the model structure is unchanged
+      if (mCp_identityRoot != aCr_dirty.getRoot() ||
+	  mCC_identities.size() != lC1_atomics.size()) {
+	mCC_identities.clear();
+	std::unordered_map<std::string, std::size_t> lCC_counts;
+	collect_identities(aCr_dirty.getRoot(), "", mCC_identities,
+			   lCC_counts);
+	for (auto& i : mCC_identities)
+	  if (lCC_counts[i.second] > 1)
+	    i.second.clear();
+	mCp_identityRoot = aCr_dirty.getRoot();
+      }
+
+      DeltaPtr lCp_delta(new Delta);
+      lCp_delta->mC_base = fs::path(mC_last).filename().string();
+      lCp_delta->md_time = ad_time;
+      lCp_delta->ml_atomics = lC1_atomics.size();
+      lCp_delta->mC1_states.reserve(aCr_dirty.indices().size());
+
+      for (std::size_t i : aCr_dirty.indices()) {
+	const Checkpointable* lCp_state =
+	  dynamic_cast<const Checkpointable*>(lC1_atomics[i]);
+	if (lCp_state == NULL) {
+	  LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+			"Atomic model " << i << " is not Checkpointable: "
+			"writing a full checkpoint");
+	  return DeltaPtr();
+	}
+	const std::string& lCr_identity = mCC_identities[lC1_atomics[i]];
+	if (lCr_identity.empty()) {
+	  LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+			"Atomic model " << i << " has no unique identity: "
+			"writing a full checkpoint");
+	  return DeltaPtr();
+	}
+	lCp_delta->mC1_states.push_back
+	  ( std::make_pair(lCr_identity, std::string()) );
+	lCp_state->saveState(lCp_delta->mC1_states.back().second);
+      }
+
+      return lCp_delta;
+    }
+
+    /**
+     * Archives the model to a checkpoint file. The archive is written under
+     * a temporary name that keeps the extensions of the file.
+     *
+     * @param aCp_model handle to model
+     * @param al_sequence sequence number of the checkpoint
+     * @throws std::logic_error if the checkpoint cannot be written
+     */
+    void CheckpointWriter::save(const DEVSPtr& aCp_model,
+				unsigned long al_sequence)
+    {
+      fs::path lC_path(path(al_sequence));
+      fs::path lC_partial = lC_path.parent_path() /
+	(".partial-" + lC_path.filename().string());
+
+      saveModelSnapshot(aCp_model, lC_partial.string());
+
+      boost::system::error_code lC_error;
+      fs::rename(lC_partial, lC_path, lC_error);
+      if (lC_error)
+	throw std::logic_error("unable to rename <" + lC_partial.string()
+			       + ">: " + lC_error.message());
+    }
+
+    /**
+     * Writes an incremental checkpoint file, under a temporary name.
+     *
+     * @param aCp_delta state of the checkpoint
+     * @param al_sequence sequence number of the checkpoint
+     * @throws std::logic_error if the checkpoint cannot be written
+     */
+    void CheckpointWriter::saveDelta(const DeltaPtr& aCp_delta,
+				     unsigned long al_sequence)
+    {
+      fs::path lC_path(path(al_sequence) + gcp_deltaExtension);
+      fs::path lC_partial = lC_path.parent_path() /
+	(".partial-" + lC_path.filename().string());
+
+      {
+	std::ofstream lC_out(lC_partial.string().c_str(), std::ios::binary);
+	if (!lC_out)
+	  throw std::logic_error("unable to open <" + lC_partial.string()
+				 + ">");
+	lC_out.write(gcp_deltaMagic, sizeof(gcp_deltaMagic));
+	{
+	  cereal::PortableBinaryOutputArchive oa(lC_out);
+	  oa( cereal::make_nvp("version", gi_deltaVersion),
+	      cereal::make_nvp("base", aCp_delta->mC_base),
+	      cereal::make_nvp("time", aCp_delta->md_time),
+	      cereal::make_nvp("atomics", aCp_delta->ml_atomics),
+	      cereal::make_nvp("states", aCp_delta->mC1_states) );
+	}
+	if (!lC_out.flush())
+	  throw std::logic_error("unable to write <" + lC_partial.string()
+				 + ">");
+      }
+
+      boost::system::error_code lC_error;
+      fs::rename(lC_partial, lC_path, lC_error);
+      if (lC_error)
+	throw std::logic_error("unable to rename <" + lC_partial.string()
+			       + ">: " + lC_error.message());
+    }
+
+    /**
+     * Removes the checkpoint files that are no longer retained: those older
+     * than the oldest retained full checkpoint.
+     */
+    void CheckpointWriter::prune()
+    {
+      if (ml_retain == 0 || mC_path.find(gcp_sequenceTag) == std::string::npos)
+	return;
+
+      while (mCC_full.size() > ml_retain)
+	mCC_full.pop_front();
+      if (mCC_full.size() < ml_retain)
+	return;
+
+      boost::system::error_code lC_error;
+      for ( ; ml_pruned < mCC_full.front(); ml_pruned++) {
+	fs::remove(path(ml_pruned), lC_error);
+	fs::remove(path(ml_pruned) + gcp_deltaExtension, lC_error);
+      }
+    }
+
+  } // namespace impl
+
+} // namespace efscape
@@ -0,0 +1,209 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : CheckpointWriter.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_CHECKPOINTWRITER_HPP
+#define EFSCAPE_IMPL_CHECKPOINTWRITER_HPP
+
+#include <efscape/impl/efscapelib.hpp>
+
+#include <json/json.h>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace efscape {
+
+  namespace impl {
+
+    class DirtySet;
+
+    /**
+     * Writes periodic checkpoints (model snapshots) of a running simulation.
+     * The checkpoint policy is configured from a JSON object:
+     *   - "interval": simulation time between checkpoints (0: none)
+     *   - "wallInterval": wall-clock seconds between checkpoints (0: none)
+     *   - "path": file path template, where "{n}" is replaced by the
+     *     sequence number of the checkpoint; the archive format and
+     *     compression follow the extensions (see saveModelSnapshot()),
+     *     e.g. "checkpoints/run-{n}.efb.lz4" (default "checkpoint-{n}.efb")
+     *   - "retain": number of full checkpoints kept, with the incremental
+     *     checkpoints that depend on them (0: all, default 2)
+     *   - "async": whether checkpoints are written on a background thread
+     *     (default true)
+     *   - "deltas": maximum number of incremental checkpoints written
+     *     between two full checkpoints (default 0)
+     *
+     * An asynchronous checkpoint captures the model state with cloneModel()
+     * and archives the copy while the simulation continues. At most one
+     * checkpoint is written at a time: the next checkpoint waits for the
+     * previous one. Each file is written under a temporary name and renamed
+     * once complete, so a crash never leaves a truncated latest checkpoint.
+     *
+     * An incremental checkpoint ("<path>.delta") holds only the state of the
+     * atomic models that changed since the previous checkpoint (see
+     * DirtySet), which it references as its base. It is restored by
+     * restoring its base, then the saved states in place (see
+     * Checkpointable). A full checkpoint is written instead if a changed
+     * model is not Checkpointable.
+     *
+     * The states of an incremental checkpoint are keyed by the identity of
+     * their model, the path of type names from the root (e.g.
+     * "gpt::Ef/gpt::Genr"), since the order of the components of a network
+     * follows their addresses, which change when the base is restored. A
+     * full checkpoint is also written if a changed model shares its identity
+     * with another model.
+     */
+    class CheckpointWriter
+    {
+    public:
+
+      CheckpointWriter(const Json::Value& aCr_config)
+	throw(std::logic_error);
+
+      ~CheckpointWriter();
+
+      bool due(double ad_time) const;
+
+      void write(const DEVSPtr& aCp_model, double ad_time,
+		 DirtySet* aCp_dirty = NULL);
+
+      void wait();
+
+      std::string latest(unsigned long* alp_sequence = NULL) const;
+
+      std::string path(unsigned long al_sequence) const;
+
+      /** @returns sequence number of the next checkpoint */
+      unsigned long sequence() const { return ml_sequence; }
+
+      void resume(unsigned long al_sequence, double ad_time);
+
+      /** called with the sequence number of each checkpoint written */
+      typedef std::function<void(unsigned long)> Listener;
+
+      /**
+       * Sets the function called before each checkpoint is written (e.g.
+       * to flush the output of the run up to the checkpoint).
+       *
+       * @param aCr_listener checkpoint listener
+       */
+      void setListener(const Listener& aCr_listener) {
+	mC_listener = aCr_listener;
+      }
+
+      /** @returns whether incremental checkpoints are written */
+      bool incremental() const { return ml_deltas > 0; }
+
+      Json::Value toJSON() const;
+
+      static DEVSPtr restore(const std::string& aCr_path)
+	throw(std::logic_error);
+
+    protected:
+
+      /** state of an incremental checkpoint */
+      struct Delta {
+	/** file name of the base checkpoint (in the same directory) */
+	std::string mC_base;
+
+	/** simulation time of the checkpoint */
+	double md_time;
+
+	/** number of atomic models */
+	std::uint64_t ml_atomics;
+
+	/** states of the changed models, by identity of the model */
+	std::vector< std::pair<std::string, std::string> > mC1_states;
+      };
+
+      typedef std::shared_ptr<Delta> DeltaPtr;
+
+      DeltaPtr capture(DirtySet& aCr_dirty, double ad_time) const;
+
+      void save(const DEVSPtr& aCp_model, unsigned long al_sequence);
+
+      void saveDelta(const DeltaPtr& aCp_delta, unsigned long al_sequence);
+
+      void prune();
+
+    private:
+
+      /** simulation time between checkpoints */
+      double md_interval;
+
+      /** wall-clock time between checkpoints (seconds) */
+      double md_wallInterval;
+
+      /** file path template */
+      std::string mC_path;
+
+      /** number of checkpoint files kept */
+      unsigned long ml_retain;
+
+      /** whether checkpoints are written on a background thread */
+      bool mb_async;
+
+      /** maximum number of incremental checkpoints between full ones */
+      unsigned long ml_deltas;
+
+      /** number of incremental checkpoints since the last full one */
+      unsigned long ml_chain;
+
+      /** file path of the previous checkpoint */
+      std::string mC_last;
+
+      /** sequence numbers of the retained full checkpoints */
+      std::deque<unsigned long> mCC_full;
+
+      /** lowest sequence number that may still be on disk */
+      unsigned long ml_pruned;
+
+      /** root model of the identities below */
+      mutable const DEVS* mCp_identityRoot;
+
+      /** identity of each atomic model (empty if it is not unique) */
+      mutable std::unordered_map<const ATOMIC*, std::string> mCC_identities;
+
+      /** sequence number of the next checkpoint */
+      unsigned long ml_sequence;
+
+      /** simulation time of the previous checkpoint */
+      double md_timeLast;
+
+      /** wall-clock time of the previous checkpoint */
+      std::chrono::steady_clock::time_point mC_wallLast;
+
+      /** checkpoint being written in the background */
+      std::future<void> mC_pending;
+
+      /** called before each checkpoint is written */
+      Listener mC_listener;
+
+    };				// class CheckpointWriter
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_CHECKPOINTWRITER_HPP
@@ -0,0 +1,90 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : Checkpointable.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_CHECKPOINTABLE_HPP
+#define EFSCAPE_IMPL_CHECKPOINTABLE_HPP
+
+// c++ cereal definitions
+#include <cereal/cereal.hpp>
+#include <cereal/archives/binary.hpp>
+
+#include <sstream>
+#include <string>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Interface for models whose state can be saved and restored in place,
+     * as required for rollback by the TimeWarpSimulator.
+     */
+    class Checkpointable
+    {
+    public:
+      virtual ~Checkpointable() {}
+
+      /**
+       * Saves the state of the model.
+       *
+       * @param aCr_buffer receives the saved state
+       */
+      virtual void saveState(std::string& aCr_buffer) const = 0;
+
+      /**
+       * Restores the state of the model.
+       *
+       * @param aCr_buffer state saved by saveState
+       */
+      virtual void restoreState(const std::string& aCr_buffer) = 0;
+
+    };				// class Checkpointable
+
+    /**
+     * Implements Checkpointable with the cereal serialize() function that
+     * a model already provides for efscape serialization, written to a
+     * binary archive. A model opts in by deriving from
+     * CerealCheckpointable<Model>:
+     *
+     *   class genr : public adevs::Atomic<efscape::impl::IO_Type>,
+     *                public efscape::impl::CerealCheckpointable<genr>
+     */
+    template <class Model>
+    class CerealCheckpointable : public Checkpointable
+    {
+    public:
+
+      void saveState(std::string& aCr_buffer) const {
+	std::ostringstream lC_buffer_out;
+	{
+	  cereal::BinaryOutputArchive oa( lC_buffer_out );
+	  oa( const_cast<Model&>(static_cast<const Model&>(*this)) );
+	}
+	aCr_buffer = lC_buffer_out.str();
+      }
+
+      void restoreState(const std::string& aCr_buffer) {
+	std::istringstream lC_buffer_in( aCr_buffer );
+	cereal::BinaryInputArchive ia( lC_buffer_in );
+	ia( static_cast<Model&>(*this) );
+      }
+
+    };				// class CerealCheckpointable
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_CHECKPOINTABLE_HPP
@@ -0,0 +1,99 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : Cloneable.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_CLONEABLE_HPP
+#define EFSCAPE_IMPL_CLONEABLE_HPP
+
+#include <efscape/impl/efscapelib.hpp>
+#include <efscape/utils/MemoryBuffer.hpp>
+
+// c++ cereal definitions
+#include <cereal/cereal.hpp>
+#include <cereal/archives/binary.hpp>
+
+#include <istream>
+#include <ostream>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Interface for models that provide their own deep copy, which
+     * cloneModel() prefers to a round trip through a serialization archive.
+     * The copy is a new model, not attached to a network or a simulator,
+     * with the state of the original.
+     */
+    class Cloneable
+    {
+    public:
+      virtual ~Cloneable() {}
+
+      /**
+       * Returns a deep copy of the model.
+       *
+       * @returns handle to the copy (null if the model cannot be copied)
+       */
+      virtual DEVS* clone() const = 0;
+
+    };				// class Cloneable
+
+    /**
+     * Implements Cloneable for a default-constructible model with the
+     * cereal serialize() function it already provides: the state of the
+     * model is copied into a new instance through a binary archive. The
+     * archive only holds the model itself (no polymorphic type lookup),
+     * and the buffer is reused from one clone to the next. A model opts in
+     * by deriving from CerealCloneable<Model>:
+     *
+     *   class genr : public adevs::Atomic<efscape::impl::IO_Type>,
+     *                public efscape::impl::CerealCloneable<genr>
+     */
+    template <class Model>
+    class CerealCloneable : public Cloneable
+    {
+    public:
+
+      DEVS* clone() const {
+	static thread_local efscape::utils::MemoryBuffer lC_buffer;
+
+	Model* lCp_clone = NULL;
+	try {
+	  lC_buffer.reset();
+	  {
+	    std::ostream lC_out(&lC_buffer);
+	    cereal::BinaryOutputArchive oa( lC_out );
+	    oa( const_cast<Model&>(static_cast<const Model&>(*this)) );
+	  }
+
+	  lCp_clone = new Model;
+	  lC_buffer.rewind();
+	  std::istream lC_in(&lC_buffer);
+	  cereal::BinaryInputArchive ia( lC_in );
+	  ia( *lCp_clone );
+	} catch(...) {
+	  delete lCp_clone;
+	  return NULL;
+	}
+	return lCp_clone;
+      }
+
+    };				// class CerealCloneable
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_CLONEABLE_HPP
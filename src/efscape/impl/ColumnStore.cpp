@@ -0,0 +1,353 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : ColumnStore.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/ColumnStore.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+
+namespace efscape {
+
+  namespace impl {
+
+    namespace {
+
+      // file and chunk tags
+      const char gcp_fileTag[4] = { 'E', 'F', 'S', 'C' };
+      const char gcp_chunkTag[4] = { 'E', 'F', 'C', 'K' };
+
+      // file format version
+      const std::uint32_t gi_version = 1;
+
+      // byte order mark (files are written in the byte order of the host)
+      const std::uint32_t gi_byteOrder = 0x01020304;
+
+      // size of the fixed part of a chunk header
+      const std::size_t gi_chunkHeaderSize = 24;
+
+      // appends the bytes of a value to a buffer
+      template <typename T>
+      void append(std::string& aCr_buffer, const T& aCr_value) {
+	aCr_buffer.append(reinterpret_cast<const char*>(&aCr_value),
+			  sizeof(T));
+      }
+
+      // reads a value from a mapped file
+      template <typename T>
+      T read(const char* acp_data) {
+	T lC_value;
+	std::memcpy(&lC_value, acp_data, sizeof(T));
+	return lC_value;
+      }
+
+      // returns whether a JSON number is an integer (rather than a real
+      // that happens to have an integral value)
+      bool is_integer(const Json::Value& aCr_value) {
+	return (aCr_value.type() == Json::intValue ||
+		(aCr_value.type() == Json::uintValue && aCr_value.isInt64()));
+      }
+
+      // rounds a size up to a multiple of 8 bytes
+      std::size_t align8(std::size_t ai_size) {
+	return (ai_size + 7) & ~std::size_t(7);
+      }
+
+    } // namespace
+
+    //
+    // ColumnWriter
+    //
+
+    const std::size_t ColumnWriter::CHUNK_ROWS;
+
+    /** constructor */
+    ColumnWriter::ColumnWriter(std::ostream& aCr_out, bool ab_append,
+			       std::size_t ai_chunkRows) :
+      mCr_out(aCr_out),
+      mi_chunkRows(ai_chunkRows > 0 ? ai_chunkRows : 1),
+      ml_skipped(0)
+    {
+      if (!ab_append) {
+	std::string lC_header(gcp_fileTag, sizeof(gcp_fileTag));
+	append(lC_header, gi_version);
+	append(lC_header, gi_byteOrder);
+	append(lC_header, std::uint32_t(0));
+	mCr_out.write(lC_header.data(), lC_header.size());
+      }
+    }
+
+    /** destructor */
+    ColumnWriter::~ColumnWriter()
+    {
+      flush();
+    }
+
+    bool ColumnWriter::write(const IO_Type& aCr_value, double ad_time)
+    {
+      static const std::string lC_valueName("value");
+
+      // collect the numeric values (and whether they are integral)
+      mC1_names.clear();
+      mC1_values.clear();
+      mC1_integers.clear();
+      mC1_integral.clear();
+      if (const double* lCp_number = value_cast<double>(&aCr_value.value)) {
+	mC1_names.push_back(lC_valueName);
+	mC1_values.push_back(*lCp_number);
+	mC1_integers.push_back(0);
+	mC1_integral.push_back(false);
+      }
+      else if (const int* lCp_integer = value_cast<int>(&aCr_value.value)) {
+	mC1_names.push_back(lC_valueName);
+	mC1_values.push_back(*lCp_integer);
+	mC1_integers.push_back(*lCp_integer);
+	mC1_integral.push_back(true);
+      }
+      else if (const Json::Value* lCp_json =
+	       json_value_cast(&aCr_value.value)) {
+	if (lCp_json->isNumeric()) {
+	  bool lb_integral = is_integer(*lCp_json);
+	  mC1_names.push_back(lC_valueName);
+	  mC1_values.push_back(lCp_json->asDouble());
+	  mC1_integers.push_back(lb_integral ? lCp_json->asInt64() : 0);
+	  mC1_integral.push_back(lb_integral);
+	}
+	else if (lCp_json->isObject()) {
+	  // members are visited in order of their names
+	  for (auto i = lCp_json->begin(); i != lCp_json->end(); i++)
+	    if (i->isNumeric()) {
+	      bool lb_integral = is_integer(*i);
+	      mC1_names.push_back(i.name());
+	      mC1_values.push_back(i->asDouble());
+	      mC1_integers.push_back(lb_integral ? i->asInt64() : 0);
+	      mC1_integral.push_back(lb_integral);
+	    }
+	}
+      }
+      if (mC1_values.empty()) {
+	ml_skipped++;
+	return false;
+      }
+
+      Series& lCr_series = mCC_series[aCr_value.port];
+      if (lCr_series.mC1_names != mC1_names) {
+	if (!lCr_series.mC1_time.empty())
+	  writeChunk(aCr_value.port, lCr_series);
+	begin(lCr_series, mC1_names);
+      }
+
+      lCr_series.mC1_time.push_back(ad_time);
+      for (std::size_t i = 0; i < mC1_values.size(); i++) {
+	Column& lCr_column = lCr_series.mC1_columns[i];
+	if (lCr_column.mb_integral && !mC1_integral[i]) {
+	  // the column becomes floating-point from its first non-integral
+	  // value on
+	  lCr_column.mC1_doubles.assign(lCr_column.mC1_integers.begin(),
+					lCr_column.mC1_integers.end());
+	  lCr_column.mC1_doubles.reserve(mi_chunkRows);
+	  lCr_column.mC1_integers.clear();
+	  lCr_column.mb_integral = false;
+	}
+	if (lCr_column.mb_integral)
+	  lCr_column.mC1_integers.push_back(mC1_integers[i]);
+	else
+	  lCr_column.mC1_doubles.push_back(mC1_values[i]);
+      }
+
+      if (lCr_series.mC1_time.size() >= mi_chunkRows)
+	writeChunk(aCr_value.port, lCr_series);
+
+      return true;
+    }
+
+    void ColumnWriter::flush()
+    {
+      for (auto& i : mCC_series)
+	if (!i.second.mC1_time.empty())
+	  writeChunk(i.first, i.second);
+      mCr_out.flush();
+    }
+
+    void ColumnWriter::begin(Series& aCr_series,
+			     const std::vector<std::string>& aCr_names)
+    {
+      aCr_series.mC1_names = aCr_names;
+      aCr_series.mC1_time.clear();
+      aCr_series.mC1_columns.resize(aCr_names.size());
+      for (auto& lCr_column : aCr_series.mC1_columns) {
+	lCr_column.mb_integral = true;
+	lCr_column.mC1_integers.clear();
+	lCr_column.mC1_doubles.clear();
+	lCr_column.mC1_integers.reserve(mi_chunkRows);
+      }
+      aCr_series.mC1_time.reserve(mi_chunkRows);
+    }
+
+    void ColumnWriter::writeChunk(const PortType& aCr_port,
+				  Series& aCr_series)
+    {
+      std::uint64_t ll_rows = aCr_series.mC1_time.size();
+
+      // header
+      std::string lC_header(gcp_chunkTag, sizeof(gcp_chunkTag));
+      append(lC_header, std::uint32_t(0)); // header size (set below)
+      append(lC_header, ll_rows);
+      append(lC_header, std::uint32_t(aCr_series.mC1_names.size()));
+      append(lC_header, std::uint32_t(aCr_port.name().size()));
+      lC_header += aCr_port.name();
+      for (std::size_t i = 0; i < aCr_series.mC1_names.size(); i++) {
+	append(lC_header,
+	       std::uint32_t(aCr_series.mC1_columns[i].mb_integral ? I64 : F64));
+	append(lC_header, std::uint32_t(aCr_series.mC1_names[i].size()));
+	lC_header += aCr_series.mC1_names[i];
+      }
+      lC_header.resize(align8(lC_header.size()), '\0');
+      std::uint32_t li_headerSize = lC_header.size();
+      std::memcpy(&lC_header[4], &li_headerSize, sizeof(li_headerSize));
+      mCr_out.write(lC_header.data(), lC_header.size());
+
+      // columns
+      mCr_out.write(reinterpret_cast<const char*>(aCr_series.mC1_time.data()),
+		    ll_rows * sizeof(double));
+      for (const auto& lCr_column : aCr_series.mC1_columns) {
+	if (lCr_column.mb_integral)
+	  mCr_out.write(reinterpret_cast<const char*>
+			(lCr_column.mC1_integers.data()),
+			ll_rows * sizeof(std::int64_t));
+	else
+	  mCr_out.write(reinterpret_cast<const char*>
+			(lCr_column.mC1_doubles.data()),
+			ll_rows * sizeof(double));
+      }
+
+      // keep the columns (and their storage) for the next chunk
+      begin(aCr_series, aCr_series.mC1_names);
+    }
+
+    //
+    // ColumnReader
+    //
+
+    /** constructor */
+    ColumnReader::ColumnReader(const std::string& aCr_fileName)
+      throw(std::logic_error) :
+      mCp_file(new efscape::utils::MappedFile(aCr_fileName.c_str()))
+    {
+      const char* lcp_data = mCp_file->data();
+      std::size_t li_size = mCp_file->size();
+      if ( li_size < 16 ||
+	   std::memcmp(lcp_data, gcp_fileTag, sizeof(gcp_fileTag)) != 0 )
+	throw std::logic_error("<" + aCr_fileName + "> is not a column file");
+      if (read<std::uint32_t>(lcp_data + 4) != gi_version)
+	throw std::logic_error("<" + aCr_fileName + "> has an unsupported "
+			       "column file version");
+      if (read<std::uint32_t>(lcp_data + 8) != gi_byteOrder)
+	throw std::logic_error("<" + aCr_fileName + "> was written with "
+			       "another byte order");
+
+      std::size_t li_offset = 16;
+      while (li_offset < li_size) {
+	const char* lcp_chunk = lcp_data + li_offset;
+	if (li_size - li_offset < gi_chunkHeaderSize ||
+	    std::memcmp(lcp_chunk, gcp_chunkTag, sizeof(gcp_chunkTag)) != 0)
+	  throw std::logic_error("<" + aCr_fileName + "> has an invalid "
+				 "chunk at offset "
+				 + std::to_string(li_offset));
+
+	std::size_t li_headerSize = read<std::uint32_t>(lcp_chunk + 4);
+	std::uint64_t ll_rows = read<std::uint64_t>(lcp_chunk + 8);
+	std::size_t li_columns = read<std::uint32_t>(lcp_chunk + 16);
+	std::size_t li_portSize = read<std::uint32_t>(lcp_chunk + 20);
+
+	// (the row count is checked first, so that the data size is valid)
+	if (ll_rows > 0 && li_columns + 1 > (li_size / 8) / ll_rows)
+	  throw std::logic_error("<" + aCr_fileName + "> has a truncated "
+				 "chunk at offset "
+				 + std::to_string(li_offset));
+	if (li_headerSize < gi_chunkHeaderSize)
+	  throw std::logic_error("<" + aCr_fileName + "> has an invalid "
+				 "chunk header at offset "
+				 + std::to_string(li_offset));
+	std::uint64_t ll_dataSize = (li_columns + 1) * ll_rows * 8;
+	if (li_headerSize > li_size - li_offset ||
+	    li_headerSize % 8 != 0 ||
+	    ll_dataSize > li_size - li_offset - li_headerSize)
+	  throw std::logic_error("<" + aCr_fileName + "> has a truncated "
+				 "chunk at offset "
+				 + std::to_string(li_offset));
+
+	// names and types, within the header
+	Chunk lC_chunk;
+	std::size_t li_pos = gi_chunkHeaderSize;
+	if (li_portSize > li_headerSize - li_pos)
+	  throw std::logic_error("<" + aCr_fileName + "> has an invalid "
+				 "chunk header at offset "
+				 + std::to_string(li_offset));
+	lC_chunk.port.assign(lcp_chunk + li_pos, li_portSize);
+	li_pos += li_portSize;
+
+	const char* lcp_values = lcp_chunk + li_headerSize;
+	lC_chunk.rows = ll_rows;
+	lC_chunk.time = reinterpret_cast<const double*>(lcp_values);
+	for (std::size_t i = 0; i < li_columns; i++) {
+	  if (li_headerSize - li_pos < 8)
+	    throw std::logic_error("<" + aCr_fileName + "> has an invalid "
+				   "chunk header at offset "
+				   + std::to_string(li_offset));
+	  Column lC_column;
+	  std::uint32_t li_type = read<std::uint32_t>(lcp_chunk + li_pos);
+	  std::size_t li_nameSize = read<std::uint32_t>(lcp_chunk + li_pos + 4);
+	  li_pos += 8;
+	  if (li_type > ColumnWriter::I64 ||
+	      li_nameSize > li_headerSize - li_pos)
+	    throw std::logic_error("<" + aCr_fileName + "> has an invalid "
+				   "chunk header at offset "
+				   + std::to_string(li_offset));
+	  lC_column.type = ColumnWriter::ColumnType(li_type);
+	  lC_column.name.assign(lcp_chunk + li_pos, li_nameSize);
+	  lC_column.data = lcp_values + (i + 1) * ll_rows * 8;
+	  li_pos += li_nameSize;
+	  lC_chunk.columns.push_back(lC_column);
+	}
+
+	mC1_chunks.push_back(lC_chunk);
+	li_offset += li_headerSize + ll_dataSize;
+      }
+    }
+
+    std::vector<const ColumnReader::Chunk*>
+    ColumnReader::chunks(const std::string& aCr_port) const
+    {
+      std::vector<const Chunk*> lC1_chunks;
+      for (const auto& lCr_chunk : mC1_chunks)
+	if (lCr_chunk.port == aCr_port)
+	  lC1_chunks.push_back(&lCr_chunk);
+      return lC1_chunks;
+    }
+
+    std::vector<std::string> ColumnReader::ports() const
+    {
+      std::vector<std::string> lC1_ports;
+      for (const auto& lCr_chunk : mC1_chunks)
+	if (std::find(lC1_ports.begin(), lC1_ports.end(), lCr_chunk.port)
+	    == lC1_ports.end())
+	  lC1_ports.push_back(lCr_chunk.port);
+      return lC1_ports;
+    }
+
+  } // namespace impl
+
+} // namespace efscape
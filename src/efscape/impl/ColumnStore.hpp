@@ -0,0 +1,216 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : ColumnStore.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_COLUMNSTORE_HPP
+#define EFSCAPE_IMPL_COLUMNSTORE_HPP
+
+#include <efscape/impl/efscapelib.hpp>
+#include <efscape/utils/MappedFile.hpp>
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Implements a writer of the numeric output of a simulation as columnar
+     * time series (an efscape column file, .efc). The output of each port
+     * is buffered in columns, one per numeric value (a number, or each
+     * numeric member of a JSON object), and written out in chunks of rows:
+     *
+     *   file:   "EFSC" | version (u32) | byte order mark (u32) | 0 (u32)
+     *   chunk:  "EFCK" | header size (u32) | rows (u64) | columns (u32)
+     *           | port name size (u32) | port name
+     *           | for each column: type (u32) | name size (u32) | name
+     *           | padding to 8 bytes
+     *           | time (f64 x rows) | each column (f64 or i64 x rows)
+     *
+     * Every column of a chunk is 8-byte aligned, so that a mapped file can
+     * be read in place (see ColumnReader). A chunk describes its own
+     * columns: a new chunk is started when the members of a port's output
+     * change. Columns whose values are all integral (and fit in an int64) are
+     * stored as i64.
+     *
+     * Output values that are not numeric are not written (see skipped()).
+     */
+    class ColumnWriter
+    {
+    public:
+
+      /** column types */
+      enum ColumnType { F64 = 0, I64 = 1 };
+
+      /** default number of rows per chunk */
+      static const std::size_t CHUNK_ROWS = 4096;
+
+      /**
+       * constructor
+       *
+       * @param aCr_out output stream (binary)
+       * @param ab_append whether the stream is appended to an existing file
+       *                  (the file header is then not written)
+       * @param ai_chunkRows number of rows per chunk
+       */
+      ColumnWriter(std::ostream& aCr_out, bool ab_append = false,
+		   std::size_t ai_chunkRows = CHUNK_ROWS);
+      ~ColumnWriter();
+
+      /**
+       * Buffers a numeric output value.
+       *
+       * @param aCr_value output value
+       * @param ad_time time of the output
+       * @returns whether the value was numeric
+       */
+      bool write(const IO_Type& aCr_value, double ad_time);
+
+      /** Writes out the buffered rows of every port, and flushes the stream. */
+      void flush();
+
+      /** @returns number of output values that were not numeric */
+      std::uint64_t skipped() const { return ml_skipped; }
+
+    protected:
+
+      /** buffered values of a column (integral until a value is not) */
+      struct Column {
+	bool mb_integral;		     // whether the values are integral
+	std::vector<std::int64_t> mC1_integers; // values, while integral
+	std::vector<double> mC1_doubles;     // values, once not integral
+      };
+
+      /** buffered rows of a port */
+      struct Series {
+	std::vector<std::string> mC1_names; // column names
+	std::vector<double> mC1_time;	     // time column
+	std::vector<Column> mC1_columns;     // value columns
+      };
+
+      void begin(Series& aCr_series, const std::vector<std::string>& aCr_names);
+
+      void writeChunk(const PortType& aCr_port, Series& aCr_series);
+
+    private:
+
+      ColumnWriter(const ColumnWriter&);
+      ColumnWriter& operator=(const ColumnWriter&);
+
+      /** output stream */
+      std::ostream& mCr_out;
+
+      /** number of rows per chunk */
+      std::size_t mi_chunkRows;
+
+      /** number of output values that were not numeric */
+      std::uint64_t ml_skipped;
+
+      /** buffered rows of each port */
+      std::unordered_map<PortType, Series> mCC_series;
+
+      /** numeric members of the current value (reused) */
+      std::vector<std::string> mC1_names;
+      std::vector<double> mC1_values;
+      std::vector<std::int64_t> mC1_integers;
+      std::vector<bool> mC1_integral;
+
+    };				// class ColumnWriter
+
+    /**
+     * Implements a reader of efscape column files (see ColumnWriter). The
+     * file is mapped into memory and its chunks are indexed when it is
+     * opened; the columns are then read in place, without copying or
+     * parsing.
+     */
+    class ColumnReader
+    {
+    public:
+
+      /** column of a chunk */
+      struct Column {
+	std::string name;	// name ("value" for a numeric port value)
+	ColumnWriter::ColumnType type; // value type
+	const char* data;	// start of the values in the file
+
+	/** @returns value i (converted to double) */
+	double at(std::size_t i) const {
+	  return (type == ColumnWriter::I64 ?
+		  double(reinterpret_cast<const std::int64_t*>(data)[i]) :
+		  reinterpret_cast<const double*>(data)[i]);
+	}
+
+	/** @returns values (null if the column is not F64) */
+	const double* doubles() const {
+	  return (type == ColumnWriter::F64 ?
+		  reinterpret_cast<const double*>(data) : NULL);
+	}
+
+	/** @returns values (null if the column is not I64) */
+	const std::int64_t* integers() const {
+	  return (type == ColumnWriter::I64 ?
+		  reinterpret_cast<const std::int64_t*>(data) : NULL);
+	}
+      };
+
+      /** chunk of a port's output */
+      struct Chunk {
+	std::string port;	// port name
+	std::size_t rows;	// number of rows
+	const double* time;	// time column
+	std::vector<Column> columns; // value columns
+      };
+
+      /**
+       * constructor
+       *
+       * @param aCr_fileName name of the column file
+       * @throws std::logic_error if the file is not a valid column file
+       */
+      ColumnReader(const std::string& aCr_fileName)
+	throw(std::logic_error);
+
+      /** @returns chunks of the file (in file order) */
+      const std::vector<Chunk>& chunks() const { return mC1_chunks; }
+
+      /**
+       * @param aCr_port port name
+       * @returns chunks of a port (in file order, i.e. by time)
+       */
+      std::vector<const Chunk*> chunks(const std::string& aCr_port) const;
+
+      /** @returns names of the ports (in order of their first chunk) */
+      std::vector<std::string> ports() const;
+
+    private:
+
+      /** mapped file */
+      std::unique_ptr<efscape::utils::MappedFile> mCp_file;
+
+      /** chunks of the file */
+      std::vector<Chunk> mC1_chunks;
+
+    };				// class ColumnReader
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_COLUMNSTORE_HPP
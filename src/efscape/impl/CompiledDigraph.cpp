@@ -0,0 +1,160 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : CompiledDigraph.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/CompiledDigraph.hpp>
+
+#include <algorithm>
+#include <memory>
+
+namespace efscape {
+
+  namespace impl {
+
+    CompiledDigraph::CompiledDigraph() :
+      DIGRAPH(),
+      mb_stale(false),
+      mb_tracking(true)
+    {}
+
+    void CompiledDigraph::add(Component* aCp_model)
+    {
+      DIGRAPH::add(aCp_model);
+      mb_stale = true;
+    }
+
+    void CompiledDigraph::couple(Component* aCp_src, PortType aC_srcPort,
+				 Component* aCp_dst, PortType aC_dstPort)
+    {
+      DIGRAPH::couple(aCp_src, aC_srcPort, aCp_dst, aC_dstPort);
+
+      Coupling lC_coupling = { aCp_src, aC_srcPort, aCp_dst, aC_dstPort };
+      mC1_couplings.push_back(lC_coupling);
+      mb_stale = true;
+    }
+
+    DEVS* CompiledDigraph::clone() const
+    {
+      if (!mb_tracking)
+	return NULL;
+
+      adevs::Set<Component*> lCC_components;
+      const_cast<CompiledDigraph*>(this)->getComponents(lCC_components);
+
+      // the copy owns the component clones as soon as they are added
+      std::unique_ptr<CompiledDigraph> lCp_clone(new CompiledDigraph);
+      std::unordered_map<const Component*, Component*> lCCp_clones;
+      lCCp_clones[this] = lCp_clone.get();
+
+      for (adevs::Set<Component*>::const_iterator iter =
+	     lCC_components.begin(); iter != lCC_components.end(); iter++) {
+	const Cloneable* lCp_cloneable =
+	  dynamic_cast<const Cloneable*>(*iter);
+	Component* lCp_component =
+	  (lCp_cloneable ? lCp_cloneable->clone() : NULL);
+	if (lCp_component == NULL)
+	  return NULL;
+	lCp_clone->add(lCp_component);
+	lCCp_clones[*iter] = lCp_component;
+      }
+
+      for (std::size_t i = 0; i < mC1_couplings.size(); i++) {
+	const Coupling& lC_coupling = mC1_couplings[i];
+	lCp_clone->couple(lCCp_clones[lC_coupling.src], lC_coupling.srcPort,
+			  lCCp_clones[lC_coupling.dst], lC_coupling.dstPort);
+      }
+      lCp_clone->compile();
+
+      return lCp_clone.release();
+    }
+
+    void CompiledDigraph::route(const IO_Type& aCr_value,
+				Component* aCp_model,
+				adevs::Bag< adevs::Event<IO_Type> >&
+				aCr_receivers)
+    {
+      if (!mb_tracking) {
+	DIGRAPH::route(aCr_value, aCp_model, aCr_receivers);
+	return;
+      }
+
+      if (mb_stale.load(std::memory_order_acquire))
+	compile();
+
+      std::unordered_map< Source, std::pair<std::uint32_t, std::uint32_t>,
+			  SourceHash >::const_iterator iter =
+	mCC_sources.find( Source(aCp_model, aCr_value.port) );
+      if (iter == mCC_sources.end())
+	return;
+
+      adevs::Event<IO_Type> lC_event;
+      for (std::uint32_t i = iter->second.first; i < iter->second.second;
+	   i++) {
+	const Receiver& lC_receiver = mC1_receivers[i];
+	lC_event.model = lC_receiver.model;
+	lC_event.value.port = lC_receiver.port;
+	lC_event.value.value = aCr_value.value;
+	aCr_receivers.insert(lC_event);
+      }
+    }
+
+    void CompiledDigraph::compile()
+    {
+      // route() may be called concurrently by the parallel simulators: the
+      // first caller to find the table stale rebuilds it
+      std::lock_guard<std::mutex> lC_lock(mC_mutex);
+      if (!mb_stale.load(std::memory_order_relaxed))
+	return;
+
+      // group the couplings by source, keeping their order within a source
+      std::vector<std::size_t> lC1_order(mC1_couplings.size());
+      for (std::size_t i = 0; i < lC1_order.size(); i++)
+	lC1_order[i] = i;
+      std::stable_sort(lC1_order.begin(), lC1_order.end(),
+		       [this](std::size_t a, std::size_t b) {
+			 const Coupling& lCr_a = mC1_couplings[a];
+			 const Coupling& lCr_b = mC1_couplings[b];
+			 if (lCr_a.src != lCr_b.src)
+			   return std::less<const Component*>()(lCr_a.src,
+								lCr_b.src);
+			 return lCr_a.srcPort < lCr_b.srcPort;
+		       });
+
+      mC1_receivers.clear();
+      mC1_receivers.reserve(mC1_couplings.size());
+      mCC_sources.clear();
+      mCC_sources.reserve(mC1_couplings.size());
+
+      for (std::size_t i = 0; i < lC1_order.size(); i++) {
+	const Coupling& lC_coupling = mC1_couplings[lC1_order[i]];
+	Source lC_source(lC_coupling.src, lC_coupling.srcPort);
+
+	std::uint32_t li_index = mC1_receivers.size();
+	std::pair<std::uint32_t, std::uint32_t>& lC_range =
+	  mCC_sources.insert(std::make_pair(lC_source,
+					    std::make_pair(li_index,
+							   li_index)))
+	  .first->second;
+	lC_range.second = li_index + 1;
+
+	Receiver lC_receiver = { lC_coupling.dst, lC_coupling.dstPort };
+	mC1_receivers.push_back(lC_receiver);
+      }
+
+      mb_stale.store(false, std::memory_order_release);
+    }
+
+  } // namespace impl
+
+} // namespace efscape
@@ -0,0 +1,190 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : CompiledDigraph.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_COMPILEDDIGRAPH_HPP
+#define EFSCAPE_IMPL_COMPILEDDIGRAPH_HPP
+
+#include <efscape/impl/efscapelib.hpp>
+#include <efscape/impl/Cloneable.hpp>
+
+#include <adevs_cereal.hpp>
+#include <cereal/access.hpp>
+#include <cereal/types/base_class.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Implements a digraph model whose couplings are compiled into a
+     * routing table. adevs::Digraph looks up the receivers of every routed
+     * event in an ordered map keyed by (model, port) nodes. A
+     * CompiledDigraph records its couplings as they are made, and freezes
+     * them into contiguous fan-out arrays, one per source (model, port):
+     * route() then takes one hash lookup on the (model, port symbol) pair
+     * plus a linear scan of the receivers, in coupling order.
+     *
+     * Adding a component or a coupling through this class marks the table
+     * stale, and the table is recompiled (once, under a lock) before the
+     * next event is routed. Couplings made through an adevs::Digraph
+     * pointer bypass the record, so the builders use this class directly.
+     * A digraph restored from an archive does not know its couplings and
+     * routes through adevs::Digraph.
+     *
+     * Since it knows its couplings, a CompiledDigraph can also copy itself
+     * (Cloneable) when all of its components can.
+     */
+    class CompiledDigraph : public DIGRAPH, public Cloneable
+    {
+    public:
+
+      typedef DIGRAPH::Component Component;
+
+      CompiledDigraph();
+
+      /**
+       * Adds a component model.
+       *
+       * @param aCp_model handle to model
+       */
+      void add(Component* aCp_model);
+
+      /**
+       * Couples a source (model, port) to a destination (model, port).
+       *
+       * @param aCp_src source model
+       * @param aC_srcPort source port
+       * @param aCp_dst destination model
+       * @param aC_dstPort destination port
+       */
+      void couple(Component* aCp_src, PortType aC_srcPort,
+		  Component* aCp_dst, PortType aC_dstPort);
+
+      /**
+       * Routes an output value of a component (or an input value of this
+       * network) to its receivers.
+       *
+       * @param aCr_value value
+       * @param aCp_model model that produced the value
+       * @param aCr_receivers receivers of the value
+       */
+      void route(const IO_Type& aCr_value, Component* aCp_model,
+		 adevs::Bag< adevs::Event<IO_Type> >& aCr_receivers) override;
+
+      /** Compiles the routing table (if it is stale). */
+      void compile();
+
+      /** @returns whether the routing table is up to date */
+      bool isCompiled() const { return !mb_stale.load(); }
+
+      /** @returns whether events are routed through the routing table */
+      bool isTracking() const { return mb_tracking; }
+
+      /** @returns number of recorded couplings */
+      std::size_t numCouplings() const { return mC1_couplings.size(); }
+
+      /**
+       * Stops routing through the routing table, for a digraph whose
+       * couplings were made without being recorded (e.g. restored from an
+       * archive).
+       */
+      void stopTracking() { mb_tracking = false; }
+
+      /**
+       * Returns a deep copy of the digraph: each component is cloned, and
+       * the recorded couplings are made again between the clones. A
+       * digraph that does not know its couplings, or that has a component
+       * which is not Cloneable, cannot be copied this way.
+       *
+       * @returns handle to the copy (null if the digraph cannot be copied)
+       */
+      DEVS* clone() const;
+
+    private:
+
+      friend class cereal::access;
+
+      template<class Archive>
+      void save(Archive& ar) const
+      {
+	ar( cereal::make_nvp("adevs::Digraph",
+			     cereal::base_class<DIGRAPH>(this) ) );
+      }
+
+      template<class Archive>
+      void load(Archive& ar)
+      {
+	ar( cereal::make_nvp("adevs::Digraph",
+			     cereal::base_class<DIGRAPH>(this) ) );
+	stopTracking();
+      }
+
+      /** a coupling, as recorded */
+      struct Coupling {
+	Component* src;
+	PortType srcPort;
+	Component* dst;
+	PortType dstPort;
+      };
+
+      /** a receiver in a fan-out array */
+      struct Receiver {
+	Component* model;
+	PortType port;
+      };
+
+      /** a source (model, port) */
+      typedef std::pair<const Component*, PortType> Source;
+
+      struct SourceHash {
+	std::size_t operator()(const Source& aCr_source) const {
+	  return std::hash<const Component*>()(aCr_source.first)*31 +
+	    aCr_source.second.hash();
+	}
+      };
+
+      /** recorded couplings, in the order they were made */
+      std::vector<Coupling> mC1_couplings;
+
+      /** fan-out arrays, contiguous by source */
+      std::vector<Receiver> mC1_receivers;
+
+      /** range of the fan-out array of each source in mC1_receivers */
+      std::unordered_map< Source, std::pair<std::uint32_t, std::uint32_t>,
+			  SourceHash > mCC_sources;
+
+      /** whether the routing table must be recompiled */
+      std::atomic<bool> mb_stale;
+
+      /** guards recompilation */
+      std::mutex mC_mutex;
+
+      /** whether the couplings are known (routing table in use) */
+      bool mb_tracking;
+
+    };				// class CompiledDigraph
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_COMPILEDDIGRAPH_HPP
@@ -0,0 +1,84 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : DirtySet.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/DirtySet.hpp>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * constructor
+     *
+     * @param aCp_root handle to root model
+     */
+    DirtySet::DirtySet(DEVS* aCp_root) :
+      mC_index(aCp_root)
+    {
+      const std::vector<ATOMIC*>& lC1_atomics = mC_index.atomics();
+      mCC_positions.reserve(lC1_atomics.size());
+      for (std::size_t i = 0; i < lC1_atomics.size(); i++)
+	mCC_positions[lC1_atomics[i]] = i;
+      mC1_flags.assign(lC1_atomics.size(), 0);
+    }
+
+    /**
+     * Marks a model whose state changed.
+     *
+     * @param aCp_model handle to atomic model
+     * @param t time of the change
+     */
+    void DirtySet::stateChange(adevs::Atomic<IO_Type>* aCp_model, double t)
+    {
+      mark(aCp_model);
+    }
+
+    /**
+     * Marks a model whose state changed. Models that are not under the root
+     * are ignored.
+     *
+     * @param aCp_model handle to atomic model
+     */
+    void DirtySet::mark(const ATOMIC* aCp_model)
+    {
+      auto iter = mCC_positions.find(aCp_model);
+      if (iter == mCC_positions.end() || mC1_flags[iter->second])
+	return;
+
+      mC1_flags[iter->second] = 1;
+      mC1_dirty.push_back(iter->second);
+    }
+
+    /** Marks every model. */
+    void DirtySet::markAll()
+    {
+      mC1_dirty.clear();
+      for (std::size_t i = 0; i < mC1_flags.size(); i++) {
+	mC1_flags[i] = 1;
+	mC1_dirty.push_back(i);
+      }
+    }
+
+    /** Clears the set. */
+    void DirtySet::clear()
+    {
+      for (std::size_t i : mC1_dirty)
+	mC1_flags[i] = 0;
+      mC1_dirty.clear();
+    }
+
+  } // namespace impl
+
+} // namespace efscape
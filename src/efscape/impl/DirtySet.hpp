@@ -0,0 +1,87 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : DirtySet.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_DIRTYSET_HPP
+#define EFSCAPE_IMPL_DIRTYSET_HPP
+
+#include <efscape/impl/efscapelib.hpp>
+#include <efscape/impl/AtomicIndex.hpp>
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Records the atomic models under a root model whose state changed since
+     * the set was last cleared, as reported by the simulator through the
+     * stateChange() callback of its event listeners. Marking a model is a
+     * hash lookup, and the set lists the changed models by their position in
+     * the AtomicIndex of the root, so that the cost of an incremental
+     * checkpoint follows the activity of the model rather than its size.
+     */
+    class DirtySet : public adevs::EventListener<IO_Type>
+    {
+    public:
+
+      explicit DirtySet(DEVS* aCp_root);
+
+      //---------------------------
+      // adevs EventListener method
+      //---------------------------
+      void stateChange(adevs::Atomic<IO_Type>* aCp_model, double t) override;
+
+      void mark(const ATOMIC* aCp_model);
+
+      void markAll();
+
+      void clear();
+
+      /** @returns positions of the changed models in the atomic index */
+      const std::vector<std::size_t>& indices() const { return mC1_dirty; }
+
+      /** @returns whether no model changed */
+      bool empty() const { return mC1_dirty.empty(); }
+
+      /** @returns atomic models under the root */
+      const std::vector<ATOMIC*>& atomics() { return mC_index.atomics(); }
+
+      /** @returns handle to root model */
+      DEVS* getRoot() const { return mC_index.getRoot(); }
+
+    private:
+
+      /** atomic models under the root */
+      AtomicIndex mC_index;
+
+      /** position of each atomic model in the index */
+      std::unordered_map<const ATOMIC*, std::size_t> mCC_positions;
+
+      /** whether each atomic model changed */
+      std::vector<char> mC1_flags;
+
+      /** positions of the changed models */
+      std::vector<std::size_t> mC1_dirty;
+
+    };				// class DirtySet
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_DIRTYSET_HPP
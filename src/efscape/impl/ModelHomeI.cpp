@@ -15,6 +15,8 @@
 // __COPYRIGHT_END__
 #include <efscape/impl/ModelHomeI.hpp> // class declaration
 
+#include <efscape/utils/MappedFile.hpp>
+
 #include <log4cxx/propertyconfigurator.h> // logging
 
 // Include for handling JSON
@@ -24,6 +26,7 @@
 #include <boost/filesystem/fstream.hpp>
 
 #include <sstream>
+#include <cctype>
 #include <cstdlib>
 
 #include <locale>
@@ -66,6 +69,7 @@ namespace efscape {
       // initialize factories
       mCp_ModelFactory.reset( new model_factory );
       mCp_CommandFactory.reset( new command_factory );
+      mCp_PrototypeCache.reset( new PrototypeCache );
 
       LOG4CXX_DEBUG(getLogger(), "Created EFSCAPE model respository...");
 
@@ -153,16 +157,58 @@ namespace efscape {
       LOG4CXX_DEBUG(getLogger(),
 		    "attempting to create model from a JSON configuration...");
 
-      // Load JSON contents into a stringstream buffer
-      std::stringstream lC_buffer(aC_jsonString);
+      // read the JSON contents in place
       LOG4CXX_DEBUG(ModelHomeI::getLogger(),
 		    "Received JSON string =>"
-		    << lC_buffer.str());
+		    << aC_jsonString);
+      efscape::utils::ViewBuffer lC_view(aC_jsonString.data(),
+					 aC_jsonString.size());
+      std::istream lC_buffer(&lC_view);
 
       return loadAdevsFromJSON(lC_buffer);
 
     } // ModelHomeI::createModelFromJSON(std::string)
 
+    /**
+     * Creates a model from a snapshot file: an efscape binary snapshot, a
+     * cereal JSON archive or a boost XML archive (detected from the start
+     * of the file). The file is mapped into memory and deserialized in
+     * place, so that restoring a large model does not also hold a copy of
+     * its snapshot.
+     *
+     * @param acp_filename name of the snapshot file
+     * @returns smart pointer to model
+     * @throws std::logic_error
+     */
+    DEVSPtr
+    ModelHomeI::createModelFromSnapshot(const char* acp_filename)
+      throw(std::logic_error)
+    {
+      LOG4CXX_DEBUG(getLogger(),
+		    "Attempting to restore a model from snapshot <"
+		    << acp_filename << ">...");
+
+      efscape::utils::MappedFile lC_file(acp_filename);
+      efscape::utils::ViewBuffer lC_view(lC_file.data(), lC_file.size());
+      std::istream lC_buffer(&lC_view);
+
+      // skip leading white space to find the format of a text archive
+      std::size_t li_first = 0;
+      while (li_first < lC_file.size() &&
+	     std::isspace(static_cast<unsigned char>(lC_file.data()[li_first])))
+	li_first++;
+
+      if (lC_file.size() >= 4 &&
+	  std::string(lC_file.data(), 4) == "EFSB")
+	return loadAdevsFromBinary(lC_buffer);
+
+      if (li_first < lC_file.size() && lC_file.data()[li_first] == '<')
+	return DEVSPtr( loadAdevsFromXML(lC_buffer) );
+
+      return loadAdevsFromJSON(lC_buffer);
+
+    } // ModelHomeI::createModelFromSnapshot(const char*)
+
     /**
      * Creates a model from a model parameters stored in a JSON
      * string.
@@ -188,6 +234,25 @@ namespace efscape {
       Json::Value lC_parameters;
       lC_buffer >> lC_parameters;
 
+      return createModelFromParameters(lC_parameters);
+
+    } // ModelHomeI::createModelFromParameters(std:;string)
+
+    /**
+     * Creates a model from model parameters that have already been parsed,
+     * which allows a caller to build several models from one parameter
+     * file without parsing it again.
+     *
+     * @param aCr_parameters model configuration
+     * @returns smart pointer to model
+     * @throws std::logic_error
+     */
+    DEVSPtr
+    ModelHomeI::createModelFromParameters(const Json::Value& aCr_parameters)
+      throw(std::logic_error)
+    {
+      const Json::Value& lC_parameters = aCr_parameters;
+
       // retrieve <typeName>
       //
       Json::Value lC_modelTypeNameValue = lC_parameters["typeName"];
@@ -232,7 +297,29 @@ namespace efscape {
 
       return lCp_model;
 
-    } // ModelHomeI::createModelFromParameters(std:;string)
+    } // ModelHomeI::createModelFromParameters(const Json::Value&)
+
+    /**
+     * Creates a model from model parameters, cloning it from the cached
+     * prototype of the parameters if the same parameters have been used
+     * before. Intended for callers that instantiate the same configuration
+     * many times (e.g. the server, with one model per client session).
+     *
+     * @param aCr_parameters model configuration
+     * @returns smart pointer to model
+     * @throws std::logic_error
+     */
+    DEVSPtr
+    ModelHomeI::createModelFromPrototype(const Json::Value& aCr_parameters)
+      throw(std::logic_error)
+    {
+      return getPrototypeCache().
+	instance(aCr_parameters,
+		 [this](const Json::Value& aCr_config) {
+		   return createModelFromParameters(aCr_config);
+		 });
+
+    } // ModelHomeI::createModelFromPrototype(const Json::Value&)
 
     /**
      * Loads the specified library.
@@ -390,6 +477,17 @@ namespace efscape {
       return *mCp_CommandFactory;
     }
 
+    /**
+     * Returns a reference to the cache of model prototypes
+     *
+     * @returns reference to PrototypeCache
+     */
+    PrototypeCache& ModelHomeI::getPrototypeCache() {
+      if (mCp_PrototypeCache.get() == NULL)
+	mCp_PrototypeCache.reset( new PrototypeCache );
+      return *mCp_PrototypeCache;
+    }
+
     /**
      * Returns smart handle to logger.
      *
@@ -19,6 +19,7 @@
 #include <efscape/impl/efscapelib.hpp>
 #include <efscape/utils/CommandOpt.hpp>
 #include <efscape/utils/Factory.hpp>
+#include <efscape/impl/PrototypeCache.hpp>
 #include <boost/mpi/communicator.hpp>
 
 #include <log4cxx/logger.h>
@@ -56,11 +57,18 @@ namespace efscape {
 	throw(std::logic_error);
       DEVSPtr createModelFromJSON(std::string aC_JSONstring)
 	throw(std::logic_error);
+      DEVSPtr createModelFromSnapshot(const char* acp_filename)
+	throw(std::logic_error);
       DEVSPtr createModelFromParameters(std::string aC_ParameterString)
 	throw(std::logic_error);
+      DEVSPtr createModelFromParameters(const Json::Value& aCr_parameters)
+	throw(std::logic_error);
+      DEVSPtr createModelFromPrototype(const Json::Value& aCr_parameters)
+	throw(std::logic_error);
 
       model_factory& getModelFactory();
       command_factory& getCommandFactory();
+      PrototypeCache& getPrototypeCache();
 
       /**
        * Returns the output path on the server.
@@ -105,6 +113,7 @@ namespace efscape {
 
       std::unique_ptr<model_factory> mCp_ModelFactory;
       std::unique_ptr< command_factory > mCp_CommandFactory;
+      std::unique_ptr< PrototypeCache > mCp_PrototypeCache;
       std::map< std::string, std::shared_ptr<boost::dll::shared_library> > mCCp_libraries;
 
     };				// class ModelHomeI definition
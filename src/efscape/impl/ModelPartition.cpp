@@ -0,0 +1,118 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : ModelPartition.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/ModelPartition.hpp>
+
+#include <efscape/utils/type.hpp>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+namespace efscape {
+
+  namespace impl {
+
+    namespace {
+
+      // collects a model and all the models below it
+      void collect(DEVS* aCp_model, std::vector<DEVS*>& aCr_models)
+      {
+	aCr_models.push_back(aCp_model);
+	NETWORK* lCp_network = aCp_model->typeIsNetwork();
+	if (lCp_network == NULL)
+	  return;
+	adevs::Set<DEVS*> lC_components;
+	lCp_network->getComponents(lC_components);
+	for (adevs::Set<DEVS*>::iterator iter = lC_components.begin();
+	     iter != lC_components.end(); iter++)
+	  collect(*iter, aCr_models);
+      }
+
+    } // namespace
+
+    std::size_t partitionModel(DEVS* aCp_root, unsigned int ai_partitions,
+			       std::vector< std::vector<DEVS*> >&
+			       aCC_components,
+			       PartitionMap& aCC_owners)
+    {
+      std::vector<DEVS*> lC1_components;
+      NETWORK* lCp_root = aCp_root->typeIsNetwork();
+      if (lCp_root != NULL) {
+	adevs::Set<DEVS*> lC_components;
+	lCp_root->getComponents(lC_components);
+	lC1_components.assign(lC_components.begin(), lC_components.end());
+      }
+      else
+	lC1_components.push_back(aCp_root);
+
+      // the components of a network are held in pointer order: they are
+      // ordered by type so that the assignment does not depend on where
+      // they were allocated (components of the same type keep their order)
+      std::vector< std::pair<std::string, DEVS*> > lC1_keyed;
+      for (DEVS* lCp_component : lC1_components)
+	lC1_keyed.push_back
+	  ( std::make_pair(efscape::utils::type<DEVS>(*lCp_component),
+			   lCp_component) );
+      std::stable_sort(lC1_keyed.begin(), lC1_keyed.end(),
+		       [](const std::pair<std::string, DEVS*>& a,
+			  const std::pair<std::string, DEVS*>& b) {
+			 return a.first < b.first;
+		       });
+      for (std::size_t c = 0; c < lC1_keyed.size(); c++)
+	lC1_components[c] = lC1_keyed[c].second;
+
+      // the models under each component, and its number of atomic models
+      std::vector< std::vector<DEVS*> > lCC_models(lC1_components.size());
+      std::vector< std::pair<std::size_t, std::size_t> > lC1_sizes;
+      for (std::size_t c = 0; c < lC1_components.size(); c++) {
+	collect(lC1_components[c], lCC_models[c]);
+	std::size_t ll_atomics = 0;
+	for (std::size_t k = 0; k < lCC_models[c].size(); k++)
+	  if (lCC_models[c][k]->typeIsAtomic() != NULL)
+	    ll_atomics++;
+	lC1_sizes.push_back(std::make_pair(ll_atomics, c));
+      }
+
+      std::size_t ll_partitions =
+	std::max<std::size_t>(1, std::min<std::size_t>(ai_partitions,
+							lC1_components.size()));
+      aCC_components.assign(ll_partitions, std::vector<DEVS*>());
+      aCC_owners.clear();
+
+      // longest processing time first: the largest remaining component
+      // goes to the partition with the fewest atomic models
+      std::stable_sort(lC1_sizes.begin(), lC1_sizes.end(),
+		       [](const std::pair<std::size_t, std::size_t>& a,
+			  const std::pair<std::size_t, std::size_t>& b) {
+			 return a.first > b.first;
+		       });
+      std::vector<std::size_t> lC1_loads(ll_partitions, 0);
+      for (std::size_t k = 0; k < lC1_sizes.size(); k++) {
+	std::size_t c = lC1_sizes[k].second;
+	std::size_t p = std::min_element(lC1_loads.begin(), lC1_loads.end()) -
+	  lC1_loads.begin();
+	lC1_loads[p] += lC1_sizes[k].first;
+	aCC_components[p].push_back(lC1_components[c]);
+	for (std::size_t m = 0; m < lCC_models[c].size(); m++)
+	  aCC_owners[ lCC_models[c][m] ] = p;
+      }
+
+      return ll_partitions;
+    }
+
+  } // namespace impl
+
+} // namespace efscape
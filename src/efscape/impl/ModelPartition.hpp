@@ -0,0 +1,54 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : ModelPartition.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_MODELPARTITION_HPP
+#define EFSCAPE_IMPL_MODELPARTITION_HPP
+
+#include <efscape/impl/efscapelib.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+namespace efscape {
+
+  namespace impl {
+
+    /** maps each model under a root to the partition that owns it */
+    typedef std::unordered_map<const DEVS*, std::size_t> PartitionMap;
+
+    /**
+     * Splits the components of a root network among partitions, for the
+     * parallel simulators. Components are assigned longest first to the
+     * partition with the fewest atomic models, in the order of their type
+     * names among components of the same size. A root that is not a network
+     * forms a single partition.
+     *
+     * @param aCp_root handle to root model
+     * @param ai_partitions requested number of partitions
+     * @param aCC_components receives the components of each partition
+     * @param aCC_owners receives the partition of every component and of
+     *                   the models below it
+     * @returns number of partitions (at most the number of components)
+     */
+    std::size_t partitionModel(DEVS* aCp_root, unsigned int ai_partitions,
+			       std::vector< std::vector<DEVS*> >&
+			       aCC_components,
+			       PartitionMap& aCC_owners);
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_MODELPARTITION_HPP
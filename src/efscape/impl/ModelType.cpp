@@ -102,6 +102,14 @@ namespace efscape {
       return mC_attributes["properties"];
     }
 
+    void ModelType::setLookahead(double ad_lookahead) {
+      mC_attributes["lookahead"] = ad_lookahead;
+    }
+
+    double ModelType::lookahead() const {
+      return mC_attributes.get("lookahead", 0.).asDouble();
+    }
+
     Json::Value ModelType::toJSON() const {
       return mC_attributes;
     }
@@ -86,6 +86,18 @@ namespace efscape {
       Json::Value setProperties(Json::Value aC_properties);
       Json::Value getProperties() const;
 
+      /**
+       * Declares the lookahead of the model type: the minimum delay between
+       * an input event and any output that it causes. It allows partitions
+       * of a parallel simulation to run ahead of each other.
+       *
+       * @param ad_lookahead lookahead (must be non-negative)
+       */
+      void setLookahead(double ad_lookahead);
+
+      /** @returns declared lookahead (0 if not declared) */
+      double lookahead() const;
+
       Json::Value toJSON() const;
 
     protected:
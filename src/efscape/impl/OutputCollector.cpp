@@ -0,0 +1,43 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : OutputCollector.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/OutputCollector.hpp>
+
+namespace efscape {
+
+  namespace impl {
+
+    /** constructor */
+    OutputCollector::OutputCollector(const DEVS* aCp_root, bool ab_rootOnly) :
+      mCp_root(aCp_root),
+      mb_rootOnly(ab_rootOnly),
+      mCp_filter(NULL)
+    {}
+
+    void OutputCollector::outputEvent(adevs::Event<IO_Type> x, double t)
+    {
+      // network output is reported as it is routed, so the external output
+      // of the simulated model is the set of events generated by the root
+      if (mb_rootOnly && x.model != mCp_root)
+	return;
+      if (mCp_filter && !mCp_filter->accepts(x.value.port))
+	return;
+
+      mC1_events.push_back(TimedEvent(x, t));
+    }
+
+  } // namespace impl
+
+} // namespace efscape
@@ -0,0 +1,125 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : OutputCollector.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_OUTPUTCOLLECTOR_HPP
+#define EFSCAPE_IMPL_OUTPUTCOLLECTOR_HPP
+
+#include <efscape/impl/efscapelib.hpp>
+#include <efscape/impl/PortFilter.hpp>
+
+#include <utility>
+#include <vector>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Implements an event listener that captures the output events actually
+     * produced by a simulator. Unlike get_output(), which calls output_func()
+     * on every atomic model, only imminent models contribute output, and
+     * models whose output function has side effects are not invoked again.
+     *
+     * The collector can be restricted to events on the ports of the root
+     * model (i.e. the external output of the simulated model), and to the
+     * ports of a PortFilter, in which case other events are never stored.
+     */
+    class OutputCollector : public adevs::EventListener<IO_Type>
+    {
+    public:
+
+      /** output event with the time it was produced at */
+      typedef std::pair< adevs::Event<IO_Type>, double > TimedEvent;
+
+      /**
+       * constructor
+       *
+       * @param aCp_root handle to root model
+       * @param ab_rootOnly whether to capture only root model output
+       */
+      OutputCollector(const DEVS* aCp_root = NULL, bool ab_rootOnly = false);
+
+      //---------------------------
+      // adevs EventListener method
+      //---------------------------
+      void outputEvent(adevs::Event<IO_Type> x, double t) override;
+
+      /**
+       * Returns the captured output events, each with its own time (a step
+       * of a partitioned simulator covers many event times).
+       *
+       * @returns captured output events, in the order they were produced
+       */
+      const std::vector<TimedEvent>& events() const {
+	return mC1_events;
+      }
+
+      /** @returns whether any output has been captured */
+      bool empty() const { return mC1_events.empty(); }
+
+      /** Discards the captured output (keeps the storage). */
+      void clear() { mC1_events.clear(); }
+
+      /**
+       * Sets the root model.
+       *
+       * @param aCp_root handle to root model
+       */
+      void setRoot(const DEVS* aCp_root) { mCp_root = aCp_root; }
+
+      /** @returns handle to root model */
+      const DEVS* getRoot() const { return mCp_root; }
+
+      /**
+       * Sets whether to capture only output on the ports of the root model.
+       *
+       * @param ab_rootOnly root model output flag
+       */
+      void setRootOnly(bool ab_rootOnly) { mb_rootOnly = ab_rootOnly; }
+
+      /** @returns whether only root model output is captured */
+      bool isRootOnly() const { return mb_rootOnly; }
+
+      /**
+       * Sets the ports whose output is captured.
+       *
+       * @param aCp_filter handle to port filter (null: all ports)
+       */
+      void setFilter(const PortFilter* aCp_filter) { mCp_filter = aCp_filter; }
+
+      /** @returns handle to port filter (null if none) */
+      const PortFilter* getFilter() const { return mCp_filter; }
+
+    private:
+
+      /** handle to root model */
+      const DEVS* mCp_root;
+
+      /** whether to capture only root model output */
+      bool mb_rootOnly;
+
+      /** handle to port filter (null: all ports) */
+      const PortFilter* mCp_filter;
+
+      /** captured output events */
+      std::vector<TimedEvent> mC1_events;
+
+    };				// class OutputCollector
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_OUTPUTCOLLECTOR_HPP
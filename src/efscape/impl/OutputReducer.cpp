@@ -0,0 +1,256 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : OutputReducer.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/OutputReducer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace efscape {
+
+  namespace impl {
+
+    //
+    // OutputReducer::Stats
+    //
+
+    OutputReducer::Stats::Stats() :
+      ml_count(0),
+      md_min(0.),
+      md_max(0.),
+      md_sum(0.)
+    {}
+
+    void OutputReducer::Stats::add(double ad_value)
+    {
+      if (ml_count == 0 || ad_value < md_min)
+	md_min = ad_value;
+      if (ml_count == 0 || ad_value > md_max)
+	md_max = ad_value;
+      md_sum += ad_value;
+      ml_count++;
+    }
+
+    Json::Value OutputReducer::Stats::toJSON() const
+    {
+      Json::Value lC_stats;
+      lC_stats["count"] = Json::UInt64(ml_count);
+      if (ml_count > 0) {
+	lC_stats["min"] = md_min;
+	lC_stats["max"] = md_max;
+	lC_stats["mean"] = md_sum / ml_count;
+      }
+      return lC_stats;
+    }
+
+    //
+    // OutputReducer::Reducer
+    //
+
+    OutputReducer::Reducer::Reducer() :
+      me_kind(SAMPLE),
+      ml_every(0),
+      md_window(0.),
+      mb_open(false),
+      ml_count(0),
+      md_windowEnd(0.),
+      md_time(0.)
+    {}
+
+    //
+    // OutputReducer
+    //
+
+    /** constructor */
+    OutputReducer::OutputReducer(const Json::Value& aCr_config,
+				 const Sink& aCr_sink)
+      throw(std::logic_error) :
+      mC_sink(aCr_sink),
+      md_time(0.)
+    {
+      if (!aCr_config.isObject())
+	throw std::logic_error("output reducers are not a JSON object");
+
+      try {
+	for (const auto& lC_port : aCr_config.getMemberNames()) {
+	  const Json::Value& lCr_spec = aCr_config[lC_port];
+	  if (!lCr_spec.isObject())
+	    throw std::logic_error("reducer of port <" + lC_port
+				   + "> is not a JSON object");
+
+	  // (the fields are checked before they are converted, since jsoncpp
+	  // signals a conversion error with an exception of its own)
+	  Reducer lC_reducer;
+	  if (!lCr_spec["reduce"].isString())
+	    throw std::logic_error("reducer of port <" + lC_port
+				   + "> has no <reduce> string");
+	  std::string lC_kind = lCr_spec["reduce"].asString();
+	  if (lC_kind == "sample")
+	    lC_reducer.me_kind = Reducer::SAMPLE;
+	  else if (lC_kind == "last")
+	    lC_reducer.me_kind = Reducer::LAST;
+	  else if (lC_kind == "stats")
+	    lC_reducer.me_kind = Reducer::STATS;
+	  else
+	    throw std::logic_error("reducer of port <" + lC_port
+				   + "> has an unknown reduction <" + lC_kind
+				   + "> (expected sample, last or stats)");
+
+	  if (lCr_spec.isMember("every") == lCr_spec.isMember("window"))
+	    throw std::logic_error("reducer of port <" + lC_port
+				   + "> needs either <every> or <window>");
+	  if (lCr_spec.isMember("every")) {
+	    if (!lCr_spec["every"].isUInt64())
+	      throw std::logic_error("reducer of port <" + lC_port
+				     + "> has an <every> that is not a "
+				     "non-negative integer");
+	    lC_reducer.ml_every = lCr_spec["every"].asUInt64();
+	    if (lC_reducer.ml_every == 0)
+	      throw std::logic_error("reducer of port <" + lC_port
+				     + "> has an empty window");
+	  }
+	  else {
+	    if (!lCr_spec["window"].isNumeric())
+	      throw std::logic_error("reducer of port <" + lC_port
+				     + "> has a <window> that is not a "
+				     "number");
+	    lC_reducer.md_window = lCr_spec["window"].asDouble();
+	    if ( !(lC_reducer.md_window > 0.) )
+	      throw std::logic_error("reducer of port <" + lC_port
+				     + "> has an empty window");
+	  }
+
+	  mCC_reducers[lC_port] = lC_reducer;
+	}
+      }
+      catch (const Json::Exception& lC_excp) {
+	throw std::logic_error(std::string("invalid output reducers: ")
+			       + lC_excp.what());
+      }
+    }
+
+    void OutputReducer::push(const IO_Type& aCr_value, double ad_time)
+    {
+      md_time = ad_time;
+
+      auto lC_iter = mCC_reducers.find(aCr_value.port);
+      if (lC_iter == mCC_reducers.end()) {
+	mC_sink(aCr_value, ad_time);
+	return;
+      }
+      Reducer& lCr_reducer = lC_iter->second;
+
+      // time windows: close the window the value is past, and align the
+      // next one on a multiple of the window span
+      if (lCr_reducer.ml_every == 0) {
+	if (lCr_reducer.mb_open && ad_time >= lCr_reducer.md_windowEnd)
+	  close(lCr_reducer, aCr_value.port);
+	if (!lCr_reducer.mb_open)
+	  lCr_reducer.md_windowEnd =
+	    (std::floor(ad_time / lCr_reducer.md_window) + 1.)
+	    * lCr_reducer.md_window;
+      }
+
+      lCr_reducer.md_time = ad_time;
+      add(lCr_reducer, aCr_value);
+
+      if (lCr_reducer.ml_every > 0 &&
+	  lCr_reducer.ml_count >= lCr_reducer.ml_every)
+	close(lCr_reducer, aCr_value.port);
+    }
+
+    void OutputReducer::flush()
+    {
+      // the reducers are closed in order of their port names, so that the
+      // output does not depend on the order of the table
+      std::vector<std::pair<const PortType, Reducer>*> lC1_reducers;
+      for (auto& lCr_reducer : mCC_reducers)
+	lC1_reducers.push_back(&lCr_reducer);
+      std::sort(lC1_reducers.begin(), lC1_reducers.end(),
+		[](const std::pair<const PortType, Reducer>* a,
+		   const std::pair<const PortType, Reducer>* b) {
+		  return a->first.name() < b->first.name();
+		});
+      for (auto lCp_reducer : lC1_reducers)
+	close(lCp_reducer->second, lCp_reducer->first);
+    }
+
+    void OutputReducer::add(Reducer& aCr_reducer, const IO_Type& aCr_value)
+    {
+      aCr_reducer.mb_open = true;
+      aCr_reducer.ml_count++;
+
+      switch (aCr_reducer.me_kind) {
+      case Reducer::SAMPLE:
+	if (aCr_reducer.ml_count == 1)
+	  mC_sink(aCr_value, aCr_reducer.md_time);
+	break;
+      case Reducer::LAST:
+	aCr_reducer.mC_last = aCr_value;
+	break;
+      case Reducer::STATS:
+	if (const double* lCp_number = value_cast<double>(&aCr_value.value))
+	  aCr_reducer.mC_stats.add(*lCp_number);
+	else if (const Json::Value* lCp_value =
+		 json_value_cast(&aCr_value.value)) {
+	  if (lCp_value->isNumeric())
+	    aCr_reducer.mC_stats.add(lCp_value->asDouble());
+	  else if (lCp_value->isObject()) {
+	    for (auto i = lCp_value->begin(); i != lCp_value->end(); i++)
+	      if (i->isNumeric())
+		aCr_reducer.mCC_members[i.name()].add(i->asDouble());
+	  }
+	}
+	break;
+      }
+    }
+
+    void OutputReducer::close(Reducer& aCr_reducer, const PortType& aCr_port)
+    {
+      if (!aCr_reducer.mb_open)
+	return;
+
+      if (aCr_reducer.me_kind == Reducer::LAST)
+	mC_sink(aCr_reducer.mC_last, aCr_reducer.md_time);
+      else if (aCr_reducer.me_kind == Reducer::STATS) {
+	Json::Value lC_value;
+	if (aCr_reducer.mCC_members.empty())
+	  lC_value = aCr_reducer.mC_stats.toJSON();
+	else {
+	  // the statistics of the members are nested, so that member names
+	  // cannot collide with the keys of the window
+	  Json::Value& lCr_members = lC_value["members"];
+	  for (const auto& i : aCr_reducer.mCC_members)
+	    lCr_members[i.first] = i.second.toJSON();
+	}
+
+	// time windows are stamped with their start
+	lC_value["time"] = (aCr_reducer.ml_every > 0 ? aCr_reducer.md_time :
+			    aCr_reducer.md_windowEnd - aCr_reducer.md_window);
+	lC_value["count"] = Json::UInt64(aCr_reducer.ml_count);
+	mC_sink( IO_Type(aCr_port, lC_value), aCr_reducer.md_time );
+      }
+
+      aCr_reducer.mb_open = false;
+      aCr_reducer.ml_count = 0;
+      aCr_reducer.mC_last = IO_Type();
+      aCr_reducer.mC_stats = Stats();
+      aCr_reducer.mCC_members.clear();
+    }
+
+  } // namespace impl
+
+} // namespace efscape
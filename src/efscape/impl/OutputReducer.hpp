@@ -0,0 +1,154 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : OutputReducer.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_OUTPUTREDUCER_HPP
+#define EFSCAPE_IMPL_OUTPUTREDUCER_HPP
+
+#include <efscape/impl/efscapelib.hpp>
+
+#include <json/json.h>
+
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Implements a stage of the output pipeline that decimates or aggregates
+     * the output on high-rate ports before it is serialized. Each configured
+     * port has a reducer that works on windows of either a number of values
+     * ("every": N) or a span of simulation time ("window": dt):
+     *
+     * - "sample": passes the first value of each window (as is)
+     * - "last": passes the last value of each window (as is)
+     * - "stats": passes {"time", "count", "min", "max", "mean"} for the
+     *   numeric values of each window; for JSON objects, the statistics are
+     *   computed for each numeric member, and passed as
+     *   {"time", "count", "members": {name: {"count", "min", ...}, ...}}
+     *
+     * Sampled values keep their time; the last value of a window and its
+     * statistics are passed on with the time of the window's last value.
+     *
+     * e.g. {"THROUGHPUT": {"reduce": "stats", "window": 10},
+     *       "properties_out": {"reduce": "sample", "every": 100}}
+     *
+     * Output on the other ports passes unchanged. Values that are dropped
+     * are never cast or formatted. Time windows are aligned on multiples of
+     * dt; the windows still open at the end of the run are passed on by
+     * flush(). The state of the reducers is not part of a checkpoint.
+     */
+    class OutputReducer
+    {
+    public:
+
+      /** receives the reduced output values, with their time */
+      typedef std::function<void(const IO_Type&, double)> Sink;
+
+      /**
+       * constructor
+       *
+       * @param aCr_config reducer of each port (JSON object)
+       * @param aCr_sink receives the reduced output
+       * @throws std::logic_error if the configuration is not valid
+       */
+      OutputReducer(const Json::Value& aCr_config, const Sink& aCr_sink)
+	throw(std::logic_error);
+
+      /**
+       * Passes an output value through the reducer of its port.
+       *
+       * @param aCr_value output value
+       * @param ad_time time of the output
+       */
+      void push(const IO_Type& aCr_value, double ad_time);
+
+      /**
+       * Passes on the windows that are still open, in order of their port
+       * names, and resets them.
+       */
+      void flush();
+
+      /**
+       * Sets the sink that receives the reduced output.
+       *
+       * @param aCr_sink output sink
+       */
+      void setSink(const Sink& aCr_sink) { mC_sink = aCr_sink; }
+
+      /** @returns time of the latest output value */
+      double time() const { return md_time; }
+
+      /** @returns number of ports with a reducer */
+      std::size_t size() const { return mCC_reducers.size(); }
+
+    protected:
+
+      /** running statistics of a numeric value */
+      struct Stats {
+	Stats();
+	void add(double ad_value);
+	Json::Value toJSON() const;
+
+	unsigned long ml_count;
+	double md_min;
+	double md_max;
+	double md_sum;
+      };
+
+      /** reducer of a port */
+      struct Reducer {
+	enum Kind { SAMPLE, LAST, STATS };
+
+	Reducer();
+
+	Kind me_kind;		// reduction
+	unsigned long ml_every;	// values per window (0: time windows)
+	double md_window;	// time span of a window
+
+	bool mb_open;		// whether the window has values
+	unsigned long ml_count;	// number of values in the window
+	double md_windowEnd;	// end of the time window
+	double md_time;		// time of the latest value
+	IO_Type mC_last;	// latest value (LAST)
+	Stats mC_stats;		// statistics of numeric values (STATS)
+	std::map<std::string, Stats> mCC_members; // of object members (STATS)
+      };
+
+      void add(Reducer& aCr_reducer, const IO_Type& aCr_value);
+
+      void close(Reducer& aCr_reducer, const PortType& aCr_port);
+
+    private:
+
+      /** reducer of each port */
+      std::unordered_map<PortType, Reducer> mCC_reducers;
+
+      /** receives the reduced output */
+      Sink mC_sink;
+
+      /** time of the latest output value */
+      double md_time;
+
+    };				// class OutputReducer
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_OUTPUTREDUCER_HPP
@@ -0,0 +1,248 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : OutputWriter.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/OutputWriter.hpp>
+
+#include <utility>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * constructor
+     *
+     * @param aCr_out output stream
+     * @param ab_async whether values are written on a background thread
+     * @param ai_capacity maximum number of batches queued
+     */
+    OutputWriter::OutputWriter(std::ostream& aCr_out, bool ab_async,
+			       std::size_t ai_capacity) :
+      mCr_out(aCr_out),
+      mb_async(ab_async),
+      mi_capacity(ai_capacity > 0 ? ai_capacity : 1),
+      mC_blockOut(&mC_block),
+      ml_flushes(0),
+      ml_flushed(0),
+      mb_stop(false),
+      mb_failed(false)
+    {
+      Json::StreamWriterBuilder lC_builder;
+      lC_builder["indentation"] = "";
+      mCp_writer.reset(lC_builder.newStreamWriter());
+      mC1_batch.reserve(BATCH_SIZE);
+
+      if (mb_async)
+	mC_thread = std::thread(&OutputWriter::run, this);
+    }
+
+    /**
+     * destructor (writes out and flushes the remaining output)
+     *
+     * @throws the error of the writer thread not yet raised by flush(),
+     *         unless the stack is being unwound
+     */
+    OutputWriter::~OutputWriter() noexcept(false)
+    {
+      std::exception_ptr lCp_error;
+      try {
+	flush();
+      }
+      catch (...) {
+	lCp_error = std::current_exception();
+      }
+
+      if (mb_async) {
+	{
+	  std::lock_guard<std::mutex> lC_lock(mC_mutex);
+	  mb_stop = true;
+	}
+	mC_ready.notify_one();
+	mC_thread.join();
+      }
+
+      if (lCp_error && !std::uncaught_exception())
+	std::rethrow_exception(lCp_error);
+    }
+
+    /**
+     * Writes a value.
+     *
+     * @param aCr_value JSON value (copied)
+     */
+    void OutputWriter::write(const Json::Value& aCr_value)
+    {
+      write( SharedJson(aCr_value) );
+    }
+
+    /**
+     * Writes a shared document, which is formatted from the handle (without
+     * copying the document).
+     *
+     * @param aCr_value shared JSON document
+     */
+    void OutputWriter::write(const SharedJson& aCr_value)
+    {
+      mC1_batch.push_back(aCr_value);
+      if (mC1_batch.size() < BATCH_SIZE)
+	return;
+
+      if (!mb_async) {
+	format(mC1_batch);
+	mC1_batch.clear();
+	return;
+      }
+
+      std::vector<SharedJson> lC1_batch;
+      lC1_batch.reserve(BATCH_SIZE);
+      lC1_batch.swap(mC1_batch);
+      {
+	std::unique_lock<std::mutex> lC_lock(mC_mutex);
+	mC_space.wait(lC_lock,
+		      [this]() { return mCC_queue.size() < mi_capacity; });
+	mCC_queue.push_back(std::move(lC1_batch));
+      }
+      mC_ready.notify_one();
+    }
+
+    /**
+     * Writes the JSON value of an output event (other values are skipped).
+     *
+     * @param aCr_value output event
+     */
+    void OutputWriter::write(const IO_Type& aCr_value)
+    {
+      if (const SharedJson* lCp_shared =
+	  value_cast<SharedJson>( &aCr_value.value ))
+	write(*lCp_shared);
+      else if (const Json::Value* lCp_value =
+	       value_cast<Json::Value>( &aCr_value.value ))
+	write(*lCp_value);
+    }
+
+    /**
+     * Writes out the values passed so far and flushes the stream, waiting
+     * for the writer thread if need be.
+     *
+     * @throws the error of the writer thread, if any since the last flush
+     */
+    void OutputWriter::flush()
+    {
+      if (!mb_async) {
+	format(mC1_batch);
+	mC1_batch.clear();
+	drain();
+	mCr_out.flush();
+	return;
+      }
+
+      std::unique_lock<std::mutex> lC_lock(mC_mutex);
+      if (!mC1_batch.empty()) {
+	mCC_queue.push_back(std::move(mC1_batch));
+	mC1_batch = std::vector<SharedJson>();
+	mC1_batch.reserve(BATCH_SIZE);
+      }
+      mCC_queue.push_back(std::vector<SharedJson>());
+      unsigned long ll_flush = ++ml_flushes;
+      mC_ready.notify_one();
+      mC_space.wait(lC_lock,
+		    [this, ll_flush]() { return ml_flushed >= ll_flush; });
+
+      if (mCp_error) {
+	std::exception_ptr lCp_error = mCp_error;
+	mCp_error = nullptr;
+	std::rethrow_exception(lCp_error);
+      }
+    }
+
+    /** Formats and writes the queued batches (writer thread). */
+    void OutputWriter::run()
+    {
+      for (;;) {
+	std::vector<SharedJson> lC1_batch;
+	bool lb_failed = false;
+	{
+	  std::unique_lock<std::mutex> lC_lock(mC_mutex);
+	  mC_ready.wait(lC_lock,
+			[this]() { return mb_stop || !mCC_queue.empty(); });
+	  if (mCC_queue.empty())
+	    return;
+	  lC1_batch.swap(mCC_queue.front());
+	  mCC_queue.pop_front();
+	  lb_failed = mb_failed;
+	}
+	mC_space.notify_all();
+
+	// after an error, the batches are dropped (the queue is still
+	// emptied, so that the simulation does not wait on it)
+	std::exception_ptr lCp_error;
+	try {
+	  if (!lC1_batch.empty()) {
+	    if (!lb_failed)
+	      format(lC1_batch);
+	    continue;
+	  }
+
+	  // an empty batch requests a flush
+	  if (!lb_failed) {
+	    drain();
+	    mCr_out.flush();
+	  }
+	}
+	catch (...) {
+	  lCp_error = std::current_exception();
+	}
+
+	{
+	  std::lock_guard<std::mutex> lC_lock(mC_mutex);
+	  if (lCp_error) {
+	    mb_failed = true;
+	    mCp_error = lCp_error;
+	  }
+	  if (lC1_batch.empty())
+	    ml_flushed++;
+	}
+	mC_space.notify_all();
+      }
+    }
+
+    /**
+     * Formats a batch of values, writing the output to the stream by
+     * blocks.
+     *
+     * @param aCr_batch batch of values
+     */
+    void OutputWriter::format(const std::vector<SharedJson>& aCr_batch)
+    {
+      for (const auto& i : aCr_batch) {
+	mCp_writer->write(i.get(), &mC_blockOut);
+	mC_blockOut.put('\n');
+      }
+
+      if (mC_block.size() >= BLOCK_SIZE)
+	drain();
+    }
+
+    /** Writes the formatted output to the stream. */
+    void OutputWriter::drain()
+    {
+      if (mC_block.size() > 0)
+	mCr_out.write(mC_block.data(), mC_block.size());
+      mC_block.reset();
+    }
+
+  } // namespace impl
+
+} // namespace efscape
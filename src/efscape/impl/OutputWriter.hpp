@@ -0,0 +1,146 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : OutputWriter.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_OUTPUTWRITER_HPP
+#define EFSCAPE_IMPL_OUTPUTWRITER_HPP
+
+#include <efscape/impl/efscapelib.hpp>
+#include <efscape/utils/MemoryBuffer.hpp>
+
+#include <json/json.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Writes simulation output values to a stream as newline-delimited JSON
+     * (one compact value per line). Output is formatted into a large buffer
+     * that is written to the stream in blocks, and the stream is only
+     * flushed by flush().
+     *
+     * With asynchronous writing, values are handed over in batches, through
+     * a bounded queue, to a background thread that formats and writes them,
+     * so that the simulation only pays for a handle to each shared document
+     * (SharedJson), or for a copy of any other value. The simulation waits
+     * if the queue is full. Values are written in the order in which they
+     * were passed, from a single thread. An error of the background thread
+     * is raised by the next flush() (or by the destructor), and the values
+     * passed after it are dropped.
+     */
+    class OutputWriter
+    {
+    public:
+
+      OutputWriter(std::ostream& aCr_out, bool ab_async = true,
+		   std::size_t ai_capacity = 64);
+
+      ~OutputWriter() noexcept(false);
+
+      void write(const Json::Value& aCr_value);
+
+      void write(const SharedJson& aCr_value);
+
+      void write(const IO_Type& aCr_value);
+
+      void flush();
+
+      /** @returns whether values are written on a background thread */
+      bool isAsync() const { return mb_async; }
+
+      /** number of values handed over at once */
+      static const std::size_t BATCH_SIZE = 256;
+
+      /** size of the output written to the stream at once */
+      static const std::size_t BLOCK_SIZE = 1 << 20;
+
+    protected:
+
+      void run();
+
+      void format(const std::vector<SharedJson>& aCr_batch);
+
+      void drain();
+
+    private:
+
+      /** output stream */
+      std::ostream& mCr_out;
+
+      /** whether values are written on a background thread */
+      bool mb_async;
+
+      /** maximum number of batches queued */
+      std::size_t mi_capacity;
+
+      /** compact JSON writer */
+      std::unique_ptr<Json::StreamWriter> mCp_writer;
+
+      /** formatted output not yet written to the stream */
+      efscape::utils::MemoryBuffer mC_block;
+
+      /** stream over the formatted output */
+      std::ostream mC_blockOut;
+
+      /** values not yet handed over */
+      std::vector<SharedJson> mC1_batch;
+
+      /** batches handed over (an empty batch requests a flush) */
+      std::deque< std::vector<SharedJson> > mCC_queue;
+
+      /** guards the queue */
+      std::mutex mC_mutex;
+
+      /** signals a batch to the writer thread */
+      std::condition_variable mC_ready;
+
+      /** signals space in the queue or a completed flush */
+      std::condition_variable mC_space;
+
+      /** number of flushes requested */
+      unsigned long ml_flushes;
+
+      /** number of flushes completed */
+      unsigned long ml_flushed;
+
+      /** whether the writer thread should stop */
+      bool mb_stop;
+
+      /** whether the writer thread has failed */
+      bool mb_failed;
+
+      /** error of the writer thread not yet raised */
+      std::exception_ptr mCp_error;
+
+      /** writer thread */
+      std::thread mC_thread;
+
+    };				// class OutputWriter
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_OUTPUTWRITER_HPP
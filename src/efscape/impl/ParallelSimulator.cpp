@@ -0,0 +1,259 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : ParallelSimulator.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/ParallelSimulator.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace efscape {
+
+  namespace impl {
+
+    ParallelSimulator::ParallelSimulator(DEVS* aCp_model,
+					 unsigned int ai_threads) :
+      mC_pool(ai_threads),
+      md_time(0.)
+    {
+      AtomicIndex lC_index(aCp_model);
+      mC1_atomics = lC_index.atomics();
+
+      std::size_t ll_size = mC1_atomics.size();
+      mC1_tL.assign(ll_size, 0.);
+      mC1_tN.assign(ll_size, adevs_inf<double>());
+      mC1_input.resize(ll_size);
+      mC1_output.resize(ll_size);
+      mC1_active.assign(ll_size, INACTIVE);
+
+      mC_outputTask =
+	std::bind(&ParallelSimulator::computeOutput, this,
+		  std::placeholders::_1);
+      mC_transitionTask =
+	std::bind(&ParallelSimulator::computeTransition, this,
+		  std::placeholders::_1);
+
+      // initialize the schedule, as adevs::Simulator does: tN = 0 + ta()
+      for (std::size_t i = 0; i < ll_size; i++) {
+	mCC_indices[ mC1_atomics[i] ] = i;
+	double ld_ta = mC1_atomics[i]->ta();
+	if (ld_ta < adevs_inf<double>())
+	  mC1_tN[i] = ld_ta;
+	schedule(i);
+      }
+    }
+
+    ParallelSimulator::~ParallelSimulator() {}
+
+    double ParallelSimulator::nextEventTime()
+    {
+      // discard stale entries
+      while (!mC_schedule.empty()) {
+	const Entry& lCr_top = mC_schedule.top();
+	if (mC1_tN[lCr_top.index] == lCr_top.tN)
+	  return lCr_top.tN;
+	mC_schedule.pop();
+      }
+      return adevs_inf<double>();
+    }
+
+    void ParallelSimulator::execNextEvent()
+    {
+      double ld_time = nextEventTime();
+      if (ld_time >= adevs_inf<double>())
+	return;
+      md_time = ld_time;
+
+      //------------------------------------------------------------------
+      // 1. collect the imminent models (the heap yields them in index
+      //    order; duplicate entries are skipped)
+      //------------------------------------------------------------------
+      while (!mC_schedule.empty() && mC_schedule.top().tN == md_time) {
+	std::size_t i = mC_schedule.top().index;
+	mC_schedule.pop();
+	if (mC1_tN[i] == md_time && mC1_active[i] == INACTIVE) {
+	  mC1_active[i] = IMMINENT;
+	  mC1_imminent.push_back(i);
+	  mC1_activated.push_back(i);
+	}
+      }
+
+      //------------------------------------------------------------------
+      // 2. compute output in parallel
+      //------------------------------------------------------------------
+      mC_pool.parallel_for(mC1_imminent.size(), mC_outputTask);
+
+      //------------------------------------------------------------------
+      // 3. route output in model order
+      //------------------------------------------------------------------
+      for (std::size_t k = 0; k < mC1_imminent.size(); k++) {
+	std::size_t i = mC1_imminent[k];
+	ATOMIC* lCp_atomic = mC1_atomics[i];
+	adevs::Bag<IO_Type>& lCr_output = mC1_output[i];
+	for (adevs::Bag<IO_Type>::iterator iter = lCr_output.begin();
+	     iter != lCr_output.end(); iter++) {
+	  route(lCp_atomic->getParent(), lCp_atomic, *iter, 0);
+	}
+      }
+
+      //------------------------------------------------------------------
+      // 4. compute state transitions in parallel
+      //------------------------------------------------------------------
+      std::sort(mC1_activated.begin(), mC1_activated.end());
+      mC_pool.parallel_for(mC1_activated.size(), mC_transitionTask);
+
+      //------------------------------------------------------------------
+      // 5. clean up, notify listeners and reschedule
+      //------------------------------------------------------------------
+      for (std::size_t k = 0; k < mC1_imminent.size(); k++) {
+	std::size_t i = mC1_imminent[k];
+	mC1_atomics[i]->gc_output(mC1_output[i]);
+	mC1_output[i].clear();
+      }
+
+      for (std::size_t k = 0; k < mC1_activated.size(); k++) {
+	std::size_t i = mC1_activated[k];
+	mC1_input[i].clear();
+	mC1_active[i] = INACTIVE;
+	for (std::size_t l = 0; l < mC1_listeners.size(); l++)
+	  mC1_listeners[l]->stateChange(mC1_atomics[i], md_time);
+	schedule(i);
+      }
+
+      mC1_imminent.clear();
+      mC1_activated.clear();
+
+      // drop stale entries once they outnumber the live ones
+      if (mC_schedule.size() > 2*mC1_atomics.size() + 64) {
+	std::priority_queue< Entry, std::vector<Entry>, std::greater<Entry> >
+	  lC_schedule;
+	mC_schedule.swap(lC_schedule);
+	for (std::size_t i = 0; i < mC1_atomics.size(); i++)
+	  schedule(i);
+      }
+    }
+
+    void ParallelSimulator::execUntil(double ad_tEnd)
+    {
+      while (nextEventTime() <= ad_tEnd &&
+	     nextEventTime() < adevs_inf<double>())
+	execNextEvent();
+    }
+
+    void ParallelSimulator::addEventListener(adevs::EventListener<IO_Type>*
+					     aCp_listener)
+    {
+      mC1_listeners.push_back(aCp_listener);
+    }
+
+    void ParallelSimulator::removeEventListener(adevs::EventListener<IO_Type>*
+						aCp_listener)
+    {
+      mC1_listeners.erase(std::remove(mC1_listeners.begin(),
+				      mC1_listeners.end(),
+				      aCp_listener),
+			  mC1_listeners.end());
+    }
+
+    void ParallelSimulator::schedule(std::size_t ai_index)
+    {
+      if (mC1_tN[ai_index] < adevs_inf<double>()) {
+	Entry lC_entry = { mC1_tN[ai_index], ai_index };
+	mC_schedule.push(lC_entry);
+      }
+    }
+
+    void ParallelSimulator::route(NETWORK* aCp_parent, DEVS* aCp_src,
+				  const IO_Type& aCr_value,
+				  std::size_t ai_depth)
+    {
+      // mirrors adevs::Simulator::route: output of a model (as opposed to
+      // input to a network) is reported to the listeners
+      if (aCp_parent != aCp_src) {
+	adevs::Event<IO_Type> lC_event(aCp_src, aCr_value);
+	for (std::size_t l = 0; l < mC1_listeners.size(); l++)
+	  mC1_listeners[l]->outputEvent(lC_event, md_time);
+      }
+      if (aCp_parent == NULL)
+	return;
+
+      if (mCC_receivers.size() <= ai_depth)
+	mCC_receivers.resize(ai_depth + 1);
+      adevs::Bag< adevs::Event<IO_Type> >& lCr_receivers =
+	mCC_receivers[ai_depth];
+      lCr_receivers.clear();
+
+      aCp_parent->route(aCr_value, aCp_src, lCr_receivers);
+
+      for (adevs::Bag< adevs::Event<IO_Type> >::iterator iter =
+	     lCr_receivers.begin(); iter != lCr_receivers.end(); iter++) {
+	DEVS* lCp_model = (*iter).model;
+	ATOMIC* lCp_atomic = lCp_model->typeIsAtomic();
+	if (lCp_atomic != NULL)
+	  deliver(lCp_atomic, (*iter).value);
+	else if (lCp_model == aCp_parent) // output of the network
+	  route(aCp_parent->getParent(), aCp_parent, (*iter).value,
+		ai_depth + 1);
+	else			// input to a component network
+	  route(lCp_model->typeIsNetwork(), lCp_model, (*iter).value,
+		ai_depth + 1);
+      }
+    }
+
+    void ParallelSimulator::deliver(ATOMIC* aCp_atomic,
+				    const IO_Type& aCr_value)
+    {
+      std::unordered_map<const DEVS*, std::size_t>::const_iterator iter =
+	mCC_indices.find(aCp_atomic);
+      if (iter == mCC_indices.end())
+	throw std::logic_error("ParallelSimulator: event routed to a model "
+			       "that is not part of the simulated hierarchy");
+
+      std::size_t i = iter->second;
+      if (mC1_active[i] == INACTIVE) {
+	mC1_active[i] = RECEIVER;
+	mC1_activated.push_back(i);
+      }
+      mC1_input[i].insert(aCr_value);
+    }
+
+    void ParallelSimulator::computeOutput(std::size_t ai_k)
+    {
+      std::size_t i = mC1_imminent[ai_k];
+      mC1_atomics[i]->output_func(mC1_output[i]);
+    }
+
+    void ParallelSimulator::computeTransition(std::size_t ai_k)
+    {
+      std::size_t i = mC1_activated[ai_k];
+      ATOMIC* lCp_atomic = mC1_atomics[i];
+
+      if (mC1_active[i] == IMMINENT) {
+	if (mC1_input[i].empty())
+	  lCp_atomic->delta_int();
+	else
+	  lCp_atomic->delta_conf(mC1_input[i]);
+      }
+      else
+	lCp_atomic->delta_ext(md_time - mC1_tL[i], mC1_input[i]);
+
+      mC1_tL[i] = md_time;
+      double ld_ta = lCp_atomic->ta();
+      mC1_tN[i] = (ld_ta < adevs_inf<double>() ? md_time + ld_ta :
+		   adevs_inf<double>());
+    }
+
+  } // namespace impl
+
+} // namespace efscape
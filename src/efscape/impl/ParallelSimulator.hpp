@@ -0,0 +1,187 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : ParallelSimulator.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_PARALLELSIMULATOR_HPP
+#define EFSCAPE_IMPL_PARALLELSIMULATOR_HPP
+
+#include <efscape/impl/efscapelib.hpp>
+#include <efscape/impl/AtomicIndex.hpp>
+#include <efscape/utils/ThreadPool.hpp>
+
+#include <deque>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Implements a multi-threaded Parallel DEVS simulator for a model
+     * hierarchy. It can be used in place of adevs::Simulator<IO_Type>. At
+     * each event time, the output functions of all the imminent atomic
+     * models are computed in parallel. Their output is then routed through
+     * the networks on the calling thread. Finally the state transitions
+     * (delta_int, delta_ext or delta_conf) and time advances of all the
+     * active models are computed in parallel.
+     *
+     * Results do not depend on the number of threads. Each model writes its
+     * output to its own bag, and output is routed in a fixed model order,
+     * so every input bag is filled in the same order on every run. Event
+     * listeners are notified on the calling thread.
+     *
+     * Requirements on the model:
+     * - atomic models that are active at the same time must not share
+     *   mutable state (e.g. models built on the Repast HPC process
+     *   singleton must use adevs::Simulator);
+     * - the model structure must be fixed (there is no support for
+     *   model_transition()); and
+     * - atomic models must not depend on the bookkeeping kept by
+     *   adevs::Simulator (e.g. SimRunner, which should be unwrapped first).
+     */
+    class ParallelSimulator
+    {
+    public:
+
+      /**
+       * constructor
+       *
+       * @param aCp_model handle to root model
+       * @param ai_threads number of threads (0 for the number of hardware
+       *                   threads)
+       */
+      ParallelSimulator(DEVS* aCp_model, unsigned int ai_threads = 0);
+
+      /** destructor */
+      ~ParallelSimulator();
+
+      /** @returns time of the next event (adevs_inf if none) */
+      double nextEventTime();
+
+      /** Executes the next event. */
+      void execNextEvent();
+
+      /**
+       * Executes events until the next event time is greater than the
+       * specified time.
+       *
+       * @param ad_tEnd end time
+       */
+      void execUntil(double ad_tEnd);
+
+      /**
+       * Adds an event listener, notified of every output event and state
+       * change.
+       *
+       * @param aCp_listener handle to listener
+       */
+      void addEventListener(adevs::EventListener<IO_Type>* aCp_listener);
+
+      /**
+       * Removes an event listener.
+       *
+       * @param aCp_listener handle to listener
+       */
+      void removeEventListener(adevs::EventListener<IO_Type>* aCp_listener);
+
+      /** @returns number of atomic models */
+      std::size_t numAtomics() const { return mC1_atomics.size(); }
+
+      /** @returns number of threads */
+      unsigned int numThreads() const { return mC_pool.size(); }
+
+    protected:
+
+      /** an entry in the schedule */
+      struct Entry {
+	double tN;
+	std::size_t index;
+	bool operator>(const Entry& aCr_entry) const {
+	  return (tN > aCr_entry.tN ||
+		  (tN == aCr_entry.tN && index > aCr_entry.index));
+	}
+      };
+
+      /** activity flags */
+      enum { INACTIVE = 0, IMMINENT = 1, RECEIVER = 2 };
+
+      void schedule(std::size_t ai_index);
+      void route(NETWORK* aCp_parent, DEVS* aCp_src, const IO_Type& aCr_value,
+		 std::size_t ai_depth);
+      void deliver(ATOMIC* aCp_atomic, const IO_Type& aCr_value);
+      void computeOutput(std::size_t ai_k);
+      void computeTransition(std::size_t ai_k);
+
+    private:
+
+      ParallelSimulator(const ParallelSimulator&);
+      ParallelSimulator& operator=(const ParallelSimulator&);
+
+      /** atomic models, in traversal order */
+      std::vector<ATOMIC*> mC1_atomics;
+
+      /** maps atomic models to their index */
+      std::unordered_map<const DEVS*, std::size_t> mCC_indices;
+
+      /** time of last event of each atomic model */
+      std::vector<double> mC1_tL;
+
+      /** time of next event of each atomic model */
+      std::vector<double> mC1_tN;
+
+      /** input bag of each atomic model */
+      std::vector< adevs::Bag<IO_Type> > mC1_input;
+
+      /** output bag of each atomic model */
+      std::vector< adevs::Bag<IO_Type> > mC1_output;
+
+      /** activity flag of each atomic model for the current event */
+      std::vector<char> mC1_active;
+
+      /** imminent models at the current event (in index order) */
+      std::vector<std::size_t> mC1_imminent;
+
+      /** active (imminent or receiving) models at the current event */
+      std::vector<std::size_t> mC1_activated;
+
+      /** schedule: min-heap of next event times (may hold stale entries) */
+      std::priority_queue< Entry, std::vector<Entry>, std::greater<Entry> >
+      mC_schedule;
+
+      /** receiver bags, one per routing depth (deque: stable references) */
+      std::deque< adevs::Bag< adevs::Event<IO_Type> > > mCC_receivers;
+
+      /** event listeners */
+      std::vector< adevs::EventListener<IO_Type>* > mC1_listeners;
+
+      /** loop bodies handed to the thread pool */
+      std::function<void(std::size_t)> mC_outputTask;
+      std::function<void(std::size_t)> mC_transitionTask;
+
+      /** thread pool */
+      efscape::utils::ThreadPool mC_pool;
+
+      /** current time */
+      double md_time;
+
+    };				// class ParallelSimulator
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_PARALLELSIMULATOR_HPP
@@ -0,0 +1,633 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : PartitionedSimulator.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/PartitionedSimulator.hpp>
+
+#include <efscape/impl/AtomicIndex.hpp>
+#include <efscape/impl/ModelPartition.hpp>
+#include <efscape/impl/ModelHomeI.hpp>
+#include <efscape/impl/ModelHomeSingleton.hpp>
+#include <efscape/utils/type.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+
+namespace efscape {
+
+  namespace impl {
+
+    namespace {
+
+      /** an event sent from one partition to another */
+      struct Message {
+	double t;
+	unsigned long seq;
+	DEVS* model;
+	IO_Type value;
+	bool operator>(const Message& aCr_message) const {
+	  return (t > aCr_message.t ||
+		  (t == aCr_message.t && seq > aCr_message.seq));
+	}
+      };
+
+      /** an entry in the schedule of a partition */
+      struct Entry {
+	double tN;
+	std::size_t index;
+	bool operator>(const Entry& aCr_entry) const {
+	  return (tN > aCr_entry.tN ||
+		  (tN == aCr_entry.tN && index > aCr_entry.index));
+	}
+      };
+
+      /** an output event, logged for the listeners */
+      struct Output {
+	double t;
+	adevs::Event<IO_Type> event;
+	bool operator<(const Output& aCr_output) const {
+	  return t < aCr_output.t;
+	}
+      };
+
+      // returns the lookahead declared for a model, first for the instance
+      // and then for its type
+      double declared_lookahead(DEVS* aCp_model,
+				const LookaheadMap* aCp_lookaheads)
+      {
+	if (aCp_lookaheads != NULL) {
+	  LookaheadMap::const_iterator iter = aCp_lookaheads->find(aCp_model);
+	  if (iter != aCp_lookaheads->end())
+	    return iter->second;
+	}
+
+	std::string lC_typeName = efscape::utils::type<DEVS>(*aCp_model);
+	Json::Value lC_properties =
+	  Singleton<ModelHomeI>::Instance().getModelFactory().
+	  getProperties(lC_typeName.c_str());
+	Json::Value lC_lookahead = lC_properties.get("lookahead",
+						     Json::Value());
+	return (lC_lookahead.isNumeric() ? lC_lookahead.asDouble() : 0.);
+      }
+
+    } // namespace
+
+    /**
+     * A partition of the model: a set of components of the root network,
+     * simulated with their own event list.
+     */
+    class PartitionedSimulator::Partition
+    {
+    public:
+
+      Partition(std::size_t ai_id, NETWORK* aCp_root,
+		const PartitionMap& aCr_owners,
+		std::size_t ai_partitions) :
+	mi_id(ai_id),
+	mCp_root(aCp_root),
+	mCr_owners(aCr_owners),
+	mC1_outboxes(ai_partitions),
+	md_lookahead(adevs_inf<double>()),
+	md_time(0.),
+	ml_seq(0)
+      {}
+
+      /** adds a component of the root network */
+      void add(DEVS* aCp_component, double ad_lookahead)
+      {
+	AtomicIndex lC_index(aCp_component);
+	const std::vector<ATOMIC*>& lC1_atomics = lC_index.atomics();
+	for (std::size_t k = 0; k < lC1_atomics.size(); k++) {
+	  std::size_t i = mC1_atomics.size();
+	  mC1_atomics.push_back(lC1_atomics[k]);
+	  mCC_indices[ lC1_atomics[k] ] = i;
+	}
+	md_lookahead = std::min(md_lookahead, ad_lookahead);
+      }
+
+      /** initializes the schedule, as adevs::Simulator does */
+      void initialize()
+      {
+	std::size_t ll_size = mC1_atomics.size();
+	mC1_tL.assign(ll_size, 0.);
+	mC1_tN.assign(ll_size, adevs_inf<double>());
+	mC1_input.resize(ll_size);
+	mC1_output.resize(ll_size);
+	mC1_active.assign(ll_size, INACTIVE);
+	for (std::size_t i = 0; i < ll_size; i++) {
+	  double ld_ta = mC1_atomics[i]->ta();
+	  if (ld_ta < adevs_inf<double>())
+	    mC1_tN[i] = ld_ta;
+	  schedule(i);
+	}
+	if (md_lookahead >= adevs_inf<double>())
+	  md_lookahead = 0.;
+      }
+
+      /** @returns time of the next internal event */
+      double nextInternalTime()
+      {
+	// discard stale entries
+	while (!mC_schedule.empty()) {
+	  const Entry& lCr_top = mC_schedule.top();
+	  if (mC1_tN[lCr_top.index] == lCr_top.tN)
+	    return lCr_top.tN;
+	  mC_schedule.pop();
+	}
+	return adevs_inf<double>();
+      }
+
+      /** @returns time of the earliest undelivered input */
+      double nextInputTime() const {
+	return (mC_inbox.empty() ? adevs_inf<double>() : mC_inbox.top().t);
+      }
+
+      /** @returns time of the next event */
+      double nextTime() {
+	return std::min(nextInternalTime(), nextInputTime());
+      }
+
+      /**
+       * Executes the events of this partition that come before the bound.
+       *
+       * @param ad_bound bound
+       */
+      void runUntil(double ad_bound)
+      {
+	double ld_time;
+	while ( (ld_time = nextTime()) < ad_bound ) {
+	  beginStep(ld_time);
+	  endStep(ld_time);
+	}
+      }
+
+      /**
+       * Computes and routes the output of the imminent models.
+       *
+       * @param ad_time current time
+       */
+      void beginStep(double ad_time)
+      {
+	md_time = ad_time;
+
+	while (!mC_schedule.empty() && mC_schedule.top().tN == md_time) {
+	  std::size_t i = mC_schedule.top().index;
+	  mC_schedule.pop();
+	  if (mC1_tN[i] == md_time && mC1_active[i] == INACTIVE) {
+	    mC1_active[i] = IMMINENT;
+	    mC1_imminent.push_back(i);
+	    mC1_activated.push_back(i);
+	  }
+	}
+
+	for (std::size_t k = 0; k < mC1_imminent.size(); k++) {
+	  std::size_t i = mC1_imminent[k];
+	  mC1_atomics[i]->output_func(mC1_output[i]);
+	}
+
+	for (std::size_t k = 0; k < mC1_imminent.size(); k++) {
+	  std::size_t i = mC1_imminent[k];
+	  ATOMIC* lCp_atomic = mC1_atomics[i];
+	  adevs::Bag<IO_Type>& lCr_output = mC1_output[i];
+	  for (adevs::Bag<IO_Type>::iterator iter = lCr_output.begin();
+	       iter != lCr_output.end(); iter++)
+	    route(lCp_atomic->getParent(), lCp_atomic, *iter, 0);
+	}
+      }
+
+      /**
+       * Delivers the input from other partitions and computes the state
+       * transitions of the active models.
+       *
+       * @param ad_time current time
+       */
+      void endStep(double ad_time)
+      {
+	md_time = ad_time;
+
+	while (!mC_inbox.empty() && mC_inbox.top().t == md_time) {
+	  const Message& lCr_message = mC_inbox.top();
+	  ATOMIC* lCp_atomic = lCr_message.model->typeIsAtomic();
+	  if (lCp_atomic != NULL)
+	    deliver(lCp_atomic, lCr_message.value);
+	  else			// input to a component network
+	    route(lCr_message.model->typeIsNetwork(), lCr_message.model,
+		  lCr_message.value, 0);
+	  mC_inbox.pop();
+	}
+
+	std::sort(mC1_activated.begin(), mC1_activated.end());
+	for (std::size_t k = 0; k < mC1_activated.size(); k++) {
+	  std::size_t i = mC1_activated[k];
+	  ATOMIC* lCp_atomic = mC1_atomics[i];
+
+	  if (mC1_active[i] == IMMINENT) {
+	    if (mC1_input[i].empty())
+	      lCp_atomic->delta_int();
+	    else
+	      lCp_atomic->delta_conf(mC1_input[i]);
+	  }
+	  else
+	    lCp_atomic->delta_ext(md_time - mC1_tL[i], mC1_input[i]);
+
+	  mC1_tL[i] = md_time;
+	  double ld_ta = lCp_atomic->ta();
+	  mC1_tN[i] = (ld_ta < adevs_inf<double>() ? md_time + ld_ta :
+		       adevs_inf<double>());
+	}
+
+	for (std::size_t k = 0; k < mC1_imminent.size(); k++) {
+	  std::size_t i = mC1_imminent[k];
+	  mC1_atomics[i]->gc_output(mC1_output[i]);
+	  mC1_output[i].clear();
+	}
+
+	for (std::size_t k = 0; k < mC1_activated.size(); k++) {
+	  std::size_t i = mC1_activated[k];
+	  mC1_input[i].clear();
+	  mC1_active[i] = INACTIVE;
+	  schedule(i);
+	}
+
+	mC1_imminent.clear();
+	mC1_activated.clear();
+
+	// drop stale entries once they outnumber the live ones
+	if (mC_schedule.size() > 2*mC1_atomics.size() + 64) {
+	  std::priority_queue< Entry, std::vector<Entry>,
+			       std::greater<Entry> > lC_schedule;
+	  mC_schedule.swap(lC_schedule);
+	  for (std::size_t i = 0; i < mC1_atomics.size(); i++)
+	    schedule(i);
+	}
+      }
+
+      /**
+       * Moves the messages sent to another partition into its inbox.
+       *
+       * @param aCr_target receiving partition
+       */
+      void send(Partition& aCr_target)
+      {
+	std::vector<Message>& lCr_outbox = mC1_outboxes[aCr_target.mi_id];
+	for (std::size_t k = 0; k < lCr_outbox.size(); k++) {
+	  lCr_outbox[k].seq = aCr_target.ml_seq++;
+	  aCr_target.mC_inbox.push(lCr_outbox[k]);
+	}
+	lCr_outbox.clear();
+      }
+
+      /** @returns output logged since the last flush */
+      std::vector<Output>& log() { return mC1_log; }
+
+      /** @returns lookahead */
+      double lookahead() const { return md_lookahead; }
+
+      /** @returns number of atomic models */
+      std::size_t size() const { return mC1_atomics.size(); }
+
+    private:
+
+      /** activity flags */
+      enum { INACTIVE = 0, IMMINENT = 1, RECEIVER = 2 };
+
+      void schedule(std::size_t ai_index)
+      {
+	if (mC1_tN[ai_index] < adevs_inf<double>()) {
+	  Entry lC_entry = { mC1_tN[ai_index], ai_index };
+	  mC_schedule.push(lC_entry);
+	}
+      }
+
+      void route(NETWORK* aCp_parent, DEVS* aCp_src, const IO_Type& aCr_value,
+		 std::size_t ai_depth)
+      {
+	// mirrors adevs::Simulator::route (see ParallelSimulator::route)
+	if (aCp_parent != aCp_src) {
+	  Output lC_output = { md_time,
+			       adevs::Event<IO_Type>(aCp_src, aCr_value) };
+	  mC1_log.push_back(lC_output);
+	}
+	if (aCp_parent == NULL)
+	  return;
+
+	if (mCC_receivers.size() <= ai_depth)
+	  mCC_receivers.resize(ai_depth + 1);
+	adevs::Bag< adevs::Event<IO_Type> >& lCr_receivers =
+	  mCC_receivers[ai_depth];
+	lCr_receivers.clear();
+
+	aCp_parent->route(aCr_value, aCp_src, lCr_receivers);
+
+	for (adevs::Bag< adevs::Event<IO_Type> >::iterator iter =
+	       lCr_receivers.begin(); iter != lCr_receivers.end(); iter++) {
+	  DEVS* lCp_model = (*iter).model;
+	  if (lCp_model == aCp_parent) { // output of the network
+	    route(aCp_parent->getParent(), aCp_parent, (*iter).value,
+		  ai_depth + 1);
+	    continue;
+	  }
+
+	  // input to a component of the root owned by another partition
+	  if (aCp_parent == mCp_root) {
+	    PartitionMap::const_iterator lC_owner = mCr_owners.find(lCp_model);
+	    if (lC_owner == mCr_owners.end())
+	      throw std::logic_error("PartitionedSimulator: event routed to a "
+				     "model that is not part of the "
+				     "simulated hierarchy");
+	    if (lC_owner->second != mi_id) {
+	      Message lC_message = { md_time, 0, lCp_model, (*iter).value };
+	      mC1_outboxes[lC_owner->second].push_back(lC_message);
+	      continue;
+	    }
+	  }
+
+	  ATOMIC* lCp_atomic = lCp_model->typeIsAtomic();
+	  if (lCp_atomic != NULL)
+	    deliver(lCp_atomic, (*iter).value);
+	  else			// input to a component network
+	    route(lCp_model->typeIsNetwork(), lCp_model, (*iter).value,
+		  ai_depth + 1);
+	}
+      }
+
+      void deliver(ATOMIC* aCp_atomic, const IO_Type& aCr_value)
+      {
+	std::unordered_map<const DEVS*, std::size_t>::const_iterator iter =
+	  mCC_indices.find(aCp_atomic);
+	if (iter == mCC_indices.end())
+	  throw std::logic_error("PartitionedSimulator: event routed to a "
+				 "model that is not part of the partition");
+
+	std::size_t i = iter->second;
+	if (mC1_active[i] == INACTIVE) {
+	  mC1_active[i] = RECEIVER;
+	  mC1_activated.push_back(i);
+	}
+	mC1_input[i].insert(aCr_value);
+      }
+
+      /** partition index */
+      std::size_t mi_id;
+
+      /** root network */
+      NETWORK* mCp_root;
+
+      /** partition that owns each model under the root */
+      const PartitionMap& mCr_owners;
+
+      /** atomic models, and the index of each */
+      std::vector<ATOMIC*> mC1_atomics;
+      std::unordered_map<const DEVS*, std::size_t> mCC_indices;
+
+      /** time of last and next event of each atomic model */
+      std::vector<double> mC1_tL;
+      std::vector<double> mC1_tN;
+
+      /** input and output bags of each atomic model */
+      std::vector< adevs::Bag<IO_Type> > mC1_input;
+      std::vector< adevs::Bag<IO_Type> > mC1_output;
+
+      /** activity flag of each atomic model for the current step */
+      std::vector<char> mC1_active;
+
+      /** imminent and active models at the current step */
+      std::vector<std::size_t> mC1_imminent;
+      std::vector<std::size_t> mC1_activated;
+
+      /** schedule: min-heap of next event times (may hold stale entries) */
+      std::priority_queue< Entry, std::vector<Entry>, std::greater<Entry> >
+      mC_schedule;
+
+      /** input from other partitions, in (time, arrival) order */
+      std::priority_queue< Message, std::vector<Message>,
+			   std::greater<Message> > mC_inbox;
+
+      /** output for other partitions, by receiving partition */
+      std::vector< std::vector<Message> > mC1_outboxes;
+
+      /** receiver bags, one per routing depth (deque: stable references) */
+      std::deque< adevs::Bag< adevs::Event<IO_Type> > > mCC_receivers;
+
+      /** output events since the last flush */
+      std::vector<Output> mC1_log;
+
+      /** minimum lookahead of the components */
+      double md_lookahead;
+
+      /** current time */
+      double md_time;
+
+      /** arrival counter for the inbox */
+      unsigned long ml_seq;
+
+    };				// class PartitionedSimulator::Partition
+
+    PartitionedSimulator::PartitionedSimulator(DEVS* aCp_model,
+					       unsigned int ai_partitions,
+					       const LookaheadMap*
+					       aCp_lookaheads) :
+      md_timeEnd(adevs_inf<double>()),
+      ml_windows(0),
+      ml_steps(0)
+    {
+      // the components of the root network are partitioned
+      std::vector< std::vector<DEVS*> > lCC_components;
+      std::size_t ll_partitions =
+	partitionModel(aCp_model, ai_partitions, lCC_components, mCC_owners);
+
+      NETWORK* lCp_root = aCp_model->typeIsNetwork();
+      for (std::size_t p = 0; p < ll_partitions; p++) {
+	mC1_partitions.push_back(std::unique_ptr<Partition>
+				 (new Partition(p, lCp_root, mCC_owners,
+						ll_partitions)));
+	for (std::size_t c = 0; c < lCC_components[p].size(); c++)
+	  mC1_partitions[p]->add(lCC_components[p][c],
+				 declared_lookahead(lCC_components[p][c],
+						    aCp_lookaheads));
+      }
+
+      for (std::size_t p = 0; p < ll_partitions; p++) {
+	mC1_partitions[p]->initialize();
+	LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+		      "Partition " << p << ": "
+		      << mC1_partitions[p]->size() << " atomic models, "
+		      << "lookahead = " << mC1_partitions[p]->lookahead());
+      }
+
+      mCp_pool.reset(new efscape::utils::ThreadPool(ll_partitions));
+    }
+
+    PartitionedSimulator::~PartitionedSimulator() {}
+
+    double PartitionedSimulator::nextEventTime()
+    {
+      double ld_time = adevs_inf<double>();
+      for (std::size_t p = 0; p < mC1_partitions.size(); p++)
+	ld_time = std::min(ld_time, mC1_partitions[p]->nextTime());
+      return ld_time;
+    }
+
+    void PartitionedSimulator::execNextEvent()
+    {
+      round(md_timeEnd);
+    }
+
+    void PartitionedSimulator::execUntil(double ad_tEnd)
+    {
+      // events at ad_tEnd are executed
+      double ld_limit = std::min(md_timeEnd,
+				 std::nextafter(ad_tEnd, adevs_inf<double>()));
+      while (nextEventTime() < ld_limit)
+	round(ld_limit);
+    }
+
+    void PartitionedSimulator::addEventListener(adevs::EventListener<IO_Type>*
+						aCp_listener)
+    {
+      mC1_listeners.push_back(aCp_listener);
+    }
+
+    double PartitionedSimulator::lookahead(std::size_t ai_partition) const
+    {
+      return mC1_partitions.at(ai_partition)->lookahead();
+    }
+
+    void PartitionedSimulator::round(double ad_limit)
+    {
+      std::size_t ll_partitions = mC1_partitions.size();
+
+      std::vector<double> lC1_next(ll_partitions);
+      double ld_time = adevs_inf<double>();
+      for (std::size_t p = 0; p < ll_partitions; p++) {
+	lC1_next[p] = mC1_partitions[p]->nextTime();
+	ld_time = std::min(ld_time, lC1_next[p]);
+      }
+      if (ld_time >= ad_limit || ld_time >= adevs_inf<double>())
+	return;
+
+      //------------------------------------------------------------------
+      // 1. earliest output time of each partition: the next internal event
+      //    or the earliest input plus the lookahead. No input can come
+      //    before the current time, so start from that and iterate; every
+      //    iterate is a safe lower bound.
+      //------------------------------------------------------------------
+      std::vector<double> lC1_eot(ll_partitions);
+      for (std::size_t p = 0; p < ll_partitions; p++)
+	lC1_eot[p] = std::min(mC1_partitions[p]->nextInternalTime(),
+			      ld_time + mC1_partitions[p]->lookahead());
+
+      std::vector<double> lC1_bound(ll_partitions);
+      for (std::size_t k = 0; k <= ll_partitions; k++) {
+	// the two smallest values give the minimum over the other partitions
+	std::size_t ll_first = 0;
+	double ld_first = adevs_inf<double>(), ld_second = adevs_inf<double>();
+	for (std::size_t p = 0; p < ll_partitions; p++) {
+	  if (lC1_eot[p] < ld_first) {
+	    ld_second = ld_first;
+	    ld_first = lC1_eot[p];
+	    ll_first = p;
+	  }
+	  else if (lC1_eot[p] < ld_second)
+	    ld_second = lC1_eot[p];
+	}
+	for (std::size_t p = 0; p < ll_partitions; p++)
+	  lC1_bound[p] = (p == ll_first ? ld_second : ld_first);
+
+	if (k == ll_partitions)
+	  break;
+
+	for (std::size_t p = 0; p < ll_partitions; p++) {
+	  double ld_input = std::min(mC1_partitions[p]->nextInputTime(),
+				     lC1_bound[p]);
+	  lC1_eot[p] = std::min(mC1_partitions[p]->nextInternalTime(),
+				ld_input + mC1_partitions[p]->lookahead());
+	}
+      }
+
+      //------------------------------------------------------------------
+      // 2. if some partition has events before the earliest output of all
+      //    the others, run every partition up to its bound
+      //------------------------------------------------------------------
+      bool lb_window = false;
+      for (std::size_t p = 0; p < ll_partitions; p++) {
+	lC1_bound[p] = std::min(lC1_bound[p], ad_limit);
+	lb_window = lb_window || (lC1_next[p] < lC1_bound[p]);
+      }
+
+      if (lb_window) {
+	std::vector< std::unique_ptr<Partition> >& lCr_partitions =
+	  mC1_partitions;
+	mCp_pool->parallel_for(ll_partitions,
+			       [&lCr_partitions, &lC1_bound](std::size_t p) {
+				 lCr_partitions[p]->runUntil(lC1_bound[p]);
+			       });
+	exchange();
+	ml_windows++;
+      }
+
+      //------------------------------------------------------------------
+      // 3. otherwise, all the partitions take one step together at the
+      //    current time: output and routing, exchange, transitions
+      //------------------------------------------------------------------
+      else {
+	std::vector< std::unique_ptr<Partition> >& lCr_partitions =
+	  mC1_partitions;
+	mCp_pool->parallel_for(ll_partitions,
+			       [&lCr_partitions, ld_time](std::size_t p) {
+				 lCr_partitions[p]->beginStep(ld_time);
+			       });
+	exchange();
+	mCp_pool->parallel_for(ll_partitions,
+			       [&lCr_partitions, ld_time](std::size_t p) {
+				 lCr_partitions[p]->endStep(ld_time);
+			       });
+	ml_steps++;
+      }
+
+      notify();
+    }
+
+    void PartitionedSimulator::exchange()
+    {
+      // in partition order, so that simultaneous input arrives in the same
+      // order on every run
+      for (std::size_t p = 0; p < mC1_partitions.size(); p++)
+	for (std::size_t q = 0; q < mC1_partitions.size(); q++)
+	  if (p != q)
+	    mC1_partitions[p]->send(*mC1_partitions[q]);
+    }
+
+    void PartitionedSimulator::notify()
+    {
+      std::vector<Output> lC1_log;
+      for (std::size_t p = 0; p < mC1_partitions.size(); p++) {
+	std::vector<Output>& lCr_log = mC1_partitions[p]->log();
+	lC1_log.insert(lC1_log.end(), lCr_log.begin(), lCr_log.end());
+	lCr_log.clear();
+      }
+      std::stable_sort(lC1_log.begin(), lC1_log.end());
+
+      for (std::size_t k = 0; k < lC1_log.size(); k++)
+	for (std::size_t l = 0; l < mC1_listeners.size(); l++)
+	  mC1_listeners[l]->outputEvent(lC1_log[k].event, lC1_log[k].t);
+    }
+
+  } // namespace impl
+
+} // namespace efscape
@@ -0,0 +1,167 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : PartitionedSimulator.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_PARTITIONEDSIMULATOR_HPP
+#define EFSCAPE_IMPL_PARTITIONEDSIMULATOR_HPP
+
+#include <efscape/impl/efscapelib.hpp>
+#include <efscape/impl/ModelPartition.hpp>
+#include <efscape/utils/ThreadPool.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Implements a conservative parallel simulator for a network model
+     * (typically a DIGRAPH). The components of the root network are split
+     * into partitions, and each partition is simulated by its own thread
+     * with its own event list. Events sent between partitions are
+     * timestamped messages.
+     *
+     * Partitions are kept safe by lookahead: the minimum delay between an
+     * input to a component and any output it causes. The lookahead of a
+     * component is taken from:
+     * 1. the per-instance LookaheadMap given to the constructor (e.g. from
+     *    the "lookahead" of each model in a DIGRAPH JSON configuration, see
+     *    DigraphBuilder::build_digraph_from_json); or
+     * 2. the "lookahead" of the component's ModelType metadata.
+     * Components with no declared lookahead have a lookahead of 0.
+     *
+     * Each round, the simulator computes an earliest output time for each
+     * partition. It is the lesser of the partition's next internal event
+     * and its earliest possible input plus its lookahead, iterated to a
+     * fixed point over all partitions. Each partition then processes all
+     * of its events that come before the earliest output time of every
+     * other partition. If no partition can advance, all partitions take one
+     * synchronized step at the global minimum time. Simultaneous events
+     * always fall into such a step, so they are handled as in Parallel
+     * DEVS. With no lookahead, the simulator advances one event time per
+     * round, with the partitions working in parallel.
+     *
+     * Output events are reported to listeners after each round, in time
+     * order, on the calling thread. State changes are not reported. The
+     * requirements on the model are those of ParallelSimulator. Routing
+     * through the root network (e.g. adevs::Digraph::route) happens
+     * concurrently and must not modify the network.
+     *
+     * The partitions currently run as threads within a process. Partitions
+     * that run on separate MPI ranks, communicating through
+     * ModelHomeI::getCommunicator(), are left for future work.
+     */
+    class PartitionedSimulator
+    {
+    public:
+
+      /**
+       * constructor
+       *
+       * @param aCp_model handle to root model
+       * @param ai_partitions number of partitions (and threads)
+       * @param aCp_lookaheads per-instance lookaheads (optional)
+       */
+      PartitionedSimulator(DEVS* aCp_model, unsigned int ai_partitions,
+			   const LookaheadMap* aCp_lookaheads = NULL);
+
+      /** destructor */
+      ~PartitionedSimulator();
+
+      /** @returns time of the next event (adevs_inf if none) */
+      double nextEventTime();
+
+      /**
+       * Executes one round: either a window of events that every partition
+       * can process safely, or a synchronized step at the next event time.
+       */
+      void execNextEvent();
+
+      /**
+       * Executes events until the next event time is greater than the
+       * specified time.
+       *
+       * @param ad_tEnd end time
+       */
+      void execUntil(double ad_tEnd);
+
+      /**
+       * Sets the end of the simulation: events at or after this time are
+       * not executed.
+       *
+       * @param ad_timeEnd end time
+       */
+      void setEndTime(double ad_timeEnd) { md_timeEnd = ad_timeEnd; }
+
+      /**
+       * Adds an event listener, notified of every output event.
+       *
+       * @param aCp_listener handle to listener
+       */
+      void addEventListener(adevs::EventListener<IO_Type>* aCp_listener);
+
+      /** @returns number of partitions */
+      std::size_t numPartitions() const { return mC1_partitions.size(); }
+
+      /**
+       * @param ai_partition partition index
+       * @returns lookahead of the partition
+       */
+      double lookahead(std::size_t ai_partition) const;
+
+      /** @returns number of rounds that ran as windows */
+      unsigned long numWindows() const { return ml_windows; }
+
+      /** @returns number of rounds that ran as synchronized steps */
+      unsigned long numSteps() const { return ml_steps; }
+
+    private:
+
+      PartitionedSimulator(const PartitionedSimulator&);
+      PartitionedSimulator& operator=(const PartitionedSimulator&);
+
+      class Partition;
+
+      void round(double ad_limit);
+      void exchange();
+      void notify();
+
+      /** partitions */
+      std::vector< std::unique_ptr<Partition> > mC1_partitions;
+
+      /** partition that owns each model under the root */
+      PartitionMap mCC_owners;
+
+      /** event listeners */
+      std::vector< adevs::EventListener<IO_Type>* > mC1_listeners;
+
+      /** thread pool, one thread per partition */
+      std::unique_ptr<efscape::utils::ThreadPool> mCp_pool;
+
+      /** end time */
+      double md_timeEnd;
+
+      /** round statistics */
+      unsigned long ml_windows;
+      unsigned long ml_steps;
+
+    };				// class PartitionedSimulator
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_PARTITIONEDSIMULATOR_HPP
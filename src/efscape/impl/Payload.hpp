@@ -0,0 +1,548 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : Payload.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_PAYLOAD_HPP
+#define EFSCAPE_IMPL_PAYLOAD_HPP
+
+// boost definitions
+#include <boost/any.hpp>
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/split_free.hpp>
+
+// jsoncpp library definitions
+#include <json/json.h>
+
+// shared JSON documents
+#include <efscape/impl/SharedJson.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Exception thrown by the value form of payload_cast on a type mismatch.
+     * Derives from boost::bad_any_cast so that existing handlers written for
+     * boost::any continue to work.
+     */
+    class bad_payload_cast : public boost::bad_any_cast
+    {
+    public:
+      virtual const char* what() const throw() {
+	return "efscape::impl::bad_payload_cast: "
+	  "failed conversion using efscape::impl::payload_cast";
+      }
+    };
+
+    /**
+     * Implements a type-erased value holder for port values that can replace
+     * boost::any in IO_Type. Small values that are trivially copyable (or
+     * cheap, non-throwing handles such as smart pointers) are stored inline,
+     * so putting them on a port does not touch the heap. Larger values are
+     * held on the heap as boost::any does.
+     *
+     * Unlike boost::any_cast, type checks never throw: is<T>() and get<T>()
+     * compare a type tag and return false/null on a mismatch.
+     */
+    class Payload
+    {
+    public:
+
+      /** size in bytes of the inline buffer */
+      static const std::size_t BUFFER_SIZE = 3*sizeof(void*);
+
+      /** alignment of the inline buffer */
+      static const std::size_t BUFFER_ALIGN = alignof(double) > alignof(void*) ?
+	alignof(double) : alignof(void*);
+
+      /**
+       * Trait class that determines whether a type is stored inline.
+       *
+       * @tparam T value type
+       */
+      template <typename T>
+      struct stored_inline
+      {
+	static const bool value =
+	  sizeof(T) <= BUFFER_SIZE &&
+	  alignof(T) <= BUFFER_ALIGN &&
+	  (std::is_trivially_copyable<T>::value ||
+	   std::is_nothrow_move_constructible<T>::value);
+      };
+
+      /** default constructor (empty payload) */
+      Payload() : mCp_ops(NULL) {}
+
+      /**
+       * constructor
+       *
+       * @tparam T value type
+       * @param aCr_value value to be held
+       */
+      template <typename T,
+		typename = typename std::enable_if<
+		  !std::is_same<typename std::decay<T>::type, Payload>::value
+		  >::type >
+      Payload(T&& aCr_value) : mCp_ops(NULL) {
+	typedef typename std::decay<T>::type ValueType;
+	Handler<ValueType>::create(*this, std::forward<T>(aCr_value));
+      }
+
+      /** copy constructor */
+      Payload(const Payload& aCr_payload) : mCp_ops(NULL) {
+	copy_from(aCr_payload);
+      }
+
+      /** move constructor */
+      Payload(Payload&& aCr_payload) noexcept : mCp_ops(NULL) {
+	move_from(aCr_payload);
+      }
+
+      /** destructor */
+      ~Payload() { clear(); }
+
+      Payload& operator=(const Payload& aCr_payload) {
+	if (this != &aCr_payload) {
+	  Payload lC_copy(aCr_payload);
+	  clear();
+	  move_from(lC_copy);
+	}
+	return *this;
+      }
+
+      Payload& operator=(Payload&& aCr_payload) noexcept {
+	if (this != &aCr_payload) {
+	  clear();
+	  move_from(aCr_payload);
+	}
+	return *this;
+      }
+
+      template <typename T,
+		typename = typename std::enable_if<
+		  !std::is_same<typename std::decay<T>::type, Payload>::value
+		  >::type >
+      Payload& operator=(T&& aCr_value) {
+	Payload lC_copy(std::forward<T>(aCr_value));
+	clear();
+	move_from(lC_copy);
+	return *this;
+      }
+
+      /** @returns whether the payload is empty */
+      bool empty() const { return mCp_ops == NULL; }
+
+      /** releases the held value */
+      void clear() {
+	if (mCp_ops) {
+	  if (mCp_ops->destroy)
+	    mCp_ops->destroy(*this);
+	  mCp_ops = NULL;
+	}
+      }
+
+      /** @returns type info of the held value (typeid(void) if empty) */
+      const std::type_info& type() const {
+	return mCp_ops ? mCp_ops->type() : typeid(void);
+      }
+
+      /** @returns whether the held value is stored in the inline buffer */
+      bool isInline() const { return mCp_ops && mCp_ops->stored_inline; }
+
+      /**
+       * Checks the type of the held value without throwing.
+       *
+       * @tparam T value type
+       * @returns whether the payload holds a value of type T
+       */
+      template <typename T>
+      bool is() const {
+	// fast path: same handler instance; fall back on type_info equality
+	// for values created in another shared library
+	return mCp_ops != NULL &&
+	  (mCp_ops == &Handler<T>::ops || mCp_ops->type() == typeid(T));
+      }
+
+      /**
+       * Returns a pointer to the held value if it has the requested type.
+       *
+       * @tparam T value type
+       * @returns handle to value (null on a type mismatch)
+       */
+      template <typename T>
+      T* get() {
+	return is<T>() ? Handler<T>::pointer(*this) : NULL;
+      }
+
+      /**
+       * Returns a pointer to the held value if it has the requested type.
+       *
+       * @tparam T value type
+       * @returns handle to value (null on a type mismatch)
+       */
+      template <typename T>
+      const T* get() const {
+	return is<T>() ? Handler<T>::pointer(const_cast<Payload&>(*this)) :
+	  NULL;
+      }
+
+      /**
+       * Exchanges values with another payload.
+       *
+       * @param aCr_payload other payload
+       */
+      void swap(Payload& aCr_payload) noexcept {
+	Payload lC_tmp(std::move(aCr_payload));
+	aCr_payload = std::move(*this);
+	*this = std::move(lC_tmp);
+      }
+
+    private:
+
+      /** type-specific operations */
+      struct Ops
+      {
+	const std::type_info& (*type)();
+	void (*copy)(const Payload& src, Payload& dst); // null: bitwise copy
+	void (*move)(Payload& src, Payload& dst);	   // null: bitwise copy
+	void (*destroy)(Payload& p);			   // null: no-op
+	bool stored_inline;
+      };
+
+      /** default handler: value is allocated on the heap */
+      template <typename T, bool Inline = stored_inline<T>::value,
+		bool Trivial = std::is_trivially_copyable<T>::value>
+      struct Handler
+      {
+	static const Ops ops;
+
+	template <typename V>
+	static void create(Payload& p, V&& v) {
+	  p.mC_storage.mcp_heap = new T(std::forward<V>(v));
+	  p.mCp_ops = &ops;
+	}
+	static T* pointer(Payload& p) {
+	  return static_cast<T*>(p.mC_storage.mcp_heap);
+	}
+	static const std::type_info& type() { return typeid(T); }
+	static void copy(const Payload& src, Payload& dst) {
+	  dst.mC_storage.mcp_heap =
+	    new T(*static_cast<const T*>(src.mC_storage.mcp_heap));
+	}
+	static void destroy(Payload& p) {
+	  delete static_cast<T*>(p.mC_storage.mcp_heap);
+	}
+      };
+
+      /** inline handler for non-throwing movable handles */
+      template <typename T>
+      struct Handler<T, true, false>
+      {
+	static const Ops ops;
+
+	template <typename V>
+	static void create(Payload& p, V&& v) {
+	  new (p.mC_storage.mc_buffer) T(std::forward<V>(v));
+	  p.mCp_ops = &ops;
+	}
+	static T* pointer(Payload& p) {
+	  return reinterpret_cast<T*>(p.mC_storage.mc_buffer);
+	}
+	static const std::type_info& type() { return typeid(T); }
+	static void copy(const Payload& src, Payload& dst) {
+	  new (dst.mC_storage.mc_buffer)
+	    T(*reinterpret_cast<const T*>(src.mC_storage.mc_buffer));
+	}
+	static void move(Payload& src, Payload& dst) {
+	  T* lCp_src = reinterpret_cast<T*>(src.mC_storage.mc_buffer);
+	  new (dst.mC_storage.mc_buffer) T(std::move(*lCp_src));
+	  lCp_src->~T();
+	}
+	static void destroy(Payload& p) {
+	  reinterpret_cast<T*>(p.mC_storage.mc_buffer)->~T();
+	}
+      };
+
+      /** inline handler for trivially copyable values */
+      template <typename T>
+      struct Handler<T, true, true>
+      {
+	static const Ops ops;
+
+	template <typename V>
+	static void create(Payload& p, V&& v) {
+	  new (p.mC_storage.mc_buffer) T(std::forward<V>(v));
+	  p.mCp_ops = &ops;
+	}
+	static T* pointer(Payload& p) {
+	  return reinterpret_cast<T*>(p.mC_storage.mc_buffer);
+	}
+	static const std::type_info& type() { return typeid(T); }
+      };
+
+      void copy_from(const Payload& aCr_payload) {
+	if (aCr_payload.mCp_ops == NULL)
+	  return;
+	if (aCr_payload.mCp_ops->copy)
+	  aCr_payload.mCp_ops->copy(aCr_payload, *this);
+	else
+	  std::memcpy(&mC_storage, &aCr_payload.mC_storage, sizeof(mC_storage));
+	mCp_ops = aCr_payload.mCp_ops;
+      }
+
+      void move_from(Payload& aCr_payload) noexcept {
+	if (aCr_payload.mCp_ops == NULL)
+	  return;
+	if (aCr_payload.mCp_ops->move)
+	  aCr_payload.mCp_ops->move(aCr_payload, *this);
+	else		// trivial and heap values: steal the bits
+	  std::memcpy(&mC_storage, &aCr_payload.mC_storage, sizeof(mC_storage));
+	mCp_ops = aCr_payload.mCp_ops;
+	aCr_payload.mCp_ops = NULL;
+      }
+
+      /** inline buffer or handle to heap-allocated value */
+      union Storage {
+	void* mcp_heap;
+	alignas(BUFFER_ALIGN) unsigned char mc_buffer[BUFFER_SIZE];
+      } mC_storage;
+
+      /** type-specific operations (null if empty) */
+      const Ops* mCp_ops;
+
+    };				// class Payload
+
+    template <typename T, bool Inline, bool Trivial>
+    const Payload::Ops Payload::Handler<T, Inline, Trivial>::ops = {
+      &Payload::Handler<T, Inline, Trivial>::type,
+      &Payload::Handler<T, Inline, Trivial>::copy,
+      NULL,
+      &Payload::Handler<T, Inline, Trivial>::destroy,
+      false
+    };
+
+    template <typename T>
+    const Payload::Ops Payload::Handler<T, true, false>::ops = {
+      &Payload::Handler<T, true, false>::type,
+      &Payload::Handler<T, true, false>::copy,
+      &Payload::Handler<T, true, false>::move,
+      &Payload::Handler<T, true, false>::destroy,
+      true
+    };
+
+    template <typename T>
+    const Payload::Ops Payload::Handler<T, true, true>::ops = {
+      &Payload::Handler<T, true, true>::type,
+      NULL,
+      NULL,
+      NULL,
+      true
+    };
+
+    /**
+     * Non-throwing cast (mirrors the pointer form of boost::any_cast).
+     *
+     * @tparam T value type
+     * @param aCp_payload handle to payload
+     * @returns handle to value (null on a type mismatch)
+     */
+    template <typename T>
+    T* payload_cast(Payload* aCp_payload) {
+      return aCp_payload ? aCp_payload->get<T>() : NULL;
+    }
+
+    template <typename T>
+    const T* payload_cast(const Payload* aCp_payload) {
+      return aCp_payload ? aCp_payload->get<T>() : NULL;
+    }
+
+    /**
+     * Throwing cast (mirrors the value form of boost::any_cast).
+     *
+     * @tparam T value type
+     * @param aCr_payload payload
+     * @returns copy of value
+     * @throws bad_payload_cast on a type mismatch
+     */
+    template <typename T>
+    T payload_cast(const Payload& aCr_payload) {
+      typedef typename std::remove_cv<
+	typename std::remove_reference<T>::type>::type ValueType;
+      const ValueType* lCp_value = aCr_payload.get<ValueType>();
+      if (lCp_value == NULL)
+	throw bad_payload_cast();
+      return *lCp_value;
+    }
+
+    //--------------------------------------------------------------------
+    // serialization support: payloads holding one of the basic port value
+    // types (bool, int, long, double, std::string, Json::Value and
+    // SharedJson) can be archived; any other value is archived as an empty
+    // payload.
+    //--------------------------------------------------------------------
+
+    /**
+     * Returns the serialization tag of the held value.
+     *
+     * @param aCr_payload payload
+     * @returns tag ("" if empty or not serializable)
+     */
+    inline std::string payloadTypeTag(const Payload& aCr_payload) {
+      if (aCr_payload.is<bool>()) return "bool";
+      if (aCr_payload.is<int>()) return "int";
+      if (aCr_payload.is<long>()) return "long";
+      if (aCr_payload.is<double>()) return "double";
+      if (aCr_payload.is<std::string>()) return "string";
+      if (aCr_payload.is<Json::Value>()) return "json";
+      if (aCr_payload.is<SharedJson>()) return "shared_json";
+      return "";
+    }
+
+    /**
+     * Archives a payload with the specified save function, which is called
+     * with a name and a value of one of the supported types.
+     *
+     * @param aCr_payload payload
+     * @param aCr_save save function object
+     */
+    template <typename Saver>
+    void savePayload(const Payload& aCr_payload, Saver& aCr_save) {
+      std::string lC_tag = payloadTypeTag(aCr_payload);
+      aCr_save("type", lC_tag);
+      if (lC_tag == "bool") {
+	bool lb_value = *aCr_payload.get<bool>();
+	aCr_save("value", lb_value);
+      } else if (lC_tag == "int") {
+	int li_value = *aCr_payload.get<int>();
+	aCr_save("value", li_value);
+      } else if (lC_tag == "long") {
+	long ll_value = *aCr_payload.get<long>();
+	aCr_save("value", ll_value);
+      } else if (lC_tag == "double") {
+	double ld_value = *aCr_payload.get<double>();
+	aCr_save("value", ld_value);
+      } else if (lC_tag == "string") {
+	std::string lC_value = *aCr_payload.get<std::string>();
+	aCr_save("value", lC_value);
+      } else if (lC_tag == "json" || lC_tag == "shared_json") {
+	const Json::Value& lCr_json =
+	  (lC_tag == "json" ? *aCr_payload.get<Json::Value>() :
+	   aCr_payload.get<SharedJson>()->get());
+	Json::StreamWriterBuilder lC_builder;
+	lC_builder["indentation"] = "";
+	std::string lC_value = Json::writeString(lC_builder, lCr_json);
+	aCr_save("value", lC_value);
+      }
+    }
+
+    /**
+     * Restores a payload with the specified load function, the counterpart
+     * of savePayload.
+     *
+     * @param aCr_payload payload
+     * @param aCr_load load function object
+     */
+    template <typename Loader>
+    void loadPayload(Payload& aCr_payload, Loader& aCr_load) {
+      std::string lC_tag;
+      aCr_load("type", lC_tag);
+      aCr_payload.clear();
+      if (lC_tag == "bool") {
+	bool lb_value;
+	aCr_load("value", lb_value);
+	aCr_payload = lb_value;
+      } else if (lC_tag == "int") {
+	int li_value;
+	aCr_load("value", li_value);
+	aCr_payload = li_value;
+      } else if (lC_tag == "long") {
+	long ll_value;
+	aCr_load("value", ll_value);
+	aCr_payload = ll_value;
+      } else if (lC_tag == "double") {
+	double ld_value;
+	aCr_load("value", ld_value);
+	aCr_payload = ld_value;
+      } else if (lC_tag == "string") {
+	std::string lC_value;
+	aCr_load("value", lC_value);
+	aCr_payload = lC_value;
+      } else if (lC_tag == "json" || lC_tag == "shared_json") {
+	std::string lC_value;
+	aCr_load("value", lC_value);
+	Json::Value lC_json;
+	Json::CharReaderBuilder lC_builder;
+	std::string lC_errors;
+	std::istringstream lC_buffer(lC_value);
+	if (Json::parseFromStream(lC_builder, lC_buffer, &lC_json, &lC_errors)) {
+	  if (lC_tag == "json")
+	    aCr_payload = lC_json;
+	  else
+	    aCr_payload = SharedJson(std::move(lC_json));
+	}
+      }
+    }
+
+    /** adapts a boost archive to the savePayload/loadPayload interface */
+    template <class Archive>
+    struct BoostPayloadArchiver
+    {
+      Archive& mCr_ar;
+      template <typename T>
+      void operator()(const char* acp_name, T& aCr_value) {
+	mCr_ar & boost::serialization::make_nvp(acp_name, aCr_value);
+      }
+    };
+
+  } // namespace impl
+
+} // namespace efscape
+
+namespace boost {
+
+  namespace serialization {
+
+    template<class Archive>
+    void save(Archive & ar, const efscape::impl::Payload& aCr_payload,
+	      const unsigned int version)
+    {
+      efscape::impl::BoostPayloadArchiver<Archive> lC_archiver = { ar };
+      efscape::impl::savePayload(aCr_payload, lC_archiver);
+    }
+
+    template<class Archive>
+    void load(Archive & ar, efscape::impl::Payload& aCr_payload,
+	      const unsigned int version)
+    {
+      efscape::impl::BoostPayloadArchiver<Archive> lC_archiver = { ar };
+      efscape::impl::loadPayload(aCr_payload, lC_archiver);
+    }
+
+  } // namespace serialization
+
+} // namespace boost
+
+BOOST_SERIALIZATION_SPLIT_FREE(efscape::impl::Payload)
+
+#endif	// #ifndef EFSCAPE_IMPL_PAYLOAD_HPP
@@ -0,0 +1,63 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : PortFilter.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/PortFilter.hpp>
+
+namespace efscape {
+
+  namespace impl {
+
+    /** constructor */
+    PortFilter::PortFilter(const std::vector<std::string>& aCr_ports)
+    {
+      for (const auto& lCr_port : aCr_ports)
+	if (!lCr_port.empty())
+	  add(lCr_port);
+    }
+
+    PortFilter PortFilter::parse(const std::string& aCr_list)
+    {
+      static const char* lcp_blanks = " \t";
+
+      PortFilter lC_filter;
+      std::string::size_type li_begin = 0;
+      while (li_begin <= aCr_list.size()) {
+	std::string::size_type li_end = aCr_list.find(',', li_begin);
+	if (li_end == std::string::npos)
+	  li_end = aCr_list.size();
+
+	std::string lC_name = aCr_list.substr(li_begin, li_end - li_begin);
+	lC_name.erase(0, lC_name.find_first_not_of(lcp_blanks));
+	lC_name.erase(lC_name.find_last_not_of(lcp_blanks) + 1);
+	if (!lC_name.empty())
+	  lC_filter.add(lC_name);
+
+	li_begin = li_end + 1;
+      }
+      return lC_filter;
+    }
+
+    std::vector<std::string> PortFilter::ports() const
+    {
+      std::vector<std::string> lC1_ports;
+      lC1_ports.reserve(mCC_ports.size());
+      for (const auto& lCr_port : mCC_ports)
+	lC1_ports.push_back(lCr_port.name());
+      return lC1_ports;
+    }
+
+  } // namespace impl
+
+} // namespace efscape
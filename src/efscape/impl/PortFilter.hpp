@@ -0,0 +1,95 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : PortFilter.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_PORTFILTER_HPP
+#define EFSCAPE_IMPL_PORTFILTER_HPP
+
+#include <efscape/impl/PortSymbol.hpp>
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Implements the set of output ports a consumer subscribes to. Output on
+     * other ports is dropped where it is captured, before any value is cast
+     * or formatted. An empty filter accepts every port.
+     */
+    class PortFilter
+    {
+    public:
+
+      /** default constructor (accepts every port) */
+      PortFilter() {}
+
+      /**
+       * constructor
+       *
+       * @param aCr_ports names of the subscribed ports
+       */
+      explicit PortFilter(const std::vector<std::string>& aCr_ports);
+
+      /**
+       * Parses a comma-separated list of port names (blanks around names
+       * are ignored).
+       *
+       * @param aCr_list list of port names
+       * @returns filter
+       */
+      static PortFilter parse(const std::string& aCr_list);
+
+      /**
+       * Subscribes to a port.
+       *
+       * @param aCr_port port
+       */
+      void add(const PortSymbol& aCr_port) { mCC_ports.insert(aCr_port); }
+
+      /** Removes all subscriptions (the filter then accepts every port). */
+      void clear() { mCC_ports.clear(); }
+
+      /** @returns whether the filter accepts every port */
+      bool empty() const { return mCC_ports.empty(); }
+
+      /** @returns number of subscribed ports */
+      std::size_t size() const { return mCC_ports.size(); }
+
+      /**
+       * @param aCr_port port
+       * @returns whether output on the port is accepted
+       */
+      bool accepts(const PortSymbol& aCr_port) const {
+	return mCC_ports.empty() || mCC_ports.count(aCr_port) > 0;
+      }
+
+      /** @returns names of the subscribed ports (in no particular order) */
+      std::vector<std::string> ports() const;
+
+    private:
+
+      /** subscribed ports */
+      std::unordered_set<PortSymbol> mCC_ports;
+
+    };				// class PortFilter
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_PORTFILTER_HPP
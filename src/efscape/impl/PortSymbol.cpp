@@ -0,0 +1,84 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : PortSymbol.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/PortSymbol.hpp>
+
+#include <ostream>
+
+namespace efscape {
+
+  namespace impl {
+
+    //
+    // PortSymbolTable
+    //
+
+    /** constructor */
+    PortSymbolTable::PortSymbolTable() {}
+
+    PortSymbolTable& PortSymbolTable::Instance() {
+      // function-local static: safe to use from static port initializers in
+      // other translation units and loaded model libraries
+      static PortSymbolTable lC_table;
+      return lC_table;
+    }
+
+    const std::string* PortSymbolTable::intern(const std::string& aCr_name)
+    {
+      std::lock_guard<std::mutex> lC_lock(mC_mutex);
+      return &(*mCC_symbols.insert(aCr_name).first);
+    }
+
+    const std::string*
+    PortSymbolTable::find(const std::string& aCr_name) const
+    {
+      std::lock_guard<std::mutex> lC_lock(mC_mutex);
+      std::unordered_set<std::string>::const_iterator iter =
+	mCC_symbols.find(aCr_name);
+      return (iter == mCC_symbols.end() ? NULL : &(*iter));
+    }
+
+    std::size_t PortSymbolTable::size() const {
+      std::lock_guard<std::mutex> lC_lock(mC_mutex);
+      return mCC_symbols.size();
+    }
+
+    //
+    // PortSymbol
+    //
+
+    PortSymbol::PortSymbol() {
+      static const std::string* lCp_empty =
+	PortSymbolTable::Instance().intern("");
+      mCp_name = lCp_empty;
+    }
+
+    PortSymbol::PortSymbol(const char* acp_name) :
+      mCp_name( PortSymbolTable::Instance().intern(acp_name ? acp_name : "") )
+    {}
+
+    PortSymbol::PortSymbol(const std::string& aCr_name) :
+      mCp_name( PortSymbolTable::Instance().intern(aCr_name) )
+    {}
+
+    std::ostream& operator<<(std::ostream& aCr_ostream,
+			     const PortSymbol& aCr_port)
+    {
+      return aCr_ostream << aCr_port.name();
+    }
+
+  } // namespace impl
+
+} // namespace efscape
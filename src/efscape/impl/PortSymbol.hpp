@@ -0,0 +1,229 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : PortSymbol.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_PORTSYMBOL_HPP
+#define EFSCAPE_IMPL_PORTSYMBOL_HPP
+
+// boost serialization definitions
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/split_free.hpp>
+#include <boost/serialization/level.hpp>
+#include <boost/serialization/tracking.hpp>
+#include <boost/archive/detail/iserializer.hpp>
+#include <boost/archive/detail/oserializer.hpp>
+
+#include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Implements a process-wide table of interned port names. Each distinct
+     * name is stored exactly once and is never released, so the address of
+     * the stored string can serve as a stable identifier for the port.
+     */
+    class PortSymbolTable
+    {
+    public:
+
+      /** @returns reference to the singleton symbol table */
+      static PortSymbolTable& Instance();
+
+      /**
+       * Returns the interned copy of a port name, adding it to the table if
+       * needed.
+       *
+       * @param aCr_name port name
+       * @returns handle to the interned name
+       */
+      const std::string* intern(const std::string& aCr_name);
+
+      /**
+       * Looks up a port name without adding it to the table.
+       *
+       * @param aCr_name port name
+       * @returns handle to the interned name (null if not interned)
+       */
+      const std::string* find(const std::string& aCr_name) const;
+
+      /** @returns number of interned port names */
+      std::size_t size() const;
+
+    private:
+
+      PortSymbolTable();
+      PortSymbolTable(const PortSymbolTable&);
+      PortSymbolTable& operator=(const PortSymbolTable&);
+
+      /** guards the symbol set */
+      mutable std::mutex mC_mutex;
+
+      /** set of interned names (node-based: element addresses are stable) */
+      std::unordered_set<std::string> mCC_symbols;
+
+    };				// class PortSymbolTable
+
+    /**
+     * Implements an interned port identifier. The port name is resolved to a
+     * handle in the PortSymbolTable once, at construction, after which
+     * copies, equality tests, ordering and hashing are all constant-time
+     * pointer operations. The class converts implicitly from and to
+     * std::string so it can stand in wherever a port name string was used.
+     *
+     * Hot paths should compare against port symbols that have been resolved
+     * in advance (e.g. static class members) rather than string literals,
+     * since each literal is looked up in the symbol table.
+     */
+    class PortSymbol
+    {
+    public:
+
+      /** default constructor (empty port name) */
+      PortSymbol();
+
+      /**
+       * constructor
+       *
+       * @param acp_name port name
+       */
+      PortSymbol(const char* acp_name);
+
+      /**
+       * constructor
+       *
+       * @param aCr_name port name
+       */
+      PortSymbol(const std::string& aCr_name);
+
+      /** @returns port name */
+      const std::string& name() const { return *mCp_name; }
+
+      /** @returns port name as a C string */
+      const char* c_str() const { return mCp_name->c_str(); }
+
+      /** @returns whether the port name is empty */
+      bool empty() const { return mCp_name->empty(); }
+
+      /** @returns hash value of the port handle */
+      std::size_t hash() const {
+	return std::hash<const std::string*>()(mCp_name);
+      }
+
+      /** @returns port name */
+      operator const std::string&() const { return *mCp_name; }
+
+      friend bool operator==(const PortSymbol& aCr_lhs,
+			     const PortSymbol& aCr_rhs) {
+	return aCr_lhs.mCp_name == aCr_rhs.mCp_name;
+      }
+
+      friend bool operator!=(const PortSymbol& aCr_lhs,
+			     const PortSymbol& aCr_rhs) {
+	return aCr_lhs.mCp_name != aCr_rhs.mCp_name;
+      }
+
+      /**
+       * Orders ports by handle. The ordering is consistent within a process
+       * but is not alphabetical.
+       */
+      friend bool operator<(const PortSymbol& aCr_lhs,
+			    const PortSymbol& aCr_rhs) {
+	return std::less<const std::string*>()(aCr_lhs.mCp_name,
+					       aCr_rhs.mCp_name);
+      }
+
+    private:
+
+      /** handle to the interned port name */
+      const std::string* mCp_name;
+
+    };				// class PortSymbol
+
+    std::ostream& operator<<(std::ostream& aCr_ostream,
+			     const PortSymbol& aCr_port);
+
+    //------------------------------------------------------------
+    // cereal serialization: ports are archived by name, so JSON
+    // archives remain human-readable and independent of the table
+    //------------------------------------------------------------
+    template <class Archive>
+    std::string save_minimal(const Archive& ar, const PortSymbol& aCr_port)
+    {
+      return aCr_port.name();
+    }
+
+    template <class Archive>
+    void load_minimal(const Archive& ar, PortSymbol& aCr_port,
+		      const std::string& aCr_name)
+    {
+      aCr_port = PortSymbol(aCr_name);
+    }
+
+  } // namespace impl
+
+} // namespace efscape
+
+namespace boost {
+
+  namespace serialization {
+
+    // ports are archived as the bare name, in the layout of the port names
+    // (std::string) of existing snapshots
+    template<class Archive>
+    void save(Archive & ar, const efscape::impl::PortSymbol& aCr_port,
+	      const unsigned int version)
+    {
+      boost::archive::save_access::save_primitive(ar, aCr_port.name());
+    }
+
+    template<class Archive>
+    void load(Archive & ar, efscape::impl::PortSymbol& aCr_port,
+	      const unsigned int version)
+    {
+      std::string lC_name;
+      boost::archive::load_access::load_primitive(ar, lC_name);
+      aCr_port = efscape::impl::PortSymbol(lC_name);
+    }
+
+  } // namespace serialization
+
+} // namespace boost
+
+BOOST_SERIALIZATION_SPLIT_FREE(efscape::impl::PortSymbol)
+BOOST_CLASS_IMPLEMENTATION(efscape::impl::PortSymbol,
+			   boost::serialization::object_serializable)
+BOOST_CLASS_TRACKING(efscape::impl::PortSymbol,
+		     boost::serialization::track_never)
+
+namespace std {
+
+  template <>
+  struct hash<efscape::impl::PortSymbol>
+  {
+    std::size_t operator()(const efscape::impl::PortSymbol& aCr_port) const
+    {
+      return aCr_port.hash();
+    }
+  };
+
+} // namespace std
+
+#endif	// #ifndef EFSCAPE_IMPL_PORTSYMBOL_HPP
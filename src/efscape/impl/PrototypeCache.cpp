@@ -0,0 +1,162 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : PrototypeCache.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/PrototypeCache.hpp>
+
+#include <efscape/impl/ModelHomeI.hpp>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * constructor
+     *
+     * @param ai_capacity maximum number of prototypes held
+     */
+    PrototypeCache::PrototypeCache(std::size_t ai_capacity) :
+      mi_capacity(ai_capacity > 0 ? ai_capacity : 1),
+      ml_hits(0),
+      ml_misses(0)
+    {
+    }
+
+    /**
+     * Returns a new instance of the model with the specified configuration.
+     * The instance is cloned from the cached prototype of the configuration
+     * if there is one, and is otherwise built (and becomes the prototype).
+     * The build function may be called from several threads at once.
+     *
+     * @param aCr_config model configuration
+     * @param aCr_build builds a model from a configuration
+     * @returns smart pointer to a new model (null if the build fails)
+     */
+    DEVSPtr PrototypeCache::instance(const Json::Value& aCr_config,
+				     const Builder& aCr_build)
+    {
+      std::string lC_key = key(aCr_config);
+
+      PrototypePtr lCp_entry;
+      {
+	std::lock_guard<std::mutex> lC_lock(mC_mutex);
+	auto iter = mCCp_prototypes.find(lC_key);
+	if (iter != mCCp_prototypes.end())
+	  lCp_entry = iter->second;
+      }
+
+      // clone outside of the lock: the prototype is only read once the
+      // entry has been inserted
+      if (lCp_entry && lCp_entry->mb_cloneable) {
+	DEVSPtr lCp_clone = cloneModel(lCp_entry->mCp_model);
+	if (lCp_clone) {
+	  ++ml_hits;
+	  return lCp_clone;
+	}
+
+	LOG4CXX_ERROR(ModelHomeI::getLogger(),
+		      "Unable to clone the prototype of a cached model: "
+		      "rebuilding the model on each request");
+	lCp_entry->mb_cloneable = false;
+      }
+
+      ++ml_misses;
+      DEVSPtr lCp_model = aCr_build(aCr_config);
+      if (!lCp_model || lCp_entry)
+	return lCp_model;
+
+      // take the prototype from the new model before it is handed out and
+      // its state starts to change
+      PrototypePtr lCp_prototype(new Prototype);
+      lCp_prototype->mCp_model = cloneModel(lCp_model);
+      if (!lCp_prototype->mCp_model) {
+	LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+		      "Model cannot be cloned: not caching a prototype");
+	lCp_prototype->mb_cloneable = false;
+      }
+      insert(lC_key, lCp_prototype);
+
+      return lCp_model;
+    }
+
+    /**
+     * Returns the cache key of a configuration: its canonical (compact)
+     * JSON text. Json::Value keeps object members in sorted order, so the
+     * text does not depend on the member order of the source document.
+     *
+     * @param aCr_config model configuration
+     * @returns cache key
+     */
+    std::string PrototypeCache::key(const Json::Value& aCr_config)
+    {
+      Json::StreamWriterBuilder lC_builder;
+      lC_builder["indentation"] = "";
+      return Json::writeString(lC_builder, aCr_config);
+    }
+
+    /** Removes all prototypes. */
+    void PrototypeCache::clear()
+    {
+      std::lock_guard<std::mutex> lC_lock(mC_mutex);
+      mCCp_prototypes.clear();
+      mCC_order.clear();
+    }
+
+    /** @returns number of prototypes held */
+    std::size_t PrototypeCache::size() const
+    {
+      std::lock_guard<std::mutex> lC_lock(mC_mutex);
+      return mCCp_prototypes.size();
+    }
+
+    /**
+     * Sets the maximum number of prototypes held, evicting the oldest ones
+     * if needed.
+     *
+     * @param ai_capacity maximum number of prototypes held
+     */
+    void PrototypeCache::setCapacity(std::size_t ai_capacity)
+    {
+      std::lock_guard<std::mutex> lC_lock(mC_mutex);
+      mi_capacity = (ai_capacity > 0 ? ai_capacity : 1);
+      while (mCC_order.size() > mi_capacity) {
+	mCCp_prototypes.erase(mCC_order.front());
+	mCC_order.pop_front();
+      }
+    }
+
+    /**
+     * Inserts a prototype, unless another thread built the same
+     * configuration first.
+     *
+     * @param aCr_key configuration key
+     * @param aCp_entry prototype
+     */
+    void PrototypeCache::insert(const std::string& aCr_key,
+				const PrototypePtr& aCp_entry)
+    {
+      std::lock_guard<std::mutex> lC_lock(mC_mutex);
+      if (!mCCp_prototypes.emplace(aCr_key, aCp_entry).second)
+	return;
+
+      mCC_order.push_back(aCr_key);
+      while (mCC_order.size() > mi_capacity) {
+	mCCp_prototypes.erase(mCC_order.front());
+	mCC_order.pop_front();
+      }
+    }
+
+  } // namespace impl
+
+} // namespace efscape
@@ -0,0 +1,123 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : PrototypeCache.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_PROTOTYPECACHE_HPP
+#define EFSCAPE_IMPL_PROTOTYPECACHE_HPP
+
+#include <efscape/impl/efscapelib.hpp>
+
+#include <json/json.h>
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Caches the models built from model configurations, so that a
+     * configuration that is requested again is instantiated by cloning
+     * instead of being rebuilt. Building a model from its configuration
+     * goes through the factory and injects the model properties into every
+     * component; a clone is copied (see cloneModel()) from a prototype
+     * taken right after the model was first built and configured.
+     *
+     * Configurations are keyed by their canonical text (compact JSON, with
+     * object members in sorted order), so equivalent configurations share
+     * an entry whatever their layout. The first request for a
+     * configuration returns the model that was built; the prototype kept
+     * in the cache is a clone of it, which is never handed out or run. A
+     * model that cannot be cloned is rebuilt every time.
+     *
+     * The cache holds a bounded number of prototypes (oldest evicted
+     * first) and may be used from several threads.
+     */
+    class PrototypeCache
+    {
+    public:
+
+      /** builds a model from a configuration */
+      typedef std::function<DEVSPtr(const Json::Value&)> Builder;
+
+      PrototypeCache(std::size_t ai_capacity = 32);
+
+      DEVSPtr instance(const Json::Value& aCr_config,
+		       const Builder& aCr_build);
+
+      static std::string key(const Json::Value& aCr_config);
+
+      void clear();
+
+      std::size_t size() const;
+
+      /** @returns maximum number of prototypes held */
+      std::size_t capacity() const { return mi_capacity; }
+
+      void setCapacity(std::size_t ai_capacity);
+
+      /** @returns number of instances cloned from a prototype */
+      unsigned long hits() const { return ml_hits; }
+
+      /** @returns number of instances that were built */
+      unsigned long misses() const { return ml_misses; }
+
+    protected:
+
+      /** cached prototype */
+      struct Prototype {
+	/** prototype model */
+	DEVSPtr mCp_model;
+
+	/** whether the model can be cloned */
+	std::atomic<bool> mb_cloneable;
+
+	Prototype() : mb_cloneable(true) {}
+      };
+
+      typedef std::shared_ptr<Prototype> PrototypePtr;
+
+      void insert(const std::string& aCr_key, const PrototypePtr& aCp_entry);
+
+    private:
+
+      /** guards the entries */
+      mutable std::mutex mC_mutex;
+
+      /** prototypes by configuration key */
+      std::unordered_map<std::string, PrototypePtr> mCCp_prototypes;
+
+      /** keys in order of insertion (for eviction) */
+      std::deque<std::string> mCC_order;
+
+      /** maximum number of prototypes held */
+      std::size_t mi_capacity;
+
+      std::atomic<unsigned long> ml_hits;
+      std::atomic<unsigned long> ml_misses;
+
+    };				// class PrototypeCache
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_PROTOTYPECACHE_HPP
@@ -0,0 +1,45 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : RandomStream.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/RandomStream.hpp>
+
+namespace efscape {
+
+  namespace impl {
+
+    RandomEngine& randomEngine()
+    {
+      static thread_local RandomEngine lC_engine;
+      return lC_engine;
+    }
+
+    void seedRandomEngine(std::uint64_t al_seed)
+    {
+      randomEngine().seed(al_seed);
+    }
+
+    std::uint64_t replicationSeed(std::uint64_t al_seed,
+				  std::uint64_t al_replication)
+    {
+      std::uint64_t ll_z =
+	al_seed + (al_replication + 1)*UINT64_C(0x9E3779B97F4A7C15);
+      ll_z = (ll_z ^ (ll_z >> 30))*UINT64_C(0xBF58476D1CE4E5B9);
+      ll_z = (ll_z ^ (ll_z >> 27))*UINT64_C(0x94D049BB133111EB);
+      return ll_z ^ (ll_z >> 31);
+    }
+
+  } // namespace impl
+
+} // namespace efscape
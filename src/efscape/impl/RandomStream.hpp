@@ -0,0 +1,63 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : RandomStream.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_RANDOMSTREAM_HPP
+#define EFSCAPE_IMPL_RANDOMSTREAM_HPP
+
+#include <cstdint>
+#include <random>
+
+namespace efscape {
+
+  namespace impl {
+
+    /** random number engine used for the simulation random streams */
+    typedef std::mt19937_64 RandomEngine;
+
+    /**
+     * Returns the random number engine of the calling thread. A replication
+     * runs its model on a single thread, so a model that draws its random
+     * numbers from this engine gets the stream of its own replication. The
+     * worker threads of the parallel simulators have engines of their own,
+     * which are not seeded from the stream of the run.
+     *
+     * @returns random number engine of the calling thread
+     */
+    RandomEngine& randomEngine();
+
+    /**
+     * Seeds the random number engine of the calling thread.
+     *
+     * @param al_seed seed
+     */
+    void seedRandomEngine(std::uint64_t al_seed);
+
+    /**
+     * Derives the seed of a replication from a base seed. Seeds are
+     * scrambled (splitmix64) so that the streams of neighbouring
+     * replications are not correlated.
+     *
+     * @param al_seed base seed
+     * @param al_replication replication number
+     * @returns seed of the replication
+     */
+    std::uint64_t replicationSeed(std::uint64_t al_seed,
+				  std::uint64_t al_replication);
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_RANDOMSTREAM_HPP
@@ -0,0 +1,212 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : ReadColumns.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+
+#include <efscape/impl/ReadColumns.hpp>
+#include <efscape/impl/ColumnStore.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+namespace efscape {
+
+  namespace impl {
+
+    // class variables
+    const char* ReadColumns::mScp_program_name = "efcolumns";
+    const char* ReadColumns::mScp_program_version =
+      "version 0.1.0 (2026/10/17)";
+
+    /** default constructor */
+    ReadColumns::ReadColumns()
+    {
+      mC_extended_description.add_options()
+	("port", boost::program_options::value<std::string>(),
+	 "write out the time series of this port (CSV)")
+	;
+    }
+
+    /** destructor */
+    ReadColumns::~ReadColumns() {}
+
+    /**
+     * Returns the program name
+     *
+     * @returns the program name
+     */
+    const char* ReadColumns::program_name() {
+      return ReadColumns::mScp_program_name;
+    }
+
+    /**
+     * Returns the program name (class version)
+     *
+     * @returns the program name
+     */
+    const char* ReadColumns::ProgramName() {
+      return ReadColumns::mScp_program_name;
+    }
+
+    /**
+     * Returns the program version.
+     *
+     * @returns the program version
+     */
+    const char* ReadColumns::program_version() {
+      return ReadColumns::mScp_program_version;
+    }
+
+    /**
+     * Executes the ReadColumns command
+     *
+     * @returns exit state
+     */
+    int ReadColumns::execute() {
+
+      std::ofstream lC_file;
+      if (out_file() != "")
+	lC_file.open(out_file().c_str());
+      std::ostream lC_out(out_file() != "" ? lC_file.rdbuf() :
+			  std::cout.rdbuf());
+      lC_out << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+      try {
+	ColumnReader lC_reader((*this)[0]);
+
+	//----------------------------------------------------------------------
+	// 1. list the ports
+	//----------------------------------------------------------------------
+	if (mC_port.empty()) {
+	  lC_out << "port,chunks,rows,columns,time_min,time_max\n";
+	  for (const auto& lCr_port : lC_reader.ports()) {
+	    std::size_t li_rows = 0;
+	    std::vector<std::string> lC1_columns;
+	    double ld_timeMin = std::numeric_limits<double>::infinity();
+	    double ld_timeMax = -ld_timeMin;
+	    std::vector<const ColumnReader::Chunk*> lC1_chunks =
+	      lC_reader.chunks(lCr_port);
+	    for (const auto lCp_chunk : lC1_chunks) {
+	      li_rows += lCp_chunk->rows;
+	      for (const auto& lCr_column : lCp_chunk->columns)
+		if (std::find(lC1_columns.begin(), lC1_columns.end(),
+			      lCr_column.name) == lC1_columns.end())
+		  lC1_columns.push_back(lCr_column.name);
+	      for (std::size_t i = 0; i < lCp_chunk->rows; i++) {
+		ld_timeMin = std::min(ld_timeMin, lCp_chunk->time[i]);
+		ld_timeMax = std::max(ld_timeMax, lCp_chunk->time[i]);
+	      }
+	    }
+
+	    lC_out << '"' << lCr_port << "\"," << lC1_chunks.size() << ','
+		   << li_rows << ",\"";
+	    for (std::size_t i = 0; i < lC1_columns.size(); i++)
+	      lC_out << (i > 0 ? " " : "") << lC1_columns[i];
+	    lC_out << "\"," << ld_timeMin << ',' << ld_timeMax << '\n';
+	  }
+	  return EXIT_SUCCESS;
+	}
+
+	//----------------------------------------------------------------------
+	// 2. write out the time series of a port (the header is repeated when
+	//    the columns of the port change)
+	//----------------------------------------------------------------------
+	std::vector<const ColumnReader::Chunk*> lC1_chunks =
+	  lC_reader.chunks(mC_port);
+	if (lC1_chunks.empty()) {
+	  std::cerr << program_name() << ": no output on port <" << mC_port
+		    << "> in <" << (*this)[0] << ">\n";
+	  return EXIT_FAILURE;
+	}
+
+	std::string lC_header;
+	for (const auto lCp_chunk : lC1_chunks) {
+	  std::string lC_columns = "time";
+	  for (const auto& lCr_column : lCp_chunk->columns)
+	    lC_columns += ",\"" + lCr_column.name + '"';
+	  if (lC_columns != lC_header) {
+	    lC_out << lC_columns << '\n';
+	    lC_header = lC_columns;
+	  }
+
+	  for (std::size_t i = 0; i < lCp_chunk->rows; i++) {
+	    lC_out << lCp_chunk->time[i];
+	    for (const auto& lCr_column : lCp_chunk->columns)
+	      lC_out << ',' << lCr_column.at(i);
+	    lC_out << '\n';
+	  }
+	}
+      }
+      catch(std::logic_error lC_excp) {
+	std::cerr << program_name() << ": " << lC_excp.what() << '\n';
+	return EXIT_FAILURE;
+      }
+
+      return EXIT_SUCCESS;
+    }
+
+    /**
+     * Parses the command line arguements and initializes the command
+     * configuration.
+     *
+     * @param argc number of command line arguments
+     * @param argv vector of command line arguments
+     * @returns exit status
+     */
+    int ReadColumns::parse_options(int argc, char *argv[]) {
+
+      int li_status = CommandOpt::parse_options(argc,argv);	// parent method
+      if (li_status != 0)
+	return li_status;
+
+      if (files() != 1) {
+	usage(1);
+	return 1;
+      }
+
+      if (mC_variable_map.count("port"))
+	mC_port = mC_variable_map["port"].as<std::string>();
+
+      return li_status;
+    }
+
+    /**
+     * Prints out usage message for this command/program
+     *
+     * @args  exit_value exit value
+     */
+    void ReadColumns::usage( int exit_value )
+    {
+      std::cerr << "usage:\n"
+		<< program_name() << " "
+		<< "[-d] [-h] [-v]\n\t"
+		<< "[-o output_file]\n\t"
+		<< "[--port port]\n\t"
+		<< "column_file\n\n"
+		<< "where [] indicates optional option:\n\n"
+		<< mC_description
+		<< "examples:\n\t\t"
+		<< program_name() << " out.efc\n\t\t"
+		<< program_name() << " --port out -o out.csv out.efc\n\n"
+		<< "A column file is written by efdriver when its output file"
+		<< " has the extension .efc.\n";
+
+      exit( exit_value );
+    }
+
+  } // namespace impl
+
+} // namespace efscape
@@ -24,6 +24,8 @@
 #include <relogo/SimulationRunnerPlus.h>
 #include <json/json.h>
 
+#include <map>
+
 namespace efscape
 {
 namespace impl
@@ -76,6 +78,7 @@ public:
   // devs model ports
   //-----------------
   static const efscape::impl::PortType setup_in;
+  static const efscape::impl::PortType properties_out;
 
 private:
   void setup(std::string aC_propsFile);
@@ -90,6 +93,9 @@ private:
   /** handle to Repast properties in JSON format */
   Json::Value mC_modelProps;
 
+  /** output port of each member of the model output, by name */
+  std::map<std::string, efscape::impl::PortType> mCC_outputPorts;
+
   /** handle to Repast model */
   std::unique_ptr< repast::relogo::SimulationRunnerPlus<ObserverType, PatchType> >
   mCp_model;
@@ -42,6 +42,9 @@ namespace impl
 template <typename ObserverType, typename PatchType>
 const PortType RelogoWrapper<ObserverType, PatchType>::setup_in =
     "setup_in";
+template <typename ObserverType, typename PatchType>
+const PortType RelogoWrapper<ObserverType, PatchType>::properties_out =
+    "properties_out";
 
 /**
      * default constructor
@@ -237,11 +240,12 @@ void RelogoWrapper<ObserverType, PatchType>::delta_ext(double e,
       
       std::string lC_configFile = "";
       
-      try {
-	lC_configFile =
-	  boost::any_cast<std::string>( i.value );
+      const std::string* lCp_configFile =
+	value_cast<std::string>( &i.value );
+      if (lCp_configFile) {
+	lC_configFile = *lCp_configFile;
       }
-      catch (const boost::bad_any_cast &) {
+      else {
 	LOG4CXX_DEBUG(ModelHomeI::getLogger(),
 		      "Unable to translate output");
       }
@@ -301,10 +305,10 @@ void RelogoWrapper<ObserverType, PatchType>::output_func(adevs::Bag<IO_Type> &yb
     lC_parameters[*iter] = lCr_properties.getProperty(*iter);
   }
 
-  // output properties map
-  IO_Type y("properties_out",
-                           lC_parameters);
-  yb.insert(y);
+  // output properties map: the document is moved into a shared, immutable
+  // payload so that it is never deep-copied downstream
+  yb.insert( IO_Type(properties_out,
+                     SharedJson( std::move(lC_parameters) )) );
 
   // get model output and direct output to output ports
   Json::Value lC_output =
@@ -314,9 +318,15 @@ void RelogoWrapper<ObserverType, PatchType>::output_func(adevs::Bag<IO_Type> &yb
     Json::Value::Members lC_memberNames =
       lC_output.getMemberNames();
     for (int i = 0; i < lC_memberNames.size(); i++) {
-      y = IO_Type( lC_memberNames[i],
-				  lC_output[ lC_memberNames[i] ] );
-      yb.insert(y);
+      // each member subtree becomes its own shared document, on a port
+      // resolved once per member name
+      auto lC_port = mCC_outputPorts.find(lC_memberNames[i]);
+      if (lC_port == mCC_outputPorts.end())
+        lC_port = mCC_outputPorts.insert
+          ( std::make_pair(lC_memberNames[i],
+                           PortType(lC_memberNames[i])) ).first;
+      yb.insert( IO_Type( lC_port->second,
+                          SharedJson( std::move(lC_output[ lC_memberNames[i] ]) )) );
     }
   }
 }
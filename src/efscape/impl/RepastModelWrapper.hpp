@@ -23,6 +23,8 @@
 #include <efscape/impl/efscapelib.hpp>
 #include <json/json.h>
 
+#include <map>
+
 namespace efscape {
   namespace impl {
 
@@ -74,6 +76,7 @@ namespace efscape {
       // devs model ports
       //-----------------
       static const efscape::impl::PortType setup_in;
+      static const efscape::impl::PortType properties_out;
 
     private:
 
@@ -89,6 +92,9 @@ namespace efscape {
       /** handle to Repast properties in JSON format */
       Json::Value mC_modelProps;
 
+      /** output port of each member of the model output, by name */
+      std::map<std::string, efscape::impl::PortType> mCC_outputPorts;
+
       /** handle to Repast model */
       std::unique_ptr<ModelType> mCp_model;
 
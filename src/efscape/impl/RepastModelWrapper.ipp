@@ -40,6 +40,9 @@ namespace efscape {
     template <class ModelType>
     const PortType RepastModelWrapper<ModelType>::setup_in =
       "setup_in";
+    template <class ModelType>
+    const PortType RepastModelWrapper<ModelType>::properties_out =
+      "properties_out";
 
     /**
      * default constructor
@@ -216,11 +219,12 @@ namespace efscape {
 	
 	std::string lC_configFile = "";
 	
-	try {
-	  lC_configFile =
-	    boost::any_cast<std::string>( i.value );
+	const std::string* lCp_configFile =
+	  value_cast<std::string>( &i.value );
+	if (lCp_configFile) {
+	  lC_configFile = *lCp_configFile;
 	}
-	catch (const boost::bad_any_cast &) {
+	else {
 	  LOG4CXX_DEBUG(ModelHomeI::getLogger(),
 			"Unable to translate output");
 	}
@@ -277,10 +281,10 @@ namespace efscape {
 	lC_parameters[*iter] = lCr_properties.getProperty(*iter);
       }
 
-      // output properties map
-      IO_Type y("properties_out",
-		lC_parameters);
-      yb.insert(y);
+      // output properties map: the document is moved into a shared,
+      // immutable payload so that it is never deep-copied downstream
+      yb.insert( IO_Type(properties_out,
+			 SharedJson( std::move(lC_parameters) )) );
 
       // get model output and direct output to output ports
       Json::Value lC_output =
@@ -290,9 +294,15 @@ namespace efscape {
 	Json::Value::Members lC_memberNames =
 	  lC_output.getMemberNames();
 	for (int i = 0; i < lC_memberNames.size(); i++) {
-	  y = IO_Type( lC_memberNames[i],
-		       lC_output[ lC_memberNames[i] ] );
-	  yb.insert(y);
+	  // each member subtree becomes its own shared document, on a port
+	  // resolved once per member name
+	  auto lC_port = mCC_outputPorts.find(lC_memberNames[i]);
+	  if (lC_port == mCC_outputPorts.end())
+	    lC_port = mCC_outputPorts.insert
+	      ( std::make_pair(lC_memberNames[i],
+			       PortType(lC_memberNames[i])) ).first;
+	  yb.insert( IO_Type( lC_port->second,
+			      SharedJson( std::move(lC_output[ lC_memberNames[i] ]) )) );
 	}
       }
     }
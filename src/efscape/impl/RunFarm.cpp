@@ -0,0 +1,111 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : RunFarm.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/RunFarm.hpp>
+
+#include <boost/mpi/status.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/string.hpp>
+
+namespace efscape {
+
+  namespace impl {
+
+    namespace {
+
+      // message tags
+      enum FarmTag {
+	FARM_REQUEST = 1,	// worker -> master: result, asks for a run
+	FARM_RUN = 2,		// master -> worker: run number
+	FARM_STOP = 3		// master -> worker: no more runs
+      };
+
+      // the result of a run, sent along with a request for the next run
+      struct FarmResult
+      {
+	FarmResult() : run(-1), succeeded(false) {}
+
+	/** run number (-1: first request, no result) */
+	long run;
+
+	/** whether the run succeeded */
+	bool succeeded;
+
+	/** results */
+	RunValues values;
+
+	template <class Archive>
+	void serialize(Archive& ar, const unsigned int version) {
+	  ar & run;
+	  ar & succeeded;
+	  ar & values;
+	}
+      };
+
+    } // namespace
+
+    void runFarmMaster(boost::mpi::communicator& aCr_world,
+		       std::size_t ai_runs,
+		       const FarmCollect& aCr_collect)
+    {
+      std::size_t li_next = 0;
+      int li_workers = aCr_world.size() - 1;
+
+      while (li_workers > 0) {
+	FarmResult lC_result;
+	boost::mpi::status lC_status =
+	  aCr_world.recv(boost::mpi::any_source, FARM_REQUEST, lC_result);
+
+	if (lC_result.run >= 0)
+	  aCr_collect(lC_result.run, lC_result.succeeded, lC_result.values);
+
+	if (li_next < ai_runs) {
+	  unsigned long ll_run = li_next++;
+	  aCr_world.send(lC_status.source(), FARM_RUN, ll_run);
+	}
+	else {
+	  aCr_world.send(lC_status.source(), FARM_STOP);
+	  --li_workers;
+	}
+      }
+    }
+
+    void runFarmWorker(boost::mpi::communicator& aCr_world,
+		       const FarmWork& aCr_work)
+    {
+      FarmResult lC_result;
+
+      for (;;) {
+	aCr_world.send(0, FARM_REQUEST, lC_result);
+
+	boost::mpi::status lC_status =
+	  aCr_world.probe(0, boost::mpi::any_tag);
+	if (lC_status.tag() == FARM_STOP) {
+	  aCr_world.recv(0, FARM_STOP);
+	  return;
+	}
+
+	unsigned long ll_run;
+	aCr_world.recv(0, FARM_RUN, ll_run);
+
+	lC_result.run = ll_run;
+	lC_result.values.clear();
+	lC_result.succeeded = aCr_work(ll_run, lC_result.values);
+      }
+    }
+
+  } // namespace impl
+
+} // namespace efscape
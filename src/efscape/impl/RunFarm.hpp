@@ -0,0 +1,74 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : RunFarm.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_RUNFARM_HPP
+#define EFSCAPE_IMPL_RUNFARM_HPP
+
+#include <boost/mpi/communicator.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+
+namespace efscape {
+
+  namespace impl {
+
+    /** numeric results of a run (see RunResult) */
+    typedef std::map<std::string, double> RunValues;
+
+    /**
+     * Makes a run on a worker: returns whether the run succeeded, and its
+     * results.
+     */
+    typedef std::function<bool(std::size_t, RunValues&)> FarmWork;
+
+    /** Receives the outcome and the results of a run on the master. */
+    typedef std::function<void(std::size_t, bool, const RunValues&)>
+    FarmCollect;
+
+    /**
+     * Farms out runs [0, ai_runs) to the worker ranks of a communicator,
+     * master/worker style: rank 0 (the caller) hands out one run at a time
+     * to each worker that asks for work. A worker asks again when it sends
+     * back the results of its run. Workers that draw long runs simply ask
+     * less often, so runs of very uneven length balance across the ranks.
+     * Returns once every run has been collected and the workers have been
+     * stopped.
+     *
+     * @param aCr_world communicator (size > 1)
+     * @param ai_runs number of runs
+     * @param aCr_collect receives the results of each run
+     */
+    void runFarmMaster(boost::mpi::communicator& aCr_world,
+		       std::size_t ai_runs,
+		       const FarmCollect& aCr_collect);
+
+    /**
+     * Works on the runs handed out by runFarmMaster until the master stops
+     * this rank.
+     *
+     * @param aCr_world communicator
+     * @param aCr_work makes a run
+     */
+    void runFarmWorker(boost::mpi::communicator& aCr_world,
+		       const FarmWork& aCr_work);
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_RUNFARM_HPP
@@ -22,12 +22,33 @@
 
 // #include <efscape/impl/AdevsModel.hpp>
 #include <efscape/impl/SimRunner.hpp>
+#include <efscape/impl/AtomicIndex.hpp>
+#include <efscape/impl/adevs_json.hpp>
+#include <efscape/impl/ColumnStore.hpp>
+#include <efscape/impl/OutputCollector.hpp>
+#include <efscape/impl/OutputReducer.hpp>
+#include <efscape/impl/OutputWriter.hpp>
+#include <efscape/impl/ParallelSimulator.hpp>
+#include <efscape/impl/PartitionedSimulator.hpp>
+#include <efscape/impl/TimeWarpSimulator.hpp>
+#include <efscape/impl/RandomStream.hpp>
+#include <efscape/impl/Snapshot.hpp>
+#include <efscape/utils/ForkRunner.hpp>
+#include <efscape/utils/ThreadPool.hpp>
+#include <efscape/utils/MappedFile.hpp>
+#include <efscape/utils/SharedRing.hpp>
 
 // Include for handling JSON
 #include <json/json.h>
 
 #include <boost/filesystem/operations.hpp>
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <boost/algorithm/string.hpp>
 
@@ -37,13 +58,200 @@ namespace efscape {
 
   namespace impl {
 
+    namespace {
+
+      // runs a simulator (adevs::Simulator or one of the parallel
+      // simulators) until the time max, passing the output of each step to
+      // the sink (stamped with the time of each event, since a step of a
+      // partitioned simulator spans many event times), and returns the time
+      // of the last step or event
+      template <class Simulator>
+      double advance(Simulator& aCr_simulator, double ad_timeMax,
+		     OutputCollector& aCr_output, SimRunner* aCp_runner,
+		     const RunSim::OutputSink& aCr_sink)
+      {
+	double ld_time = 0.;
+	double ld_timeLast = 0.;
+	while ( (ld_time = aCr_simulator.nextEventTime()) < ad_timeMax ) {
+	  aCr_simulator.execNextEvent();
+
+	  // keep the clock (and checkpoints) of an unwrapped SimRunner up
+	  // to date
+	  if (aCp_runner != NULL)
+	    aCp_runner->synchronize(ld_time);
+
+	  // hand over the output produced by this step
+	  ld_timeLast = std::max(ld_timeLast, ld_time);
+	  for (const auto& i : aCr_output.events()) {
+	    aCr_sink(i.first.value, i.second);
+	    ld_timeLast = std::max(ld_timeLast, i.second);
+	  }
+	  aCr_output.clear();
+	}
+	return ld_timeLast;
+      }
+
+      // runs a simulator (as advance()), capturing its output with the
+      // collector
+      template <class Simulator>
+      double simulate(Simulator& aCr_simulator, double ad_timeMax,
+		      OutputCollector& aCr_output, SimRunner* aCp_runner,
+		      const RunSim::OutputSink& aCr_sink)
+      {
+	aCr_simulator.addEventListener(&aCr_output);
+	return advance(aCr_simulator, ad_timeMax, aCr_output, aCp_runner,
+		       aCr_sink);
+      }
+
+      // returns a sink that writes out the JSON output values
+      RunSim::OutputSink json_sink(OutputWriter& aCr_writer)
+      {
+	return [&aCr_writer](const IO_Type& aCr_value, double) {
+	  aCr_writer.write(aCr_value);
+	};
+      }
+
+      // returns a sink that writes out the numeric output values as columns
+      RunSim::OutputSink column_sink(ColumnWriter& aCr_columns)
+      {
+	return [&aCr_columns](const IO_Type& aCr_value, double ad_time) {
+	  aCr_columns.write(aCr_value, ad_time);
+	};
+      }
+
+      // returns a sink that also publishes the JSON output values to a
+      // shared-memory ring (if any), as compact records
+      // {"time": t, "port": p, "value": v}
+      RunSim::OutputSink ring_sink(efscape::utils::SharedRingWriter* aCp_ring,
+				   const RunSim::OutputSink& aCr_sink)
+      {
+	if (aCp_ring == NULL)
+	  return aCr_sink;
+
+	Json::StreamWriterBuilder lC_builder;
+	lC_builder["indentation"] = "";
+	std::shared_ptr<Json::StreamWriter>
+	  lCp_writer(lC_builder.newStreamWriter());
+	std::shared_ptr<std::ostringstream>
+	  lCp_record(new std::ostringstream);
+	lCp_record->precision(std::numeric_limits<double>::max_digits10);
+
+	return [aCp_ring, aCr_sink, lCp_writer, lCp_record]
+	  (const IO_Type& aCr_value, double ad_time) {
+	  aCr_sink(aCr_value, ad_time);
+
+	  const Json::Value* lCp_value =
+	    json_value_cast(&aCr_value.value);
+	  if (lCp_value == NULL)
+	    return;
+
+	  lCp_record->str("");
+	  *lCp_record << "{\"time\":" << ad_time << ",\"port\":"
+		      << Json::valueToQuotedString(aCr_value.port.c_str())
+		      << ",\"value\":";
+	  lCp_writer->write(*lCp_value, lCp_record.get());
+	  *lCp_record << '}';
+
+	  const std::string& lC_record = lCp_record->str();
+	  aCp_ring->write(lC_record.data(), lC_record.size());
+	};
+      }
+
+      // returns a checkpoint path template with a replication tag appended
+      // to the file name, before its extensions (which select the format of
+      // the checkpoints), e.g. "run-{n}.efb.lz4" -> "run-{n}-07.efb.lz4"
+      std::string replication_path(const std::string& aCr_path,
+				   const std::string& aCr_tag)
+      {
+	fs::path lC_path(aCr_path);
+	std::string lC_name = lC_path.filename().string();
+	std::size_t li_dot = lC_name.find('.', 1);
+	if (li_dot == std::string::npos)
+	  li_dot = lC_name.size();
+	lC_name.insert(li_dot, "-" + aCr_tag);
+	return (lC_path.parent_path() / lC_name).string();
+      }
+
+      // returns whether a file holds columnar output (see ColumnWriter)
+      bool is_column_file(const std::string& aCr_fileName)
+      {
+	return fs::path(aCr_fileName).extension() == ".efc";
+      }
+
+      // returns a sink that passes the output through a reducer (if any)
+      RunSim::OutputSink reduced_sink(OutputReducer* aCp_reducer,
+				      const RunSim::OutputSink& aCr_sink)
+      {
+	if (aCp_reducer == NULL)
+	  return aCr_sink;
+	return [aCp_reducer](const IO_Type& aCr_value, double ad_time) {
+	  aCp_reducer->push(aCr_value, ad_time);
+	};
+      }
+
+      // returns a sink that stamps the output with the session time (the
+      // simulators count time from the (re)start of the session)
+      RunSim::OutputSink shifted_sink(double ad_timeOrigin,
+				      const RunSim::OutputSink& aCr_sink)
+      {
+	if (ad_timeOrigin == 0.)
+	  return aCr_sink;
+	return [ad_timeOrigin, aCr_sink](const IO_Type& aCr_value,
+					 double ad_time) {
+	  aCr_sink(aCr_value, ad_timeOrigin + ad_time);
+	};
+      }
+
+    } // namespace
+
     // class variables
     const char* RunSim::mScp_program_name = "efdriver";
     const char* RunSim::mScp_program_version =
       "version 1.1.0 (2019/01/22)";
 
     /** default constructor */
-    RunSim::RunSim() {
+    RunSim::RunSim() :
+      mb_rootOnly(false),
+      mi_threads(1),
+      mi_partitions(1),
+      mb_optimistic(false),
+      mi_replications(1),
+      ml_seed(1),
+      mb_seeded(false),
+      mb_restart(false),
+      mi_ringSize(16),
+      mCp_ring(NULL)
+    {
+      mC_extended_description.add_options()
+	("root-only", "write only output on the ports of the root model")
+	("ports", boost::program_options::value<std::string>(),
+	 "write only output on these ports (comma-separated list of port "
+	 "names; default: all)")
+	("reduce", boost::program_options::value<std::string>(),
+	 "decimate or aggregate the output of ports (JSON file: {\"port\": "
+	 "{\"reduce\": \"sample\"|\"last\"|\"stats\", \"every\": n | "
+	 "\"window\": dt}, ...})")
+	("threads,t", boost::program_options::value<unsigned int>(),
+	 "number of threads for the parallel simulator (default: 1)")
+	("partitions,p", boost::program_options::value<unsigned int>(),
+	 "number of partitions for the partitioned simulator (default: 1; "
+	 "the run is not checkpointed)")
+	("optimistic", "run the partitions optimistically (Time Warp)")
+	("replications,r", boost::program_options::value<unsigned int>(),
+	 "number of replications, run concurrently on the threads "
+	 "(default: 1; not with --partitions)")
+	("seed", boost::program_options::value<std::uint64_t>(),
+	 "base seed of the random number streams (default: 1)")
+	("restart", "restart the run from its latest checkpoint, if any")
+	("branch", boost::program_options::value<std::string>(),
+	 "branch the run into variants (JSON file: {\"time\": t, "
+	 "\"variants\": [properties, ...]})")
+	("shm", boost::program_options::value<std::string>(),
+	 "also publish the output to a shared-memory ring buffer with this "
+	 "name, read live with eftail")
+	("shm-size", boost::program_options::value<std::size_t>(),
+	 "capacity of the shared-memory ring buffer in MB (default: 16)")
+	;
     }
 
     /** destructor */
@@ -181,8 +389,6 @@ namespace efscape {
 	//    which should be a valid parameter file name.
 	//    Attempt to create model from the specified parameter file
 	//----------------------------------------------------------------------
-	std::shared_ptr<DEVS> lCp_model;
-	Json::Value lC_info;
 	lC_parmName = (*this)[0];
 	LOG4CXX_DEBUG(ModelHomeI::getLogger(),
 		      "Running with a single parameter <"
@@ -190,16 +396,27 @@ namespace efscape {
 	LOG4CXX_DEBUG(ModelHomeI::getLogger(),
 		      "Loading file <" << lC_parmName << ">");
 
-	fs::path p =
-	  fs::path(lC_parmName.c_str());
+	// the archive format of the input is given by the extension of its
+	// name, under the extension of its compression codec, if any
+	// (e.g. "model.json.gz")
+	std::string lC_format = snapshotFormat(lC_parmName);
+	bool lb_compressed = (snapshotCodec(lC_parmName) != NO_CODEC);
 
-	//----------------------------------------------------------------------
-	// 2a. If this the input file is in JSON format:
-	//     1. First attempt to load the input as a JSON parameter file
-	//     2. If the first attempt fails, attempt to load the input as a
-	//        a cereal serialization of the model
-	//----------------------------------------------------------------------
-	if (p.extension().string() == ".json") {
+	// the input file is read and parsed once: replications build their
+	// models from the contents held in memory
+	Json::Value lC_info;
+	std::string lC_contents;
+	if (lb_compressed) {
+	  try {
+	    std::unique_ptr<std::istream> lCp_in = openSnapshotIn(lC_parmName);
+	    std::ostringstream buf;
+	    buf << lCp_in->rdbuf();
+	    lC_contents = buf.str();
+	  } catch (const std::exception& lC_excp) {
+	    LOG4CXX_ERROR(ModelHomeI::getLogger(), lC_excp.what());
+	  }
+	}
+	else if (lC_format == ".json") {
 	  // try to load the parameter file
 	  std::ifstream parmFile(lC_parmName.c_str());
 
@@ -209,13 +426,69 @@ namespace efscape {
 	    char ch;
 	    while (buf && parmFile.get( ch ))
 	      buf.put( ch );
-	    LOG4CXX_DEBUG(ModelHomeI::getLogger(),
-	  		  buf.str() );
-	    
-	    lCp_model =
-	      Singleton<ModelHomeI>::Instance().
-	      createModelFromParameters(buf.str());
-	    
+	    lC_contents = buf.str();
+	  }
+	}
+
+	if (lC_format == ".json" && lC_contents != "") {
+	  LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+			lC_contents );
+
+	  // load parameter into a JSON value
+	  std::istringstream lC_buffer_in(lC_contents);
+	  lC_buffer_in >> lC_info;
+	}
+
+	// an uncompressed binary snapshot is mapped rather than read: each
+	// model is restored straight from the file
+	std::unique_ptr<efscape::utils::MappedFile> lCp_snapshot;
+	if (lC_format == ".efb" && !lb_compressed) {
+	  try {
+	    lCp_snapshot.reset( new efscape::utils::MappedFile(lC_parmName.c_str()) );
+	  } catch (std::logic_error lC_excp) {
+	    LOG4CXX_ERROR(ModelHomeI::getLogger(), lC_excp.what());
+	  }
+	}
+
+	// builds a model from the input file, passing a model built from
+	// parameters the seed of its run as the property <seed>, and
+	// recording the lookahead declared for the components of a model built
+	// from a JSON model configuration
+	bool lb_seeded = (mb_seeded || mi_replications > 1);
+	std::function<DEVSPtr(std::uint64_t, LookaheadMap*)> lC_build =
+	  [&](std::uint64_t al_seed, LookaheadMap* aCp_lookaheads) -> DEVSPtr {
+	  DEVSPtr lCp_model;
+
+	  //--------------------------------------------------------------------
+	  // 2a. If this the input file is in JSON format:
+	  //     1. First attempt to load the input as a JSON model
+	  //        configuration (see buildModelFromJSON) or a JSON parameter
+	  //        file
+	  //     2. If the first attempt fails, attempt to load the input as a
+	  //        a cereal serialization of the model
+	  //--------------------------------------------------------------------
+	  if (lC_format == ".json") {
+	    if (lC_contents == "")
+	      return lCp_model;
+
+	    if ( lC_info.isObject() && lC_info["modelTypeName"].isString() ) {
+	      lCp_model = DEVSPtr( buildModelFromJSON(lC_info,
+						      aCp_lookaheads) );
+	    }
+	    else if ( lb_seeded && lC_info.isObject() &&
+		 lC_info.get("properties", Json::Value()).isObject() ) {
+	      Json::Value lC_parameters = lC_info;
+	      lC_parameters["properties"]["seed"] = Json::UInt64(al_seed);
+	      lCp_model =
+		Singleton<ModelHomeI>::Instance().
+		createModelFromParameters(lC_parameters);
+	    }
+	    else {
+	      lCp_model =
+		Singleton<ModelHomeI>::Instance().
+		createModelFromParameters(lC_info);
+	    }
+
 	    if (lCp_model == nullptr) {
 	      LOG4CXX_ERROR(ModelHomeI::getLogger(),
 			    "Attempt to load input file <"
@@ -224,21 +497,60 @@ namespace efscape {
 			    << "attempting to deserialize cereal JSON input");
 	      lCp_model =
 		Singleton<ModelHomeI>::Instance().
-		createModelFromJSON(buf.str());
+		createModelFromJSON(lC_contents);
 	    }
-
-	    // load parameter into a JSON value to be used later
-	    std::istringstream lC_buffer_in(buf.str());
-	    lC_buffer_in >> lC_info;
 	  }
-	}
+	  //--------------------------------------------------------------------
+	  // 2b. Otherwise, this should be am C++ xml serialization file
+	  //--------------------------------------------------------------------
+	  else if (lC_format == ".xml") {
+	    if (!lb_compressed)
+	      lCp_model = DEVSPtr( loadAdevsFromXML(lC_parmName.c_str()) );
+	    else if (lC_contents != "") {
+	      efscape::utils::ViewBuffer lC_view(lC_contents.data(),
+						 lC_contents.size());
+	      std::istream lC_buffer_in(&lC_view);
+	      lCp_model = DEVSPtr( loadAdevsFromXML(lC_buffer_in) );
+	    }
+	  }
+	  //--------------------------------------------------------------------
+	  // 2c. Or an efscape binary snapshot of the model
+	  //--------------------------------------------------------------------
+	  else if (lC_format == ".efb") {
+	    if (lCp_snapshot) {
+	      efscape::utils::ViewBuffer lC_view(lCp_snapshot->data(),
+						 lCp_snapshot->size());
+	      std::istream lC_buffer_in(&lC_view);
+	      lCp_model = loadAdevsFromBinary(lC_buffer_in);
+	    }
+	    else if (lC_contents != "") {
+	      efscape::utils::ViewBuffer lC_view(lC_contents.data(),
+						 lC_contents.size());
+	      std::istream lC_buffer_in(&lC_view);
+	      lCp_model = loadAdevsFromBinary(lC_buffer_in);
+	    }
+	  }
+
+	  return lCp_model;
+	};
+
 	//----------------------------------------------------------------------
-	// 2b. Otherwise, this should be am C++ xml serialization file
+	// 3. Run the replications of the simulation model
 	//----------------------------------------------------------------------
-	else if (p.extension().string() == ".xml") {
-	    lCp_model = DEVSPtr( loadAdevsFromXML(lC_parmName.c_str()) );
+	if (mi_replications > 1) {
+	  if (!mC_ringName.empty())
+	    LOG4CXX_WARN(ModelHomeI::getLogger(),
+			 "Replications are not published to shared memory "
+			 "(--shm)");
+	  return runReplications(lC_build, lC_parmName);
 	}
 
+	//----------------------------------------------------------------------
+	// 4. Otherwise, run the simulation model once
+	//----------------------------------------------------------------------
+	seedRandomEngine(ml_seed);
+	LookaheadMap lC_lookaheads;
+	DEVSPtr lCp_model = lC_build(ml_seed, &lC_lookaheads);
 	if (lCp_model == nullptr) {
 	  LOG4CXX_ERROR(ModelHomeI::getLogger(),
 			"Unable to create model from parameter file <"
@@ -246,99 +558,64 @@ namespace efscape {
 	  return EXIT_FAILURE;
 	}
 
-	//----------------------------------------------------------------------
-	// 3. Run the simulation model
-	//----------------------------------------------------------------------
-	// initialize the model first
-	adevs::Bag<IO_Type> xb;
-	IO_Type x("setup_in",
-		  "");
-	xb.insert(x);
-	inject_events(0., xb, lCp_model.get());
-	
-	
-      	// create simulator
-      	LOG4CXX_DEBUG(ModelHomeI::getLogger(),
-      		      "Creating simulator...");
-	
-      	adevs::Simulator<IO_Type> lCp_simulator(lCp_model.get() );
-
-      	LOG4CXX_DEBUG(ModelHomeI::getLogger(),
-      		      "Attempt to create simulation model successful!"
-      		      << "...Initializing simulation...");
-
-	// initialize the simulation clock
-	double ld_timeMax = adevs_inf<double>();
-	ClockIPtr lCp_clock;
-
-	SimRunner* lCp_SimRunner = // note: alternative root model
-	  dynamic_cast<SimRunner*>(lCp_model.get());
-
-	if (lCp_SimRunner) {
-	  lCp_clock = lCp_SimRunner->getClockIPtr();
+	bool lb_restarted = false;
+	if (mb_restart) {
+	  DEVSPtr lCp_restored = restartModel(lCp_model);
+	  lb_restarted = (lCp_restored != lCp_model);
+	  lCp_model = lCp_restored;
 	}
 
-	if (lCp_clock.get() != NULL) {
-	  ld_timeMax = lCp_clock->timeMax();
-	  LOG4CXX_DEBUG(ModelHomeI::getLogger(),
-			"Simulator clock set for time interval ["
-			<< lCp_clock->time() << ","
-			<< lCp_clock->timeMax() << "], time delta = "
-			<< lCp_clock->timeDelta() << ", units = "
-			<< lCp_clock->units() << ", time units = "
-			<< lCp_clock->timeUnits());
-
-      	}
-	
-	//
-      	// simulate model until time max
-	//
-	
-	// select an output stream for simulation output 
+	// select an output stream for simulation output (appended to, if the
+	// run was restarted)
 	std::streambuf * buf;
 	std::ofstream of;
 	if (out_file() != "") {
-	  of.open(out_file());
+	  of.open(out_file(), std::ios::out | std::ios::binary |
+		(lb_restarted ? std::ios::app : std::ios::trunc));
 	  buf = of.rdbuf();
 	} else {
 	  buf = std::cout.rdbuf();
 	}
 	std::ostream lC_out(buf);
-	
-	double ld_time = 0.;
-      	while ( (ld_time = lCp_simulator.nextEventTime())
-      		< ld_timeMax ) {
-      	  lCp_simulator.execNextEvent();
-
-	  // 
-	  adevs::Bag<IO_Type> xb;
-	  get_output(xb, lCp_model.get());
-	  // adevs::Bag<IO_Type>::iterator i = xb.begin();
-	  for (auto i : xb) {
-	    try {
-	      Json::Value lC_messages =
-		boost::any_cast<Json::Value>( i.value );
-	      lC_out << lC_messages << std::endl;
-	    }
-	    catch(const boost::bad_any_cast &) {
-	      ;
-	    }
-	  }
-      	}
 
-	//
-	// adevs::Bag<IO_Type> xb;
-	get_output(xb, lCp_model.get());;
-	for (auto i : xb) {
-	  try {
-	    Json::Value lC_messages =
-	      boost::any_cast<Json::Value>( i.value );
-	    lC_out << lC_messages << std::endl;
-	  }
-	  catch(const boost::bad_any_cast &) {
-	    ;
+	if (!mC_branchFile.empty()) {
+	  if (!mC_ringName.empty())
+	    LOG4CXX_WARN(ModelHomeI::getLogger(),
+			 "Branched runs are not published to shared memory "
+			 "(--shm)");
+	  return runBranches(lCp_model, lC_parmName, lC_out);
+	}
+
+	// also publish the output to a shared-memory ring (if requested)
+	std::unique_ptr<efscape::utils::SharedRingWriter> lCp_ring;
+	if (!mC_ringName.empty()) {
+	  lCp_ring.reset(new efscape::utils::SharedRingWriter
+			 (mC_ringName, mi_ringSize << 20));
+	  LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+			"Publishing output to shared memory ring <"
+			<< mC_ringName << ">");
+	}
+	mCp_ring = lCp_ring.get();
+
+	// numeric output may be written as columns (.efc)
+	try {
+	  if (is_column_file(out_file())) {
+	    ColumnWriter lC_columns(lC_out, lb_restarted);
+	    runModel(lCp_model, mi_threads, lC_columns, &lC_lookaheads);
 	  }
-	}	
+	  else
+	    runModel(lCp_model, mi_threads, lC_out, &lC_lookaheads);
+	}
+	catch (...) {
+	  mCp_ring = NULL;
+	  throw;
+	}
+	mCp_ring = NULL;
+
+	if (lCp_ring && lCp_ring->dropped() > 0)
+	  LOG4CXX_WARN(ModelHomeI::getLogger(),
+		       lCp_ring->dropped() << " output records were too large "
+		       "for the shared memory ring and were not published");
       }
       catch(std::logic_error lC_excp) {
       	LOG4CXX_ERROR(ModelHomeI::getLogger(),
@@ -360,6 +637,574 @@ namespace efscape {
 
     } // RunSim::execute()
 
+    /**
+     * Runs a simulation model until the end time of its clock, passing the
+     * output of each step and of the final model state to a sink.
+     *
+     * @param aCr_model root model
+     * @param ai_threads number of threads for the parallel simulator
+     * @param aCr_sink receives each output value
+     * @param aCp_lookaheads lookahead declared for components (optional)
+     * @throws std::logic_error
+     */
+    void RunSim::runModel(const DEVSPtr& aCr_model, unsigned int ai_threads,
+			  const OutputSink& aCr_sink,
+			  const LookaheadMap* aCp_lookaheads)
+    {
+      SimRunner* lCp_SimRunner = // note: alternative root model
+	dynamic_cast<SimRunner*>(aCr_model.get());
+
+      // the parallel simulators drive the model wrapped by a SimRunner
+      // directly, since the wrapper runs its own sequential simulator
+      DEVS* lCp_simModel = aCr_model.get();
+      if ((ai_threads > 1 || mi_partitions > 1) && lCp_SimRunner &&
+	  lCp_SimRunner->getWrappedModel().get() != NULL) {
+	lCp_simModel = lCp_SimRunner->getWrappedModel().get();
+	LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+		      "Unwrapping the SimRunner root model");
+      }
+
+      // flattened index of the atomic models: the model structure is fixed
+      // for the run, so the hierarchy is only traversed once
+      AtomicIndex lC_atomics(lCp_simModel);
+
+      // initialize the model first (unless it is a session restored after
+      // it was set up)
+      if ( !(lCp_SimRunner && lCp_SimRunner->timeOrigin() > 0.) ) {
+	adevs::Bag<IO_Type> xb;
+	IO_Type x("setup_in",
+		  "");
+	xb.insert(x);
+	inject_events(0., xb, lC_atomics);
+      }
+
+      // initialize the simulation clock
+      double ld_timeMax = adevs_inf<double>();
+      ClockIPtr lCp_clock;
+
+      if (lCp_SimRunner) {
+	lCp_clock = lCp_SimRunner->getClockIPtr();
+      }
+
+      if (lCp_clock.get() != NULL) {
+	// simulators count time from the (re)start of the session
+	ld_timeMax = lCp_clock->timeMax() - lCp_SimRunner->timeOrigin();
+	LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+		      "Simulator clock set for time interval ["
+		      << lCp_clock->time() << ","
+		      << lCp_clock->timeMax() << "], time delta = "
+		      << lCp_clock->timeDelta() << ", units = "
+		      << lCp_clock->units() << ", time units = "
+		      << lCp_clock->timeUnits());
+
+      }
+
+      // capture the output the simulator produces at each step, rather
+      // than polling the output function of every atomic model
+      OutputCollector lC_output(lCp_simModel, mb_rootOnly);
+      lC_output.setFilter(&mC_ports);
+
+      // decimate/aggregate the output before it reaches the sink
+      std::unique_ptr<OutputReducer> lCp_reducer;
+      if (!mC_reducers.isNull())
+	lCp_reducer.reset(new OutputReducer(mC_reducers, aCr_sink));
+      OutputSink lC_sink =
+	shifted_sink(lCp_SimRunner ? lCp_SimRunner->timeOrigin() : 0.,
+		     reduced_sink(lCp_reducer.get(), aCr_sink));
+      double ld_timeLast = 0.;
+
+      // the partitions only reach a common, consistent state (with no
+      // messages in transit between them) at the end of the run, so the
+      // partitioned simulators do not checkpoint the session
+      if (mi_partitions > 1 && lCp_simModel->typeIsNetwork() &&
+	  lCp_SimRunner && lCp_SimRunner->getCheckpointWriter())
+	LOG4CXX_WARN(ModelHomeI::getLogger(),
+		     "Checkpoints are not written with --partitions");
+
+      // create simulator
+      LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+		    "Creating simulator...");
+
+      if (mi_partitions > 1 && lCp_simModel->typeIsNetwork() &&
+	  mb_optimistic) {
+	TimeWarpSimulator lC_simulator(lCp_simModel, mi_partitions);
+	lC_simulator.setEndTime(ld_timeMax);
+	LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+		      "Running the Time Warp simulator with "
+		      << lC_simulator.numPartitions() << " partitions");
+	ld_timeLast =
+	  simulate(lC_simulator, ld_timeMax, lC_output, NULL, lC_sink);
+	LOG4CXX_INFO(ModelHomeI::getLogger(),
+		     "Time Warp simulation: "
+		     << lC_simulator.numProcessed() << " transitions, "
+		     << lC_simulator.numRolledBack() << " rolled back by "
+		     << lC_simulator.numRollbacks() << " rollbacks, "
+		     << lC_simulator.numAntiMessages() << " anti-messages, "
+		     << "efficiency = " << lC_simulator.efficiency());
+      }
+      else if (mi_partitions > 1 && lCp_simModel->typeIsNetwork()) {
+	PartitionedSimulator lC_simulator(lCp_simModel, mi_partitions,
+					  aCp_lookaheads);
+	lC_simulator.setEndTime(ld_timeMax);
+	LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+		      "Running the partitioned simulator with "
+		      << lC_simulator.numPartitions() << " partitions");
+	ld_timeLast =
+	  simulate(lC_simulator, ld_timeMax, lC_output, NULL, lC_sink);
+	LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+		      "Partitioned simulation: "
+		      << lC_simulator.numWindows() << " windows, "
+		      << lC_simulator.numSteps() << " synchronized steps");
+      }
+      else if (ai_threads > 1) {
+	ParallelSimulator lC_simulator(lCp_simModel, ai_threads);
+	// track the models changed between (incremental) checkpoints
+	if (lCp_simModel != aCr_model.get() && lCp_SimRunner->getDirtySet())
+	  lC_simulator.addEventListener(lCp_SimRunner->getDirtySet());
+	LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+		      "Running the parallel simulator with "
+		      << lC_simulator.numThreads() << " threads on "
+		      << lC_simulator.numAtomics() << " atomic models");
+	ld_timeLast =
+	  simulate(lC_simulator, ld_timeMax, lC_output,
+		   (lCp_simModel != aCr_model.get() ? lCp_SimRunner : NULL),
+		   lC_sink);
+      }
+      else {
+	adevs::Simulator<IO_Type> lC_simulator(lCp_simModel);
+	ld_timeLast =
+	  simulate(lC_simulator, ld_timeMax, lC_output, NULL, lC_sink);
+      }
+
+      // finally, write out the output of the final model state (polled
+      // from the atomic models, which are not on the root's ports if the
+      // root is a network)
+      adevs::Bag<IO_Type> yb;
+      if ( !(mb_rootOnly && lCp_simModel->typeIsNetwork()) )
+	get_output(yb, lC_atomics);
+      for (const auto& i : yb)
+	if (mC_ports.accepts(i.port))
+	  lC_sink(i, ld_timeLast);
+
+      // pass on the windows of the reducers that are still open
+      if (lCp_reducer)
+	lCp_reducer->flush();
+
+    } // RunSim::runModel(const DEVSPtr&, unsigned int, const OutputSink&)
+
+    /**
+     * Runs a simulation model until the end time of its clock, writing out
+     * the JSON output of each step and of the final model state (one
+     * compact value per line). The output is written on a background
+     * thread, and flushed at each checkpoint of the run and at its end.
+     *
+     * @param aCr_model root model
+     * @param ai_threads number of threads for the parallel simulator
+     * @param aCr_out output stream
+     * @param aCp_lookaheads lookahead declared for components (optional)
+     * @throws std::logic_error
+     */
+    void RunSim::runModel(const DEVSPtr& aCr_model, unsigned int ai_threads,
+			  std::ostream& aCr_out,
+			  const LookaheadMap* aCp_lookaheads)
+    {
+      OutputWriter lC_writer(aCr_out);
+      runModel(aCr_model, ai_threads, json_sink(lC_writer),
+	       [&lC_writer]() { lC_writer.flush(); }, aCp_lookaheads);
+
+    } // RunSim::runModel(const DEVSPtr&, unsigned int, std::ostream&)
+
+    /**
+     * Runs a simulation model until the end time of its clock, writing out
+     * its numeric output as columnar time series (see ColumnWriter). The
+     * columns are flushed at each checkpoint of the run and at its end.
+     *
+     * @param aCr_model root model
+     * @param ai_threads number of threads for the parallel simulator
+     * @param aCr_columns column writer
+     * @param aCp_lookaheads lookahead declared for components (optional)
+     * @throws std::logic_error
+     */
+    void RunSim::runModel(const DEVSPtr& aCr_model, unsigned int ai_threads,
+			  ColumnWriter& aCr_columns,
+			  const LookaheadMap* aCp_lookaheads)
+    {
+      runModel(aCr_model, ai_threads, column_sink(aCr_columns),
+	       [&aCr_columns]() { aCr_columns.flush(); }, aCp_lookaheads);
+
+      if (aCr_columns.skipped() > 0)
+	LOG4CXX_WARN(ModelHomeI::getLogger(),
+		     aCr_columns.skipped() << " output values were not "
+		     "numeric and were not written to the columns");
+
+    } // RunSim::runModel(const DEVSPtr&, unsigned int, ColumnWriter&)
+
+    /**
+     * Runs a simulation model until the end time of its clock, passing its
+     * output to a sink that is flushed at each checkpoint of the run (so
+     * that the output is consistent with the checkpoint) and at its end.
+     *
+     * @param aCr_model root model
+     * @param ai_threads number of threads for the parallel simulator
+     * @param aCr_sink receives each output value
+     * @param aCr_flush flushes the output of the sink
+     * @param aCp_lookaheads lookahead declared for components (optional)
+     * @throws std::logic_error
+     */
+    void RunSim::runModel(const DEVSPtr& aCr_model, unsigned int ai_threads,
+			  const OutputSink& aCr_sink,
+			  const std::function<void()>& aCr_flush,
+			  const LookaheadMap* aCp_lookaheads)
+    {
+      SimRunner* lCp_SimRunner = dynamic_cast<SimRunner*>(aCr_model.get());
+      std::shared_ptr<CheckpointWriter> lCp_checkpoints;
+      if (lCp_SimRunner)
+	lCp_checkpoints = lCp_SimRunner->getCheckpointWriter();
+      if (lCp_checkpoints)
+	lCp_checkpoints->setListener([&aCr_flush](unsigned long) {
+	    aCr_flush();
+	  });
+
+      try {
+	runModel(aCr_model, ai_threads, ring_sink(mCp_ring, aCr_sink),
+		 aCp_lookaheads);
+      }
+      catch (...) {
+	if (lCp_checkpoints)
+	  lCp_checkpoints->setListener(nullptr);
+	throw;
+      }
+
+      if (lCp_checkpoints)
+	lCp_checkpoints->setListener(nullptr);
+      aCr_flush();
+
+    } // RunSim::runModel(const DEVSPtr&, unsigned int, const OutputSink&, ...)
+
+    /**
+     * Restores a simulation session from its latest checkpoint. The
+     * checkpoints of the session are configured by the model that was
+     * built from the parameter file, which keeps writing them after the
+     * restart.
+     *
+     * @param aCr_model root model built from the parameter file
+     * @returns the restored root model (or the model built from the
+     *          parameter file, if there is no checkpoint)
+     * @throws std::logic_error if the latest checkpoint cannot be restored
+     */
+    DEVSPtr RunSim::restartModel(const DEVSPtr& aCr_model)
+    {
+      SimRunner* lCp_SimRunner = dynamic_cast<SimRunner*>(aCr_model.get());
+      if (lCp_SimRunner == NULL || !lCp_SimRunner->getCheckpointWriter()) {
+	LOG4CXX_WARN(ModelHomeI::getLogger(),
+		     "The model has no checkpoints: starting from the "
+		     "beginning");
+	return aCr_model;
+      }
+
+      std::shared_ptr<CheckpointWriter> lCp_checkpoints =
+	lCp_SimRunner->getCheckpointWriter();
+      unsigned long ll_sequence = 0;
+      std::string lC_latest = lCp_checkpoints->latest(&ll_sequence);
+      if (lC_latest.empty()) {
+	LOG4CXX_INFO(ModelHomeI::getLogger(),
+		     "No checkpoint found: starting from the beginning");
+	return aCr_model;
+      }
+
+      DEVSPtr lCp_model = CheckpointWriter::restore(lC_latest);
+      SimRunner* lCp_restored = dynamic_cast<SimRunner*>(lCp_model.get());
+      if (lCp_restored == NULL)
+	throw std::logic_error("Unable to restore a simulation session from "
+			       "checkpoint <" + lC_latest + ">");
+
+      lCp_checkpoints->resume(ll_sequence, lCp_restored->timeOrigin());
+      lCp_restored->setCheckpointWriter(lCp_checkpoints);
+
+      LOG4CXX_INFO(ModelHomeI::getLogger(),
+		   "Restarting from checkpoint <" << lC_latest
+		   << "> at time " << lCp_restored->timeOrigin());
+
+      return lCp_model;
+
+    } // RunSim::restartModel(const DEVSPtr&)
+
+    /**
+     * Runs the replications of a simulation model concurrently on the
+     * thread pool. Each replication builds its own model, draws its random
+     * numbers from its own stream, and writes its output to its own file,
+     * named after the output file (or the parameter file) with the
+     * replication number appended.
+     *
+     * @param aCr_build builds the model of a replication from its seed
+     * @param aCr_parmName name of the parameter file
+     * @returns exit state
+     */
+    int RunSim::runReplications(const std::function<DEVSPtr(std::uint64_t,
+							     LookaheadMap*)>&
+				aCr_build,
+				const std::string& aCr_parmName)
+    {
+      fs::path lC_outPath =
+	( out_file() != "" ? fs::path( out_file() ) :
+	  fs::path( fs::path(aCr_parmName).stem().string() + "-out.json" ) );
+      std::string lC_stem =
+	(lC_outPath.parent_path() / lC_outPath.stem()).string();
+      std::string lC_extension = lC_outPath.extension().string();
+      int li_width = std::to_string(mi_replications - 1).size();
+
+      efscape::utils::ThreadPool lC_pool(mi_threads);
+      LOG4CXX_INFO(ModelHomeI::getLogger(),
+		   "Running " << mi_replications << " replications of <"
+		   << aCr_parmName << "> on " << lC_pool.size()
+		   << " threads");
+
+      // models are built through the model factory and the serialization
+      // registries, which are shared, so they are built one at a time
+      // while the simulations themselves run concurrently
+      std::mutex lC_buildMutex;
+      std::atomic<unsigned int> li_failures(0);
+
+      lC_pool.parallel_for
+	(mi_replications,
+	 [&](std::size_t ai_replication) {
+	  std::uint64_t ll_seed = replicationSeed(ml_seed, ai_replication);
+	  std::ostringstream lC_tag;
+	  lC_tag << std::setfill('0') << std::setw(li_width) << ai_replication;
+	  std::ostringstream lC_name;
+	  lC_name << lC_stem << '-' << lC_tag.str() << lC_extension;
+
+	  try {
+	    // the model and the simulation share the stream of this thread
+	    seedRandomEngine(ll_seed);
+
+	    DEVSPtr lCp_model;
+	    LookaheadMap lC_lookaheads;
+	    {
+	      std::lock_guard<std::mutex> lC_lock(lC_buildMutex);
+	      lCp_model = aCr_build(ll_seed, &lC_lookaheads);
+	    }
+	    if (lCp_model == nullptr)
+	      throw std::logic_error("Unable to create model from parameter "
+				     "file <" + aCr_parmName + ">");
+
+	    // each replication writes (and prunes) its own checkpoints
+	    SimRunner* lCp_SimRunner = dynamic_cast<SimRunner*>(lCp_model.get());
+	    if (lCp_SimRunner && lCp_SimRunner->getCheckpointWriter()) {
+	      Json::Value lC_policy =
+		lCp_SimRunner->getCheckpointWriter()->toJSON();
+	      lC_policy["path"] = replication_path(lC_policy["path"].asString(),
+						   lC_tag.str());
+	      lCp_SimRunner->
+		setCheckpointWriter(std::make_shared<CheckpointWriter>
+				    (lC_policy));
+	    }
+
+	    std::ofstream lC_out(lC_name.str().c_str(),
+				 std::ios::out | std::ios::binary);
+	    if (is_column_file(lC_name.str())) {
+	      ColumnWriter lC_columns(lC_out);
+	      runModel(lCp_model, 1, lC_columns, &lC_lookaheads);
+	    }
+	    else
+	      runModel(lCp_model, 1, lC_out, &lC_lookaheads);
+
+	    LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+			  "Replication " << ai_replication << " (seed "
+			  << ll_seed << ") written to <" << lC_name.str()
+			  << ">");
+	  }
+	  catch(std::exception& lC_excp) {
+	    ++li_failures;
+	    LOG4CXX_ERROR(ModelHomeI::getLogger(),
+			  "Replication " << ai_replication << " failed: "
+			  << lC_excp.what());
+	  }
+	});
+
+      return (li_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+
+    } // RunSim::runReplications(...)
+
+    /**
+     * Runs a simulation model up to a branch time, then branches it into
+     * variants that each receive their own properties on the
+     * <properties_in> port of the root model and run until the end time of
+     * its clock. Each variant runs in a child process forked from the run
+     * at the branch time (see efscape::utils::ForkRunner), so the state of
+     * the model is shared copy-on-write instead of being cloned. The output
+     * up to the branch time is written to the output stream, and the output
+     * of each variant to its own file, named after the output file (or the
+     * parameter file) with the variant number appended.
+     *
+     * Variants are run on the sequential adevs simulator.
+     *
+     * @param aCr_model root model
+     * @param aCr_parmName name of the parameter file
+     * @param aCr_out output stream
+     * @returns exit state
+     * @throws std::logic_error if the branch file is invalid
+     */
+    int RunSim::runBranches(const DEVSPtr& aCr_model,
+			    const std::string& aCr_parmName,
+			    std::ostream& aCr_out)
+    {
+      //----------------------------------------------------------------------
+      // 1. read the branches: {"time": t, "variants": [properties, ...]}
+      //----------------------------------------------------------------------
+      Json::Value lC_branches;
+      {
+	std::ifstream lC_in(mC_branchFile.c_str());
+	if (!lC_in)
+	  throw std::logic_error("Unable to open branch file <"
+				 + mC_branchFile + ">");
+	lC_in >> lC_branches;
+      }
+      const Json::Value& lC_variants = lC_branches["variants"];
+      if (!lC_branches["time"].isNumeric() || !lC_variants.isArray() ||
+	  lC_variants.empty())
+	throw std::logic_error("Branch file <" + mC_branchFile + "> has no "
+			       "<time> or no <variants>");
+
+      if (mi_threads > 1 || mi_partitions > 1)
+	LOG4CXX_WARN(ModelHomeI::getLogger(),
+		     "Branches are run on the sequential simulator");
+      if (is_column_file(out_file()))
+	LOG4CXX_WARN(ModelHomeI::getLogger(),
+		     "The output of branches is written as JSON");
+
+      //----------------------------------------------------------------------
+      // 2. run the model up to the branch time
+      //----------------------------------------------------------------------
+      SimRunner* lCp_SimRunner = dynamic_cast<SimRunner*>(aCr_model.get());
+      AtomicIndex lC_atomics(aCr_model.get());
+
+      if ( !(lCp_SimRunner && lCp_SimRunner->timeOrigin() > 0.) ) {
+	adevs::Bag<IO_Type> xb;
+	IO_Type x("setup_in",
+		  "");
+	xb.insert(x);
+	inject_events(0., xb, lC_atomics);
+      }
+
+      double ld_timeOrigin = 0.;
+      double ld_timeMax = adevs_inf<double>();
+      if (lCp_SimRunner && lCp_SimRunner->getClockIPtr().get() != NULL) {
+	ld_timeOrigin = lCp_SimRunner->timeOrigin();
+	ld_timeMax = lCp_SimRunner->getClockIPtr()->timeMax() - ld_timeOrigin;
+      }
+      double ld_branchTime =
+	std::min(lC_branches["time"].asDouble() - ld_timeOrigin, ld_timeMax);
+
+      // output is written synchronously: the writer thread would not
+      // exist in the children
+      OutputCollector lC_output(aCr_model.get(), mb_rootOnly);
+      lC_output.setFilter(&mC_ports);
+      std::unique_ptr<OutputReducer> lCp_reducer;
+      if (!mC_reducers.isNull())
+	lCp_reducer.reset(new OutputReducer(mC_reducers, OutputSink()));
+      adevs::Simulator<IO_Type> lC_simulator(aCr_model.get());
+      {
+	OutputWriter lC_writer(aCr_out, false);
+	if (lCp_reducer)
+	  lCp_reducer->setSink(json_sink(lC_writer));
+	simulate(lC_simulator, ld_branchTime, lC_output, NULL,
+		 shifted_sink(ld_timeOrigin,
+			      reduced_sink(lCp_reducer.get(),
+					   json_sink(lC_writer))));
+      }
+
+      // nothing pending may be copied into the children
+      aCr_out.flush();
+      std::cout.flush();
+      std::cerr.flush();
+      if (lCp_SimRunner && lCp_SimRunner->getCheckpointWriter())
+	lCp_SimRunner->getCheckpointWriter()->wait();
+
+      //----------------------------------------------------------------------
+      // 3. run each variant from the state at the branch time
+      //----------------------------------------------------------------------
+      static const PortType lC_propertiesPort("properties_in");
+
+      efscape::utils::ForkRunner
+	lC_runner(mC_variable_map.count("threads") ? mi_threads : 0);
+      LOG4CXX_INFO(ModelHomeI::getLogger(),
+		   "Branching <" << aCr_parmName << "> into "
+		   << lC_variants.size() << " variants at time "
+		   << ld_timeOrigin + ld_branchTime << " ("
+		   << lC_runner.processes() << " processes)");
+
+      std::vector<std::string> lC1_output =
+	lC_runner.run
+	(lC_variants.size(),
+	 [&](std::size_t ai_variant, std::ostream& aCr_variantOut) {
+	  // checkpoints are only written by the run that is branched
+	  if (lCp_SimRunner)
+	    lCp_SimRunner->setCheckpointWriter(nullptr);
+
+	  adevs::Bag< adevs::Event<IO_Type> > lC_input;
+	  lC_input.insert
+	    ( adevs::Event<IO_Type>
+	      (aCr_model.get(),
+	       IO_Type(lC_propertiesPort,
+		       lC_variants[Json::ArrayIndex(ai_variant)])) );
+	  if (ld_branchTime < ld_timeMax)
+	    lC_simulator.computeNextState(lC_input, ld_branchTime);
+
+	  // the windows of the reducers that are open at the branch time
+	  // are continued by each variant
+	  OutputWriter lC_writer(aCr_variantOut, false);
+	  if (lCp_reducer)
+	    lCp_reducer->setSink(json_sink(lC_writer));
+	  OutputSink lC_sink =
+	    shifted_sink(ld_timeOrigin,
+			 reduced_sink(lCp_reducer.get(), json_sink(lC_writer)));
+	  double ld_timeLast =
+	    std::max(ld_branchTime,
+		     advance(lC_simulator, ld_timeMax, lC_output, NULL,
+			     lC_sink));
+
+	  adevs::Bag<IO_Type> yb;
+	  if ( !(mb_rootOnly && aCr_model->typeIsNetwork()) )
+	    get_output(yb, lC_atomics);
+	  for (const auto& i : yb)
+	    if (mC_ports.accepts(i.port))
+	      lC_sink(i, ld_timeLast);
+	  if (lCp_reducer)
+	    lCp_reducer->flush();
+	  lC_writer.flush();
+	});
+
+      //----------------------------------------------------------------------
+      // 4. write out the output of each variant
+      //----------------------------------------------------------------------
+      fs::path lC_outPath =
+	( out_file() != "" ? fs::path( out_file() ) :
+	  fs::path( fs::path(aCr_parmName).stem().string() + "-out.json" ) );
+      std::string lC_stem =
+	(lC_outPath.parent_path() / lC_outPath.stem()).string();
+      std::string lC_extension = lC_outPath.extension().string();
+      int li_width = std::to_string(lC_variants.size() - 1).size();
+
+      for (std::size_t i = 0; i < lC1_output.size(); i++) {
+	if (lC_runner.status()[i] != 0) {
+	  LOG4CXX_ERROR(ModelHomeI::getLogger(),
+			"Variant " << i << " failed (status "
+			<< lC_runner.status()[i] << ")");
+	  continue;
+	}
+
+	std::ostringstream lC_name;
+	lC_name << lC_stem << "-branch-" << std::setfill('0')
+		<< std::setw(li_width) << i << lC_extension;
+	std::ofstream lC_file(lC_name.str().c_str());
+	lC_file << lC1_output[i];
+      }
+
+      return (lC_runner.failures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+
+    } // RunSim::runBranches(...)
+
     /**
      * Parses the command line arguments and initializes the command
      * configuration.
@@ -379,6 +1224,69 @@ namespace efscape {
 	return 1;
       }
 
+      mb_rootOnly = (mC_variable_map.count("root-only") > 0);
+      mb_optimistic = (mC_variable_map.count("optimistic") > 0);
+      mb_restart = (mC_variable_map.count("restart") > 0);
+
+      if (mC_variable_map.count("ports")) {
+	mC_ports = PortFilter::parse(mC_variable_map["ports"].as<std::string>());
+	LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+		      "Writing output on " << mC_ports.size() << " ports");
+      }
+
+      if (mC_variable_map.count("reduce")) {
+	std::string lC_reduceFile = mC_variable_map["reduce"].as<std::string>();
+	std::ifstream lC_in(lC_reduceFile.c_str());
+	if (!lC_in || !(lC_in >> mC_reducers) || !mC_reducers.isObject()) {
+	  std::cerr << program_name() << ": unable to read the output "
+		    << "reducers in <" << lC_reduceFile << ">\n";
+	  return 1;
+	}
+      }
+
+      if (mC_variable_map.count("branch"))
+	mC_branchFile = mC_variable_map["branch"].as<std::string>();
+
+      if (mC_variable_map.count("shm"))
+	mC_ringName = mC_variable_map["shm"].as<std::string>();
+
+      if (mC_variable_map.count("shm-size")) {
+	mi_ringSize = mC_variable_map["shm-size"].as<std::size_t>();
+	if (mi_ringSize == 0)
+	  mi_ringSize = 1;
+      }
+
+      if (mC_variable_map.count("seed")) {
+	ml_seed = mC_variable_map["seed"].as<std::uint64_t>();
+	mb_seeded = true;
+      }
+
+      if (mC_variable_map.count("replications")) {
+	mi_replications = mC_variable_map["replications"].as<unsigned int>();
+	if (mi_replications == 0)
+	  mi_replications = 1;
+      }
+
+      if (mC_variable_map.count("threads")) {
+	mi_threads = mC_variable_map["threads"].as<unsigned int>();
+	if (mi_threads == 0)
+	  mi_threads = 1;
+      }
+
+      if (mC_variable_map.count("partitions")) {
+	mi_partitions = mC_variable_map["partitions"].as<unsigned int>();
+	if (mi_partitions == 0)
+	  mi_partitions = 1;
+      }
+
+      // the worker threads of the partitioned simulators draw from their
+      // own random streams, not from the stream of the replication
+      if (mi_replications > 1 && mi_partitions > 1) {
+	std::cerr << program_name() << ": --replications and --partitions "
+		  << "cannot be combined\n";
+	return 1;
+      }
+
       return li_status;
     }
 
@@ -394,15 +1302,28 @@ namespace efscape {
 		<< "[-d] [-h] [-v]\n\t"
 		<< "[[-i] [input_file]]\n\t"
 		<< "[-o output_file]\n\t"
+		<< "[--root-only] [-t threads] [-p partitions [--optimistic]]\n\t"
+		<< "[-r replications] [--seed seed] [--restart]\n\t"
+		<< "[--branch branch_file] [--ports port,...]\n\t"
+		<< "[--reduce reducer_file] [--shm name [--shm-size MB]]\n\t"
 		<< "param_name\n\n"
 		<< "where [] indicates optional option:\n\n"
 		<< mC_description
 		<< "examples:\n\t\t"
 		<< program_name() << " param_name\n\t\t"
-		<< program_name() << " -d -o output_name param_name\n\n"
+		<< program_name() << " -d -o output_name param_name\n\t\t"
+		<< program_name() << " -r 500 -t 8 -o out.json param_name\n\n"
 		<< "If an input file is not specified, the user will be prompted"
 		<< " to select one of the available models, from which a valid"
-		<< " parameter file will be generated.\n";
+		<< " parameter file will be generated. The parameter name may"
+		<< " also be a model snapshot: a cereal JSON archive (.json),"
+		<< " a boost XML archive (.xml) or an efscape binary snapshot"
+		<< " (.efb), optionally compressed with gzip (.gz) or lz4"
+		<< " (.lz4), e.g. model.efb.lz4. Numeric output is written as"
+		<< " columns if the output file has the extension .efc (see"
+		<< " efcolumns). With --shm, the output of a single run is also"
+		<< " published to a shared-memory ring buffer, read live with"
+		<< " eftail.\n";
 
       exit( exit_value );
     }
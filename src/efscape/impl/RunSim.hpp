@@ -16,12 +16,24 @@
 #ifndef EFSCAPE_UTILS_RUNSIM_HH
 #define EFSCAPE_UTILS_RUNSIM_HH
 
+#include <efscape/impl/efscapelib.hpp>
+#include <efscape/impl/PortFilter.hpp>
 #include <efscape/utils/CommandOpt.hpp>
 
+#include <cstdint>
+#include <functional>
+
 namespace efscape {
 
+  namespace utils {
+    class SharedRingWriter;
+  }
+
   namespace impl {
 
+    // forward declarations
+    class ColumnWriter;
+
     /**
      * Implements a simple model simulation runner for the efscape modeling
      * framework. It provides a command-line interface derived from the
@@ -36,6 +48,21 @@ namespace efscape {
      * select one of the available models, from which a valid parameter file
      * will be generated.
      *
+     * With --replications, the model is built and run several times from
+     * one reading of the input file. Replications run concurrently on the
+     * threads, each with its own random number stream (see
+     * RandomStream.hpp), its own output file and its own checkpoints (the
+     * replication number is appended to the checkpoint path). Replications
+     * cannot be partitioned (--partitions), since the partitions would not
+     * draw from the stream of their replication.
+     *
+     * The output is written as JSON, one value per line, or, if the output
+     * file has the extension .efc, as columnar time series of the numeric
+     * values (see ColumnWriter and the command 'efcolumns'). With --shm,
+     * the output of a single run is also published to a shared-memory ring
+     * buffer (see SharedRingWriter and the command 'eftail'), from which
+     * local consumers read it live without slowing down the run.
+     *
      * @author Jon Cline <jon.c.cline@gmail.com>
      * @version 1.0.1 created 01 Feb 2008, revised 26 May 2018
      */
@@ -54,12 +81,89 @@ namespace efscape {
 
       static const char* ProgramName();
 
+      /** receives the output values of a simulation run, with their time */
+      typedef std::function<void(const IO_Type&, double)> OutputSink;
+
     protected:
 
       void usage( int exit_value = 0 );
 
+      void runModel(const DEVSPtr& aCr_model, unsigned int ai_threads,
+		    const OutputSink& aCr_sink,
+		    const LookaheadMap* aCp_lookaheads = NULL);
+
+      void runModel(const DEVSPtr& aCr_model, unsigned int ai_threads,
+		    std::ostream& aCr_out,
+		    const LookaheadMap* aCp_lookaheads = NULL);
+
+      void runModel(const DEVSPtr& aCr_model, unsigned int ai_threads,
+		    ColumnWriter& aCr_columns,
+		    const LookaheadMap* aCp_lookaheads = NULL);
+
+      void runModel(const DEVSPtr& aCr_model, unsigned int ai_threads,
+		    const OutputSink& aCr_sink,
+		    const std::function<void()>& aCr_flush,
+		    const LookaheadMap* aCp_lookaheads = NULL);
+
+      DEVSPtr restartModel(const DEVSPtr& aCr_model);
+
     private:
-      
+
+      int runReplications(const std::function<DEVSPtr(std::uint64_t,
+						       LookaheadMap*)>&
+			  aCr_build,
+			  const std::string& aCr_parmName);
+
+      int runBranches(const DEVSPtr& aCr_model,
+		      const std::string& aCr_parmName,
+		      std::ostream& aCr_out);
+
+    protected:
+
+      /** whether to write only output on the ports of the root model */
+      bool mb_rootOnly;
+
+      /** ports whose output is written (empty: all ports) */
+      PortFilter mC_ports;
+
+      /** output reducer of each port (null: none) */
+      Json::Value mC_reducers;
+
+      /** number of simulation threads (1: sequential adevs simulator) */
+      unsigned int mi_threads;
+
+      /** number of partitions (1: no partitioned simulation) */
+      unsigned int mi_partitions;
+
+      /** whether partitions run optimistically (Time Warp) */
+      bool mb_optimistic;
+
+      /** number of replications (run concurrently on the threads) */
+      unsigned int mi_replications;
+
+      /** base seed of the random number streams */
+      std::uint64_t ml_seed;
+
+      /** whether the seed was set on the command line */
+      bool mb_seeded;
+
+      /** whether to restart the run from its latest checkpoint */
+      bool mb_restart;
+
+      /** file of the variants to branch the run into (if any) */
+      std::string mC_branchFile;
+
+      /** shared-memory ring the output is also published to (if any) */
+      std::string mC_ringName;
+
+      /** capacity of the shared-memory ring in MB */
+      std::size_t mi_ringSize;
+
+      /** shared-memory ring of the current run (null: none) */
+      efscape::utils::SharedRingWriter* mCp_ring;
+
+    private:
+
       /** program name */
       static const char* mScp_program_name;
 
@@ -0,0 +1,392 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : RunSweep.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+// 
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+
+#include <efscape/impl/RunSweep.hpp>
+
+// definitions for accessing the model factory
+#include <efscape/impl/ModelHomeI.hpp>
+#include <efscape/impl/ModelHomeSingleton.hpp>
+
+#include <efscape/impl/RandomStream.hpp>
+#include <efscape/impl/RunFarm.hpp>
+#include <efscape/impl/Sweep.hpp>
+#include <efscape/utils/ThreadPool.hpp>
+
+// Include for handling JSON
+#include <json/json.h>
+
+#include <boost/mpi/collectives.hpp>
+#include <boost/serialization/string.hpp>
+
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+namespace efscape {
+
+  namespace impl {
+
+    namespace {
+
+      // reads a JSON file
+      Json::Value readJSON(const std::string& aCr_fileName)
+      {
+	std::ifstream lC_file(aCr_fileName.c_str());
+	if (!lC_file)
+	  throw std::logic_error("Unable to open file <" + aCr_fileName + ">");
+
+	Json::Value lC_value;
+	lC_file >> lC_value;
+	return lC_value;
+      }
+
+    } // namespace
+
+    // class variables
+    const char* RunSweep::mScp_program_name = "efsweep";
+    const char* RunSweep::mScp_program_version =
+      "version 0.1.0 (2026/10/17)";
+
+    /** default constructor */
+    RunSweep::RunSweep() {}
+
+    /** destructor */
+    RunSweep::~RunSweep() {}
+
+    /**
+     * Returns the program name
+     *
+     * @returns the program name
+     */
+    const char* RunSweep::program_name() {
+      return RunSweep::mScp_program_name;
+    }
+
+    /**
+     * Returns the program name (class version)
+     *
+     * @returns the program name
+     */
+    const char* RunSweep::ProgramName() {
+      return RunSweep::mScp_program_name;
+    }
+
+    /**
+     * Returns the program version.
+     *
+     * @returns the program version
+     */
+    const char* RunSweep::program_version() {
+      return RunSweep::mScp_program_version;
+    }
+
+    /**
+     * Executes the RunSweep command
+     *
+     * @returns exit state
+     */
+    int RunSweep::execute() {
+
+      // with more than one MPI rank, rank 0 farms the runs out to the
+      // other ranks
+      boost::mpi::communicator* lCp_world =
+	Singleton<ModelHomeI>::Instance().getCommunicator();
+      bool lb_farm = (lCp_world != NULL && lCp_world->size() > 1);
+      bool lb_master = (!lb_farm || lCp_world->rank() == 0);
+
+      try {
+	// set logging level
+	if (debug_on()) {
+	  ModelHomeI::getLogger()->setLevel(log4cxx::Level::getDebug());
+	}
+	else {
+	  ModelHomeI::getLogger()->setLevel(log4cxx::Level::getError());
+	}
+
+	LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+		      "Loading libraries");
+	Singleton<ModelHomeI>::Instance().LoadLibraries();
+
+	//----------------------------------------------------------------------
+	// 1. read the model parameters and expand the sweep specification
+	//    (without a sweep file, the runs are replications of the model)
+	//----------------------------------------------------------------------
+	std::string lC_parmName = (*this)[0];
+	Json::Value lC_parameters;
+	std::vector<Json::Value> lC1_points;
+	unsigned int li_replications = mi_replications;
+
+	if (lb_master) {
+	  std::string lC_setup;
+	  try {
+	    lC_parameters = readJSON(lC_parmName);
+
+	    Json::Value lC_spec;
+	    if (files() > 1)
+	      lC_spec = readJSON((*this)[1]);
+	    else {
+	      lC_spec["design"] = "list";
+	      lC_spec["points"].append(Json::Value(Json::objectValue));
+	    }
+
+	    lC1_points = expandSweep(lC_spec, ml_seed);
+
+	    if (mC_variable_map.count("replications") == 0)
+	      li_replications = lC_spec.get("replications",
+					    mi_replications).asUInt();
+	    if (li_replications == 0)
+	      li_replications = 1;
+
+	    if (lb_farm) {
+	      Json::Value lC_value;
+	      lC_value["parameters"] = lC_parameters;
+	      lC_value["replications"] = li_replications;
+	      for (const auto& i : lC1_points)
+		lC_value["points"].append(i);
+	      Json::StreamWriterBuilder lC_builder;
+	      lC_builder["indentation"] = "";
+	      lC_setup = Json::writeString(lC_builder, lC_value);
+	    }
+	  }
+	  catch(...) {
+	    // an empty setup stops the workers
+	    if (lb_farm)
+	      boost::mpi::broadcast(*lCp_world, lC_setup, 0);
+	    throw;
+	  }
+
+	  if (lb_farm)
+	    boost::mpi::broadcast(*lCp_world, lC_setup, 0);
+	}
+	else {
+	  // the workers receive the sweep from the master
+	  std::string lC_setup;
+	  boost::mpi::broadcast(*lCp_world, lC_setup, 0);
+	  if (lC_setup.empty())
+	    return EXIT_FAILURE;
+
+	  Json::Value lC_value;
+	  std::istringstream lC_buffer_in(lC_setup);
+	  lC_buffer_in >> lC_value;
+	  lC_parameters = lC_value["parameters"];
+	  li_replications = lC_value["replications"].asUInt();
+	  for (const auto& i : lC_value["points"])
+	    lC1_points.push_back(i);
+	}
+
+	std::size_t li_runs = lC1_points.size()*li_replications;
+
+	// makes run <ai_run>, returning whether it succeeded
+	std::mutex lC_buildMutex;
+	std::function<bool(std::size_t, RunValues&)> lC_run =
+	  [&](std::size_t ai_run, RunValues& aCr_values) -> bool {
+	  std::size_t li_point = ai_run/li_replications;
+	  std::uint64_t ll_seed = replicationSeed(ml_seed, ai_run);
+	  RunResult lC_result;
+
+	  try {
+	    seedRandomEngine(ll_seed);
+
+	    Json::Value lC_runParameters =
+	      applySweepPoint(lC_parameters, lC1_points[li_point]);
+	    if (lC_runParameters["properties"].isObject())
+	      lC_runParameters["properties"]["seed"] = Json::UInt64(ll_seed);
+
+	    // models are built through the model factory, which is shared,
+	    // so they are built one at a time
+	    DEVSPtr lCp_model;
+	    {
+	      std::lock_guard<std::mutex> lC_lock(lC_buildMutex);
+	      lCp_model =
+		Singleton<ModelHomeI>::Instance().
+		createModelFromParameters(lC_runParameters);
+	    }
+	    if (lCp_model == nullptr)
+	      throw std::logic_error("Unable to create model from parameter "
+				     "file <" + lC_parmName + ">");
+
+	    runModel(lCp_model, 1,
+		     [&lC_result](const IO_Type& aCr_value, double) {
+		       lC_result(aCr_value);
+		     });
+	  }
+	  catch(std::exception& lC_excp) {
+	    LOG4CXX_ERROR(ModelHomeI::getLogger(),
+			  "Run " << ai_run << " (point " << li_point
+			  << ") failed: " << lC_excp.what());
+	    return false;
+	  }
+
+	  aCr_values = lC_result.values();
+	  return true;
+	};
+
+	//----------------------------------------------------------------------
+	// 2. make the runs, summarizing the results of each point as the
+	//    runs complete
+	//----------------------------------------------------------------------
+	std::vector<RunSummary> lC1_summaries(lC1_points.size());
+
+	if (!lb_master) {
+	  runFarmWorker(*lCp_world, lC_run);
+	  return EXIT_SUCCESS;
+	}
+
+	if (lb_farm) {
+	  LOG4CXX_INFO(ModelHomeI::getLogger(),
+		       "Farming out " << li_runs << " runs of <"
+		       << lC_parmName << "> (" << lC1_points.size()
+		       << " points, " << li_replications
+		       << " replications) to "
+		       << lCp_world->size() - 1 << " workers");
+
+	  runFarmMaster(*lCp_world, li_runs,
+			[&](std::size_t ai_run, bool ab_succeeded,
+			    const RunValues& aCr_values) {
+			  RunSummary& lC_summary =
+			    lC1_summaries[ai_run/li_replications];
+			  if (ab_succeeded)
+			    lC_summary.add(aCr_values);
+			  else
+			    lC_summary.addFailure();
+			});
+	}
+	else {
+	  efscape::utils::ThreadPool lC_pool(mi_threads);
+	  LOG4CXX_INFO(ModelHomeI::getLogger(),
+		       "Making " << li_runs << " runs of <"
+		       << lC_parmName << "> (" << lC1_points.size()
+		       << " points, " << li_replications
+		       << " replications) on " << lC_pool.size()
+		       << " threads");
+
+	  std::mutex lC_summaryMutex;
+	  lC_pool.parallel_for
+	    (li_runs,
+	     [&](std::size_t ai_run) {
+	      RunValues lC_values;
+	      bool lb_succeeded = lC_run(ai_run, lC_values);
+
+	      std::lock_guard<std::mutex> lC_lock(lC_summaryMutex);
+	      RunSummary& lC_summary = lC1_summaries[ai_run/li_replications];
+	      if (lb_succeeded)
+		lC_summary.add(lC_values);
+	      else
+		lC_summary.addFailure();
+	    });
+	}
+
+	//----------------------------------------------------------------------
+	// 3. write out one row per parameter point
+	//----------------------------------------------------------------------
+	std::streambuf * buf;
+	std::ofstream of;
+	if (out_file() != "") {
+	  of.open(out_file());
+	  buf = of.rdbuf();
+	} else {
+	  buf = std::cout.rdbuf();
+	}
+	std::ostream lC_out(buf);
+
+	Json::StreamWriterBuilder lC_builder;
+	lC_builder["indentation"] = "";
+
+	unsigned int li_failures = 0;
+	for (std::size_t i = 0; i < lC1_points.size(); i++) {
+	  Json::Value lC_row = lC1_summaries[i].toJSON();
+	  lC_row["point"] = Json::UInt64(i);
+	  lC_row["properties"] = lC1_points[i];
+	  lC_out << Json::writeString(lC_builder, lC_row) << std::endl;
+	  li_failures += lC1_summaries[i].failures();
+	}
+
+	if (li_failures > 0) {
+	  LOG4CXX_ERROR(ModelHomeI::getLogger(),
+			li_failures << " of " << li_runs << " runs failed");
+	  return EXIT_FAILURE;
+	}
+      }
+      catch(std::exception& lC_excp) {
+	LOG4CXX_ERROR(ModelHomeI::getLogger(),
+		      lC_excp.what());
+	return EXIT_FAILURE;
+      }
+
+      return EXIT_SUCCESS;
+
+    } // RunSweep::execute()
+
+    /**
+     * Parses the command line arguments and initializes the command
+     * configuration.
+     *
+     * @param argc number of command line arguments
+     * @param argv vector of command line arguments
+     * @returns exit status
+     */
+    int RunSweep::parse_options(int argc, char *argv[]) {
+
+      int li_status = RunSim::parse_options(argc,argv);	// parent method
+      if (li_status != 0)
+	return li_status;
+
+      if (files() < 1) {
+	usage(1);
+	return 1;
+      }
+
+      return li_status;
+    }
+
+    /**
+     * Prints out usage message for this command/program
+     *
+     * @args  exit_value exit value
+     */
+    void RunSweep::usage( int exit_value )
+    {
+      std::cerr << "usage:\n"
+		<< program_name() << " "
+		<< "[-d] [-h] [-v]\n\t"
+		<< "[-o output_file]\n\t"
+		<< "[--root-only] [-t threads] [-p partitions [--optimistic]]\n\t"
+		<< "[-r replications] [--seed seed]\n\t"
+		<< "param_name [sweep_name]\n\n"
+		<< "where [] indicates optional option:\n\n"
+		<< mC_description
+		<< "examples:\n\t\t"
+		<< program_name() << " -t 8 -o summary.json param_name sweep_name"
+		<< "\n\t\t"
+		<< "mpirun -np 4 " << program_name()
+		<< " -r 500 -o summary.json param_name\n\n"
+		<< "The sweep file is a JSON object, for example:\n\t"
+		<< "{ \"design\": \"grid\", \"replications\": 10,\n\t"
+		<< "  \"parameters\": { \"genr_period\": [0.5, 1.0, 2.0],\n\t"
+		<< "    \"processing_period\": {\"min\": 1, \"max\": 3,"
+		<< " \"steps\": 5} } }\n"
+		<< "A Latin hypercube (\"design\": \"lhs\") samples each range"
+		<< " {\"min\", \"max\"} <samples> times; a list (\"design\": "
+		<< "\"list\") runs the objects in <points>. Without a sweep file,"
+		<< " the runs are replications of the model.\n\n"
+		<< "Launched on more than one MPI rank, rank 0 hands out the runs"
+		<< " to the other ranks one at a time.\n";
+
+      exit( exit_value );
+    }
+
+  } // namespace impl
+}   // namespace efscape
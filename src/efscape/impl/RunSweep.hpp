@@ -0,0 +1,80 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : RunSweep.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+// 
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_RUNSWEEP_HPP
+#define EFSCAPE_IMPL_RUNSWEEP_HPP
+
+#include <efscape/impl/RunSim.hpp>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Implements a parameter sweep (design of experiments) runner for the
+     * efscape modeling framework. The command 'efsweep' takes a model
+     * parameter file and a sweep specification (see expandSweep), expands
+     * the specification into parameter points, and runs each point for a
+     * number of replications. All runs are scheduled on one work-stealing
+     * thread pool, so long and short runs balance across the threads.
+     *
+     * The output of each run is reduced to a few numeric results (see
+     * RunResult), which are summarized by parameter point as the runs
+     * complete. One JSON row per parameter point is written out, holding
+     * the point number, its properties and its summary statistics.
+     *
+     * The simulator options of efdriver apply to each run; --threads sets
+     * the number of runs made concurrently. Without a sweep specification,
+     * the runs are --replications of the model.
+     *
+     * When the command is launched on more than one MPI rank (e.g. with
+     * 'mpirun -np 4 efsweep ...'), rank 0 reads the input, broadcasts it,
+     * and farms the runs out to the other ranks (see runFarmMaster), which
+     * make one run at a time and send back only its numeric results.
+     */
+    class RunSweep : public RunSim
+    {
+    public:
+
+      RunSweep();
+      virtual ~RunSweep();
+
+      int parse_options( int argc, char *argv[]);
+      int execute();
+
+      const char* program_name();
+      const char* program_version();
+
+      static const char* ProgramName();
+
+    protected:
+
+      void usage( int exit_value = 0 );
+
+    private:
+
+      /** program name */
+      static const char* mScp_program_name;
+
+      /** program version */
+      static const char* mScp_program_version;
+
+    };
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_RUNSWEEP_HPP
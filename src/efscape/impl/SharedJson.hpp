@@ -0,0 +1,113 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : SharedJson.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_SHAREDJSON_HPP
+#define EFSCAPE_IMPL_SHAREDJSON_HPP
+
+// jsoncpp library definitions
+#include <json/json.h>
+
+#include <iosfwd>
+#include <memory>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Implements a reference-counted, immutable JSON document for use as a
+     * port value. Copying a SharedJson only copies a handle, so an output
+     * document built once by a model can travel through output bags,
+     * routing, simulator listeners and serializers without being
+     * deep-copied. A private, writable copy of the document is made only
+     * when mutableValue() is called on a handle that is not the sole owner
+     * (copy-on-write).
+     */
+    class SharedJson
+    {
+    public:
+
+      /** default constructor (null document) */
+      SharedJson() : mCp_value(nullDocument()) {}
+
+      /**
+       * constructor: copies the document once
+       *
+       * @param aCr_value JSON document
+       */
+      explicit SharedJson(const Json::Value& aCr_value) :
+	mCp_value(std::make_shared<Json::Value>(aCr_value)) {}
+
+      /**
+       * constructor: takes over the contents of the document without
+       * copying it, leaving the source null
+       *
+       * @param aCr_value JSON document
+       */
+      explicit SharedJson(Json::Value&& aCr_value) :
+	mCp_value(std::make_shared<Json::Value>())
+      {
+	mCp_value->swap(aCr_value);
+      }
+
+      /** @returns the shared document */
+      const Json::Value& get() const { return *mCp_value; }
+
+      const Json::Value& operator*() const { return *mCp_value; }
+      const Json::Value* operator->() const { return mCp_value.get(); }
+
+      /**
+       * Returns a writable reference to the document, first detaching this
+       * handle with a private copy if the document is shared.
+       *
+       * @returns writable document
+       */
+      Json::Value& mutableValue() {
+	if (mCp_value.use_count() != 1)
+	  mCp_value = std::make_shared<Json::Value>(*mCp_value);
+	return *mCp_value;
+      }
+
+      /** @returns whether the document is null */
+      bool isNull() const { return mCp_value->isNull(); }
+
+      /** @returns number of handles sharing the document */
+      long use_count() const { return mCp_value.use_count(); }
+
+    private:
+
+      /** @returns handle to a process-wide null document */
+      static const std::shared_ptr<Json::Value>& nullDocument() {
+	static const std::shared_ptr<Json::Value> lCp_null =
+	  std::make_shared<Json::Value>();
+	return lCp_null;
+      }
+
+      /** handle to the document (never null) */
+      std::shared_ptr<Json::Value> mCp_value;
+
+    };				// class SharedJson
+
+    inline std::ostream& operator<<(std::ostream& aCr_ostream,
+				    const SharedJson& aCr_value)
+    {
+      return aCr_ostream << aCr_value.get();
+    }
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_SHAREDJSON_HPP
@@ -34,6 +34,7 @@ SimRunner::SimRunner() : SimRunner(Json::nullValue)
 }
 
 SimRunner::SimRunner(Json::Value aC_modelProps) : ModelWrapperBase(),
+                                                  md_timeOrigin(0.),
                                                   mC_modelProps(aC_modelProps)
 {
   // initialize the clock
@@ -41,6 +42,21 @@ SimRunner::SimRunner(Json::Value aC_modelProps) : ModelWrapperBase(),
   mCp_ClockI.reset(new ClockI);
   mCp_ClockI->timeMax() = DBL_MAX;
 
+  // configure the checkpoints
+  //
+  if (mC_modelProps.isObject() && mC_modelProps.isMember("checkpoint"))
+  {
+    try
+    {
+      mCp_checkpoints.reset(new CheckpointWriter(mC_modelProps["checkpoint"]));
+    }
+    catch (const std::logic_error &lC_exp)
+    {
+      LOG4CXX_ERROR(ModelHomeI::getLogger(),
+                    "Checkpoints disabled: " << lC_exp.what());
+    }
+  }
+
   return;
 
   // load and set wrapped model
@@ -76,9 +92,10 @@ void SimRunner::delta_int()
 {
   // advance clock
   if (getTime() < adevs_inf<double>())
-    getClockIPtr()->time() = getTime() + ta();
+    getClockIPtr()->time() = md_timeOrigin + getTime() + ta();
 
   ModelWrapperBase::delta_int();
+  checkpoint();
 }
 
 void SimRunner::delta_ext(double e, const adevs::Bag<IO_Type> &xb)
@@ -88,21 +105,32 @@ void SimRunner::delta_ext(double e, const adevs::Bag<IO_Type> &xb)
     getClockIPtr()->time() += e;
 
   ModelWrapperBase::delta_ext(e, xb);
+  checkpoint();
 }
 
 void SimRunner::delta_conf(const adevs::Bag<IO_Type> &xb)
 {
   // advance clock
   if (getTime() < adevs_inf<double>())
-    getClockIPtr()->time() = getTime();
+    getClockIPtr()->time() = md_timeOrigin + getTime();
 
   ModelWrapperBase::delta_conf(xb);
+  checkpoint();
+}
+
+void SimRunner::stateChange(adevs::Atomic<IO_Type> *aCp_model, double t)
+{
+  ModelWrapperBase::stateChange(aCp_model, t);
+
+  DirtySet *lCp_dirty = getDirtySet();
+  if (lCp_dirty)
+    lCp_dirty->mark(aCp_model);
 }
 
 double SimRunner::ta()
 {
   double ld_delta_t = ModelWrapperBase::ta();
-  if (getTime() + ld_delta_t > getClockIPtr()->timeMax())
+  if (md_timeOrigin + getTime() + ld_delta_t > getClockIPtr()->timeMax())
     return adevs_inf<double>();
 
   return ModelWrapperBase::ta();
@@ -113,7 +141,9 @@ void SimRunner::translateInput(const adevs::Bag<IO_Type> &
                                adevs::Bag<adevs::Event<IO_Type>> &
                                    internal_input)
 {
-  for (auto i: external_input)
+  // port symbols were resolved when the events were created, so the events
+  // can be forwarded as-is
+  for (const auto &i : external_input)
   {
     LOG4CXX_DEBUG(ModelHomeI::getLogger(),
                   "passing on port <" << i.port << ">");
@@ -126,10 +156,9 @@ void SimRunner::translateOutput(const adevs::Bag<adevs::Event<IO_Type>> &
                                     internal_output,
                                 adevs::Bag<IO_Type> &external_output)
 {
-  adevs::Bag<adevs::Event<IO_Type>>::iterator iter;
-  for (auto i: internal_output)
+  for (const auto &i : internal_output)
   {
-    external_output.insert(IO_Type(i.value));
+    external_output.insert(i.value);
   }
 }
 
@@ -158,6 +187,64 @@ void SimRunner::setClockIPtr(const ClockIPtr &aCp_clock)
 
 const ClockI &SimRunner::getClock() const { return *mCp_ClockI; }
 
+/**
+ * Sets the clock of a session restored from a checkpoint, which resumes at
+ * that time.
+ *
+ * @param ad_time simulation time of the checkpoint
+ */
+void SimRunner::restoreTime(double ad_time)
+{
+  getClockIPtr()->time() = ad_time;
+  md_timeOrigin = ad_time;
+}
+
+/**
+ * Advances the clock of a session whose wrapped model is run directly by
+ * another simulator (i.e. not through this wrapper), and writes a checkpoint
+ * if one is due.
+ *
+ * @param ad_time time of the simulator (relative to the time origin)
+ */
+void SimRunner::synchronize(double ad_time)
+{
+  getClockIPtr()->time() = md_timeOrigin + ad_time;
+  checkpoint();
+}
+
+///
+/// checkpoints
+///
+
+/**
+ * Returns the set of models of the wrapped model changed since the last
+ * checkpoint, which is only tracked for incremental checkpoints.
+ *
+ * @returns handle to the set (null if the changes are not tracked)
+ */
+DirtySet *SimRunner::getDirtySet()
+{
+  if (!mCp_dirty && mCp_checkpoints && mCp_checkpoints->incremental() &&
+      getWrappedModel().get() != NULL)
+    mCp_dirty.reset(new DirtySet(getWrappedModel().get()));
+
+  return mCp_dirty.get();
+}
+
+/**
+ * Writes a checkpoint of the session if one is due. The wrapped model is
+ * in a consistent state between transitions, which is when this is called.
+ */
+void SimRunner::checkpoint()
+{
+  if (!mCp_checkpoints || !mCp_checkpoints->due(getClockIPtr()->time()))
+    return;
+
+  // the checkpoint does not own this session
+  DEVSPtr lCp_self(this, [](DEVS *) {});
+  mCp_checkpoints->write(lCp_self, getClockIPtr()->time(), mCp_dirty.get());
+}
+
 } // namespace impl
 
 } // namespace efscape
@@ -30,12 +30,16 @@
 
 // data member definitions
 #include <efscape/impl/ClockI.hpp>
+#include <efscape/impl/CheckpointWriter.hpp>
+#include <efscape/impl/DirtySet.hpp>
 #include <efscape/impl/efscape_cereal.hpp> // cereal for ClockI
 #include <efscape/utils/type.hpp>
 
 #include <json/json.h>
 #include <adevs_exception.h>
 
+#include <memory>
+
 namespace efscape {
 
   namespace impl {
@@ -44,6 +48,10 @@ namespace efscape {
      * Implements an adevs-based model wrapper that encapsulates a simulation
      * model session. It replaces the efscape::impl::AdevsModel
      *
+     * The "checkpoint" model property configures periodic checkpoints of the
+     * session (see CheckpointWriter). A session restored from a checkpoint
+     * resumes at the time of its clock.
+     *
      * @author Jon C. Cline <clinej@stanfordalumni.org>
      * @version 0.3.0 created 27 Apr 2017, revised 02 Mar 2019
      */
@@ -88,6 +96,35 @@ namespace efscape {
       /** @returns reference to clock */
       const ClockI& getClock() const;
 
+      /** @returns simulation time at which this session (re)started */
+      double timeOrigin() const { return md_timeOrigin; }
+
+      void restoreTime(double ad_time);
+
+      //
+      // checkpoints
+      //
+
+      /** @returns handle to the checkpoint writer (null if none) */
+      const std::shared_ptr<CheckpointWriter>& getCheckpointWriter() const {
+	return mCp_checkpoints;
+      }
+
+      /**
+       * Sets the checkpoint writer.
+       *
+       * @param aCp_checkpoints handle to checkpoint writer
+       */
+      void setCheckpointWriter(const std::shared_ptr<CheckpointWriter>&
+			       aCp_checkpoints) {
+	mCp_checkpoints = aCp_checkpoints;
+	mCp_dirty.reset();
+      }
+
+      DirtySet* getDirtySet();
+
+      void synchronize(double ad_time);
+
       //---------------------------
       // adevs ModelWrapper methods
       //---------------------------
@@ -121,6 +158,15 @@ namespace efscape {
        */
       double ta();
 
+      /**
+       * Records a state change of a model of the wrapped simulator (adevs
+       * EventListener callback).
+       *
+       * @param aCp_model handle to atomic model
+       * @param t time of the change
+       */
+      void stateChange(adevs::Atomic<IO_Type>* aCp_model, double t);
+
       /// implementing abtract methods
 
       /**
@@ -161,9 +207,20 @@ namespace efscape {
 
     protected:
 
+      void checkpoint();
+
       /** simulation clock (implementation) */
       ClockIPtr mCp_ClockI;
 
+      /** simulation time at which this session (re)started */
+      double md_timeOrigin;
+
+      /** periodic checkpoints (not archived) */
+      std::shared_ptr<CheckpointWriter> mCp_checkpoints;
+
+      /** models changed since the last checkpoint (not archived) */
+      std::unique_ptr<DirtySet> mCp_dirty;
+
       /** handle to Repast properties in JSON format */
       Json::Value mC_modelProps;
 
@@ -171,13 +228,24 @@ namespace efscape {
       friend class cereal::access;
 
       template<class Archive>
-      void serialize(Archive & ar)
+      void save(Archive & ar) const
       {
 	// invoke serialization
 	ar( cereal::make_nvp("adevs::ModelWrapper", // parent class
 			     cereal::base_class<efscape::impl::ModelWrapperBase>(this) ),
 	    cereal::make_nvp("clock", mCp_ClockI) );
       }
+
+      template<class Archive>
+      void load(Archive & ar)
+      {
+	ar( cereal::make_nvp("adevs::ModelWrapper", // parent class
+			     cereal::base_class<efscape::impl::ModelWrapperBase>(this) ),
+	    cereal::make_nvp("clock", mCp_ClockI) );
+
+	// a restored session resumes at the time of its clock
+	md_timeOrigin = (mCp_ClockI.get() ? mCp_ClockI->time() : 0.);
+      }
     };				// class SimRunner
 
   } // namespace impl
@@ -0,0 +1,383 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : Snapshot.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/Snapshot.hpp>
+
+#include <efscape/impl/ModelHomeI.hpp>
+#include <efscape/impl/ModelHomeSingleton.hpp>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#ifdef EFSCAPE_HAVE_LZ4
+#include <boost/iostreams/operations.hpp>
+#include <lz4frame.h>
+#include <cstring>
+#include <vector>
+#endif
+
+#include <fstream>
+
+namespace io = boost::iostreams;
+
+namespace efscape {
+
+  namespace impl {
+
+#ifdef EFSCAPE_HAVE_LZ4
+    /**
+     * Boost.Iostreams output filter that writes an lz4 frame.
+     */
+    class lz4_compressor
+    {
+    public:
+      typedef char char_type;
+      struct category :
+	io::multichar_output_filter_tag, io::closable_tag {};
+
+      lz4_compressor() : mCp_state(new State) {}
+
+      template<typename Sink>
+      std::streamsize write(Sink& aCr_sink, const char* acp_data,
+			    std::streamsize ai_size) {
+	State& lCr_state = *mCp_state;
+	if (!lCr_state.mb_started)
+	  begin(aCr_sink);
+
+	std::size_t li_bound =
+	  LZ4F_compressBound(ai_size, &lCr_state.mC_prefs);
+	lCr_state.mC1_out.resize(li_bound);
+	std::size_t li_written =
+	  check( LZ4F_compressUpdate(lCr_state.mCp_context,
+				     &lCr_state.mC1_out[0], li_bound,
+				     acp_data, ai_size, NULL) );
+	io::write(aCr_sink, &lCr_state.mC1_out[0], li_written);
+	return ai_size;
+      }
+
+      template<typename Sink>
+      void close(Sink& aCr_sink) {
+	State& lCr_state = *mCp_state;
+	if (!lCr_state.mb_started)
+	  begin(aCr_sink);
+
+	std::size_t li_bound = LZ4F_compressBound(0, &lCr_state.mC_prefs);
+	lCr_state.mC1_out.resize(li_bound);
+	std::size_t li_written =
+	  check( LZ4F_compressEnd(lCr_state.mCp_context,
+				  &lCr_state.mC1_out[0], li_bound, NULL) );
+	io::write(aCr_sink, &lCr_state.mC1_out[0], li_written);
+	lCr_state.mb_started = false;
+      }
+
+    private:
+
+      struct State {
+	LZ4F_cctx* mCp_context;
+	LZ4F_preferences_t mC_prefs;
+	std::vector<char> mC1_out;
+	bool mb_started;
+
+	State() : mCp_context(NULL), mb_started(false) {
+	  std::memset(&mC_prefs, 0, sizeof(mC_prefs));
+	  check( LZ4F_createCompressionContext(&mCp_context, LZ4F_VERSION) );
+	}
+	~State() { LZ4F_freeCompressionContext(mCp_context); }
+      };
+
+      template<typename Sink>
+      void begin(Sink& aCr_sink) {
+	State& lCr_state = *mCp_state;
+	lCr_state.mC1_out.resize(LZ4F_HEADER_SIZE_MAX);
+	std::size_t li_written =
+	  check( LZ4F_compressBegin(lCr_state.mCp_context,
+				    &lCr_state.mC1_out[0],
+				    lCr_state.mC1_out.size(),
+				    &lCr_state.mC_prefs) );
+	io::write(aCr_sink, &lCr_state.mC1_out[0], li_written);
+	lCr_state.mb_started = true;
+      }
+
+      static std::size_t check(std::size_t ai_code) {
+	if (LZ4F_isError(ai_code))
+	  throw std::logic_error(std::string("lz4 compression failed: ")
+				 + LZ4F_getErrorName(ai_code));
+	return ai_code;
+      }
+
+      // filters are copied into the stream chain: the copies share a state
+      std::shared_ptr<State> mCp_state;
+
+    };				// class lz4_compressor
+
+    /**
+     * Boost.Iostreams input filter that reads lz4 frames.
+     */
+    class lz4_decompressor
+    {
+    public:
+      typedef char char_type;
+      typedef io::multichar_input_filter_tag category;
+
+      lz4_decompressor() : mCp_state(new State) {}
+
+      template<typename Source>
+      std::streamsize read(Source& aCr_source, char* acp_data,
+			   std::streamsize ai_size) {
+	State& lCr_state = *mCp_state;
+	std::streamsize li_read = 0;
+
+	while (li_read < ai_size) {
+	  if (lCr_state.mi_begin == lCr_state.mi_end) {
+	    if (lCr_state.mb_eof)
+	      break;
+	    std::streamsize li_count =
+	      io::read(aCr_source, &lCr_state.mC1_in[0],
+		       lCr_state.mC1_in.size());
+	    if (li_count <= 0) {
+	      lCr_state.mb_eof = true;
+	      break;
+	    }
+	    lCr_state.mi_begin = 0;
+	    lCr_state.mi_end = li_count;
+	  }
+
+	  std::size_t li_dstSize = ai_size - li_read;
+	  std::size_t li_srcSize = lCr_state.mi_end - lCr_state.mi_begin;
+	  std::size_t li_code =
+	    LZ4F_decompress(lCr_state.mCp_context, acp_data + li_read,
+			    &li_dstSize,
+			    &lCr_state.mC1_in[lCr_state.mi_begin],
+			    &li_srcSize, NULL);
+	  if (LZ4F_isError(li_code))
+	    throw std::logic_error(std::string("lz4 decompression failed: ")
+				   + LZ4F_getErrorName(li_code));
+	  lCr_state.mi_begin += li_srcSize;
+	  li_read += li_dstSize;
+	}
+
+	return (li_read > 0 ? li_read : -1);
+      }
+
+    private:
+
+      struct State {
+	LZ4F_dctx* mCp_context;
+	std::vector<char> mC1_in;
+	std::size_t mi_begin;
+	std::size_t mi_end;
+	bool mb_eof;
+
+	State() : mCp_context(NULL), mC1_in(1 << 16), mi_begin(0), mi_end(0),
+		  mb_eof(false) {
+	  std::size_t li_code =
+	    LZ4F_createDecompressionContext(&mCp_context, LZ4F_VERSION);
+	  if (LZ4F_isError(li_code))
+	    throw std::logic_error("lz4: unable to create a decompression context");
+	}
+	~State() { LZ4F_freeDecompressionContext(mCp_context); }
+      };
+
+      // filters are copied into the stream chain: the copies share a state
+      std::shared_ptr<State> mCp_state;
+
+    };				// class lz4_decompressor
+#endif	// #ifdef EFSCAPE_HAVE_LZ4
+
+    /**
+     * Returns the compression codec of a snapshot file.
+     *
+     * @param aCr_filename name of the snapshot file
+     * @returns compression codec
+     */
+    SnapshotCodec snapshotCodec(const std::string& aCr_filename)
+    {
+      if (boost::algorithm::ends_with(aCr_filename, ".gz"))
+	return GZIP_CODEC;
+      if (boost::algorithm::ends_with(aCr_filename, ".lz4"))
+	return LZ4_CODEC;
+      return NO_CODEC;
+    }
+
+    /**
+     * Returns the archive format of a snapshot file: the extension of its
+     * name once the extension of the codec, if any, is removed (e.g.
+     * ".json" for "model.json.gz").
+     *
+     * @param aCr_filename name of the snapshot file
+     * @returns archive format extension (including the '.')
+     */
+    std::string snapshotFormat(const std::string& aCr_filename)
+    {
+      std::string lC_name = aCr_filename;
+      if (snapshotCodec(lC_name) != NO_CODEC)
+	lC_name.erase(lC_name.rfind('.'));
+
+      std::string::size_type li_dot = lC_name.rfind('.');
+      std::string::size_type li_slash = lC_name.find_last_of("/\\");
+      if (li_dot == std::string::npos ||
+	  (li_slash != std::string::npos && li_dot < li_slash))
+	return "";
+      return lC_name.substr(li_dot);
+    }
+
+    /**
+     * Opens a snapshot file for reading, decompressing it on the fly with
+     * the codec of its name.
+     *
+     * @param aCr_filename name of the snapshot file
+     * @returns input stream
+     * @throws std::logic_error if the file cannot be opened
+     */
+    std::unique_ptr<std::istream>
+    openSnapshotIn(const std::string& aCr_filename)
+      throw(std::logic_error)
+    {
+      SnapshotCodec le_codec = snapshotCodec(aCr_filename);
+
+      std::ifstream lC_probe(aCr_filename.c_str(), std::ios::binary);
+      if (!lC_probe)
+	throw std::logic_error("openSnapshotIn(): can't open <"
+			       + aCr_filename + ">");
+      lC_probe.close();
+
+      if (le_codec == NO_CODEC)
+	return std::unique_ptr<std::istream>
+	  ( new std::ifstream(aCr_filename.c_str(),
+			      std::ios::in | std::ios::binary) );
+
+      std::unique_ptr<io::filtering_istream> lCp_in(new io::filtering_istream);
+      if (le_codec == GZIP_CODEC)
+	lCp_in->push( io::gzip_decompressor() );
+      else {
+#ifdef EFSCAPE_HAVE_LZ4
+	lCp_in->push( lz4_decompressor() );
+#else
+	throw std::logic_error("openSnapshotIn(): <" + aCr_filename
+			       + ">: efscape was built without lz4");
+#endif
+      }
+      lCp_in->push( io::file_source(aCr_filename,
+				    std::ios::in | std::ios::binary) );
+
+      return std::unique_ptr<std::istream>( lCp_in.release() );
+    }
+
+    /**
+     * Opens a snapshot file for writing, compressing it on the fly with the
+     * codec of its name. The compressed stream is only complete once the
+     * returned stream has been destroyed.
+     *
+     * @param aCr_filename name of the snapshot file
+     * @returns output stream
+     * @throws std::logic_error if the file cannot be opened
+     */
+    std::unique_ptr<std::ostream>
+    openSnapshotOut(const std::string& aCr_filename)
+      throw(std::logic_error)
+    {
+      SnapshotCodec le_codec = snapshotCodec(aCr_filename);
+
+      if (le_codec == NO_CODEC) {
+	std::unique_ptr<std::ostream> lCp_out
+	  ( new std::ofstream(aCr_filename.c_str(),
+			      std::ios::out | std::ios::binary) );
+	if (!*lCp_out)
+	  throw std::logic_error("openSnapshotOut(): can't open <"
+				 + aCr_filename + ">");
+	return lCp_out;
+      }
+
+#ifndef EFSCAPE_HAVE_LZ4
+      if (le_codec == LZ4_CODEC)
+	throw std::logic_error("openSnapshotOut(): <" + aCr_filename
+			       + ">: efscape was built without lz4");
+#endif
+
+      io::file_sink lC_file(aCr_filename, std::ios::out | std::ios::binary);
+      if (!lC_file.is_open())
+	throw std::logic_error("openSnapshotOut(): can't open <"
+			       + aCr_filename + ">");
+
+      std::unique_ptr<io::filtering_ostream> lCp_out(new io::filtering_ostream);
+      if (le_codec == GZIP_CODEC)
+	lCp_out->push( io::gzip_compressor() );
+#ifdef EFSCAPE_HAVE_LZ4
+      else
+	lCp_out->push( lz4_compressor() );
+#endif
+      lCp_out->push( lC_file );
+
+      return std::unique_ptr<std::ostream>( lCp_out.release() );
+    }
+
+    /**
+     * Saves a snapshot of a model to a file, in the archive format (.efb,
+     * .xml or .json) and with the compression codec (.gz or .lz4) of the
+     * file name.
+     *
+     * @param aCp_model handle to model
+     * @param aCr_filename name of the snapshot file
+     * @throws std::logic_error
+     */
+    void saveModelSnapshot(const DEVSPtr& aCp_model,
+			   const std::string& aCr_filename)
+      throw(std::logic_error)
+    {
+      std::string lC_format = snapshotFormat(aCr_filename);
+      std::unique_ptr<std::ostream> lCp_out = openSnapshotOut(aCr_filename);
+
+      if (lC_format == ".efb")
+	saveAdevsToBinary(aCp_model, *lCp_out);
+      else if (lC_format == ".xml")
+	saveAdevsToXML(aCp_model.get(), *lCp_out);
+      else
+	saveAdevsToJSON(aCp_model, *lCp_out);
+
+      lCp_out->flush();
+    }
+
+    /**
+     * Loads a model from a snapshot file, in the archive format and with the
+     * compression codec of the file name. An uncompressed snapshot is
+     * restored straight from the mapped file (see
+     * ModelHomeI::createModelFromSnapshot).
+     *
+     * @param aCr_filename name of the snapshot file
+     * @returns handle to model (null if it could not be restored)
+     * @throws std::logic_error if the file cannot be opened
+     */
+    DEVSPtr loadModelSnapshot(const std::string& aCr_filename)
+      throw(std::logic_error)
+    {
+      if (snapshotCodec(aCr_filename) == NO_CODEC)
+	return Singleton<ModelHomeI>::Instance().
+	  createModelFromSnapshot(aCr_filename.c_str());
+
+      std::string lC_format = snapshotFormat(aCr_filename);
+      std::unique_ptr<std::istream> lCp_in = openSnapshotIn(aCr_filename);
+
+      if (lC_format == ".efb")
+	return loadAdevsFromBinary(*lCp_in);
+      if (lC_format == ".xml")
+	return DEVSPtr( loadAdevsFromXML(*lCp_in) );
+      return loadAdevsFromJSON(*lCp_in);
+    }
+
+  } // namespace impl
+
+} // namespace efscape
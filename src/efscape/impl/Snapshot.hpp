@@ -0,0 +1,66 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : Snapshot.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_SNAPSHOT_HPP
+#define EFSCAPE_IMPL_SNAPSHOT_HPP
+
+#include <efscape/impl/efscapelib.hpp>
+
+#include <iosfwd>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Compression codecs of model snapshot files, selected by the last
+     * extension of the file name:
+     *   - ".gz": gzip (zlib), e.g. "model.json.gz"
+     *   - ".lz4": lz4 frames, e.g. "model.efb.lz4" (if efscape was
+     *     configured with lz4)
+     */
+    enum SnapshotCodec {
+      NO_CODEC,
+      GZIP_CODEC,
+      LZ4_CODEC
+    };
+
+    SnapshotCodec snapshotCodec(const std::string& aCr_filename);
+
+    std::string snapshotFormat(const std::string& aCr_filename);
+
+    std::unique_ptr<std::istream>
+    openSnapshotIn(const std::string& aCr_filename)
+      throw(std::logic_error);
+
+    std::unique_ptr<std::ostream>
+    openSnapshotOut(const std::string& aCr_filename)
+      throw(std::logic_error);
+
+    void saveModelSnapshot(const DEVSPtr& aCp_model,
+			   const std::string& aCr_filename)
+      throw(std::logic_error);
+
+    DEVSPtr loadModelSnapshot(const std::string& aCr_filename)
+      throw(std::logic_error);
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_SNAPSHOT_HPP
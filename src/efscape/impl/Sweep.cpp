@@ -0,0 +1,285 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : Sweep.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/Sweep.hpp>
+
+#include <efscape/impl/RandomStream.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace efscape {
+
+  namespace impl {
+
+    namespace {
+
+      // returns the values of a grid parameter
+      std::vector<Json::Value> gridValues(const std::string& aCr_key,
+					  const Json::Value& aCr_values)
+      {
+	std::vector<Json::Value> lC1_values;
+	if (aCr_values.isArray()) {
+	  for (const auto& i : aCr_values)
+	    lC1_values.push_back(i);
+	}
+	else if ( aCr_values.isObject() && aCr_values["min"].isNumeric() &&
+		  aCr_values["max"].isNumeric() ) {
+	  double ld_min = aCr_values["min"].asDouble();
+	  double ld_max = aCr_values["max"].asDouble();
+	  Json::Value lC_steps = aCr_values.get("steps", 2);
+	  if (!lC_steps.isUInt())
+	    throw std::logic_error("sweep parameter <" + aCr_key +
+				   ">: <steps> must be a non-negative integer");
+	  unsigned int li_steps = lC_steps.asUInt();
+	  if (li_steps < 2)
+	    lC1_values.push_back(ld_min);
+	  else {
+	    for (unsigned int i = 0; i < li_steps; i++)
+	      lC1_values.push_back(ld_min + (ld_max - ld_min)*i/(li_steps - 1));
+	  }
+	}
+
+	if (lC1_values.empty())
+	  throw std::logic_error("sweep parameter <" + aCr_key +
+				 "> has no values");
+
+	return lC1_values;
+      }
+
+      // adds the numbers in a JSON value to the results of a run
+      void addNumbers(std::map<std::string, double>& aCr_values,
+		      const std::string& aCr_key,
+		      const Json::Value& aCr_value)
+      {
+	if (aCr_value.isNumeric())
+	  aCr_values[aCr_key] = aCr_value.asDouble();
+	else if (aCr_value.isObject()) {
+	  for (Json::Value::const_iterator iter = aCr_value.begin();
+	       iter != aCr_value.end(); iter++)
+	    addNumbers(aCr_values, aCr_key + "." + iter.name(), *iter);
+	}
+      }
+
+    } // namespace
+
+    std::vector<Json::Value> expandSweep(const Json::Value& aCr_spec,
+					 std::uint64_t al_seed)
+      throw(std::logic_error)
+    {
+      std::vector<Json::Value> lC1_points;
+      if (!aCr_spec.isObject())
+	throw std::logic_error("the sweep must be an object");
+      Json::Value lC_designName = aCr_spec.get("design", "grid");
+      if (!lC_designName.isString())
+	throw std::logic_error("sweep <design> must be a string");
+      std::string lC_design = lC_designName.asString();
+
+      //------------------------------------
+      // 1. explicit list of parameter points
+      //------------------------------------
+      if (lC_design == "list") {
+	const Json::Value& lC_points = aCr_spec["points"];
+	if (!lC_points.isArray())
+	  throw std::logic_error("sweep <points> must be an array");
+	for (const auto& i : lC_points) {
+	  if (!i.isObject())
+	    throw std::logic_error("sweep <points> must hold objects");
+	  lC1_points.push_back(i);
+	}
+	return lC1_points;
+      }
+
+      const Json::Value& lC_parameters = aCr_spec["parameters"];
+      if (!lC_parameters.isObject() || lC_parameters.empty())
+	throw std::logic_error("sweep <parameters> must be a non-empty object");
+      std::vector<std::string> lC1_keys = lC_parameters.getMemberNames();
+
+      //--------------------------------------------
+      // 2. full factorial design over the parameters
+      //--------------------------------------------
+      if (lC_design == "grid") {
+	std::vector< std::vector<Json::Value> > lC2_values;
+	for (const auto& i : lC1_keys)
+	  lC2_values.push_back( gridValues(i, lC_parameters[i]) );
+
+	// iterate over the grid like an odometer, the last key fastest
+	std::vector<std::size_t> lC1_index(lC1_keys.size(), 0);
+	for (;;) {
+	  Json::Value lC_point(Json::objectValue);
+	  for (std::size_t i = 0; i < lC1_keys.size(); i++)
+	    lC_point[lC1_keys[i]] = lC2_values[i][lC1_index[i]];
+	  lC1_points.push_back(lC_point);
+
+	  std::size_t k = lC1_keys.size();
+	  while (k > 0 && ++lC1_index[k-1] == lC2_values[k-1].size())
+	    lC1_index[--k] = 0;
+	  if (k == 0)
+	    break;
+	}
+	return lC1_points;
+      }
+
+      //--------------------------------------------------------------------
+      // 3. Latin hypercube: each range is cut into <samples> strata, and
+      //    each stratum of each parameter is sampled exactly once
+      //--------------------------------------------------------------------
+      if (lC_design == "lhs") {
+	Json::Value lC_samples = aCr_spec.get("samples", 0);
+	unsigned int li_samples = (lC_samples.isUInt() ?
+				   lC_samples.asUInt() : 0);
+	if (li_samples == 0)
+	  throw std::logic_error("sweep <samples> must be a positive integer");
+
+	RandomEngine lC_engine(al_seed);
+	std::uniform_real_distribution<double> lC_uniform(0., 1.);
+	lC1_points.assign(li_samples, Json::Value(Json::objectValue));
+
+	std::vector<unsigned int> lC1_strata(li_samples);
+	for (const auto& i : lC1_keys) {
+	  const Json::Value& lC_range = lC_parameters[i];
+	  if ( !lC_range.isObject() || !lC_range["min"].isNumeric() ||
+	       !lC_range["max"].isNumeric() )
+	    throw std::logic_error("sweep parameter <" + i +
+				   "> must be a range {min, max}");
+	  double ld_min = lC_range["min"].asDouble();
+	  double ld_max = lC_range["max"].asDouble();
+
+	  std::iota(lC1_strata.begin(), lC1_strata.end(), 0);
+	  std::shuffle(lC1_strata.begin(), lC1_strata.end(), lC_engine);
+	  for (unsigned int j = 0; j < li_samples; j++) {
+	    double ld_u = (lC1_strata[j] + lC_uniform(lC_engine))/li_samples;
+	    lC1_points[j][i] = ld_min + ld_u*(ld_max - ld_min);
+	  }
+	}
+	return lC1_points;
+      }
+
+      throw std::logic_error("unknown sweep design <" + lC_design + ">");
+    }
+
+    Json::Value applySweepPoint(const Json::Value& aCr_parameters,
+				const Json::Value& aCr_point)
+    {
+      Json::Value lC_parameters = aCr_parameters;
+      Json::Value& lC_properties = lC_parameters["properties"];
+
+      for (Json::Value::const_iterator iter = aCr_point.begin();
+	   iter != aCr_point.end(); iter++) {
+	// walk down to the object holding the (possibly nested) property
+	std::string lC_key = iter.name();
+	Json::Value* lCp_node = &lC_properties;
+	std::size_t li_dot;
+	while ( (li_dot = lC_key.find('.')) != std::string::npos ) {
+	  lCp_node = &(*lCp_node)[lC_key.substr(0, li_dot)];
+	  lC_key.erase(0, li_dot + 1);
+	}
+	(*lCp_node)[lC_key] = *iter;
+      }
+
+      return lC_parameters;
+    }
+
+    //
+    // RunResult
+    //
+
+    void RunResult::operator()(const IO_Type& aCr_value)
+    {
+      const std::string& lC_port = aCr_value.port.name();
+      mCC_values[lC_port + ".events"] += 1.;
+
+      if (const Json::Value* lCp_value = json_value_cast(&aCr_value.value))
+	addNumbers(mCC_values, lC_port, *lCp_value);
+      else if (const double* lCp_value =
+	       value_cast<double>(&aCr_value.value))
+	mCC_values[lC_port] = *lCp_value;
+    }
+
+    Json::Value RunResult::toJSON() const
+    {
+      Json::Value lC_values(Json::objectValue);
+      for (const auto& i : mCC_values)
+	lC_values[i.first] = i.second;
+      return lC_values;
+    }
+
+    //
+    // RunSummary
+    //
+
+    void RunSummary::add(const std::map<std::string, double>& aCr_values)
+    {
+      ++mi_runs;
+      for (const auto& i : aCr_values)
+	add(i.first, i.second);
+    }
+
+    void RunSummary::add(const Json::Value& aCr_values)
+    {
+      ++mi_runs;
+      for (Json::Value::const_iterator iter = aCr_values.begin();
+	   iter != aCr_values.end(); iter++) {
+	if ((*iter).isNumeric())
+	  add(iter.name(), (*iter).asDouble());
+      }
+    }
+
+    void RunSummary::add(const std::string& aCr_key, double ad_value)
+    {
+      std::map<std::string, Statistic>::iterator iter =
+	mCC_statistics.find(aCr_key);
+      if (iter == mCC_statistics.end()) {
+	Statistic lC_statistic = { 0, 0., 0., ad_value, ad_value };
+	iter = mCC_statistics.insert(std::make_pair(aCr_key, lC_statistic))
+	  .first;
+      }
+
+      Statistic& lC_statistic = iter->second;
+      ++lC_statistic.n;
+      double ld_delta = ad_value - lC_statistic.mean;
+      lC_statistic.mean += ld_delta/lC_statistic.n;
+      lC_statistic.m2 += ld_delta*(ad_value - lC_statistic.mean);
+      lC_statistic.min = std::min(lC_statistic.min, ad_value);
+      lC_statistic.max = std::max(lC_statistic.max, ad_value);
+    }
+
+    Json::Value RunSummary::toJSON() const
+    {
+      Json::Value lC_summary(Json::objectValue);
+      lC_summary["runs"] = mi_runs;
+      lC_summary["failures"] = mi_failures;
+
+      Json::Value& lC_statistics = lC_summary["statistics"];
+      lC_statistics = Json::Value(Json::objectValue);
+      for (const auto& i : mCC_statistics) {
+	const Statistic& lC_statistic = i.second;
+	Json::Value& lC_value = lC_statistics[i.first];
+	lC_value["n"] = Json::UInt64(lC_statistic.n);
+	lC_value["mean"] = lC_statistic.mean;
+	lC_value["sd"] = (lC_statistic.n > 1 ?
+			  std::sqrt(lC_statistic.m2/(lC_statistic.n - 1)) :
+			  0.);
+	lC_value["min"] = lC_statistic.min;
+	lC_value["max"] = lC_statistic.max;
+      }
+
+      return lC_summary;
+    }
+
+  } // namespace impl
+
+} // namespace efscape
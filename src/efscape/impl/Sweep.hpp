@@ -0,0 +1,165 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : Sweep.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_SWEEP_HPP
+#define EFSCAPE_IMPL_SWEEP_HPP
+
+#include <efscape/impl/efscapelib.hpp>
+
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Expands a sweep specification into its parameter points. Each point
+     * is a JSON object that maps model property keys (a '.' separates the
+     * keys of nested objects) to values. The specification is a JSON
+     * object:\n
+     *
+     *   - "design": "grid" (default), "lhs" (Latin hypercube) or "list"
+     *   - "parameters": for a grid, each key maps to an array of values or
+     *     to a range {"min", "max", "steps"}; for a Latin hypercube, each
+     *     key maps to a range {"min", "max"}
+     *   - "samples": number of Latin hypercube points
+     *   - "points": for a list, an array of points
+     *
+     * @param aCr_spec sweep specification
+     * @param al_seed seed used to sample a Latin hypercube
+     * @returns parameter points
+     * @throws std::logic_error if the specification is not valid
+     */
+    std::vector<Json::Value> expandSweep(const Json::Value& aCr_spec,
+					 std::uint64_t al_seed)
+      throw(std::logic_error);
+
+    /**
+     * Returns a copy of model parameters (see
+     * ModelHomeI::createModelFromParameters) with the properties of a
+     * parameter point set.
+     *
+     * @param aCr_parameters model parameters
+     * @param aCr_point parameter point
+     * @returns model parameters of the point
+     */
+    Json::Value applySweepPoint(const Json::Value& aCr_parameters,
+				const Json::Value& aCr_point);
+
+    /**
+     * Implements an output sink that reduces the output of a simulation run
+     * to a few numeric results: the number of events on each port
+     * ("<port>.events"), and the latest numbers sent on each port ("<port>"
+     * for a number, "<port>.<key>" for the members of a JSON object).
+     */
+    class RunResult
+    {
+    public:
+
+      RunResult() {}
+
+      /**
+       * Adds an output value of the run.
+       *
+       * @param aCr_value output value
+       */
+      void operator()(const IO_Type& aCr_value);
+
+      /** @returns the results of the run */
+      const std::map<std::string, double>& values() const {
+	return mCC_values;
+      }
+
+      /** @returns the results of the run in a JSON object */
+      Json::Value toJSON() const;
+
+    private:
+
+      /** results */
+      std::map<std::string, double> mCC_values;
+
+    };				// class RunResult
+
+    /**
+     * Implements a running summary (count, mean, standard deviation,
+     * minimum and maximum) of the results of the runs of one parameter
+     * point. Results are accumulated as they arrive, so the runs do not have
+     * to be kept.
+     */
+    class RunSummary
+    {
+    public:
+
+      RunSummary() : mi_runs(0), mi_failures(0) {}
+
+      /**
+       * Adds the results of a run.
+       *
+       * @param aCr_values results of the run
+       */
+      void add(const std::map<std::string, double>& aCr_values);
+
+      /**
+       * Adds the results of a run held in a JSON object.
+       *
+       * @param aCr_values results of the run
+       */
+      void add(const Json::Value& aCr_values);
+
+      /** Counts a run that failed. */
+      void addFailure() { ++mi_runs; ++mi_failures; }
+
+      /** @returns number of runs */
+      unsigned int runs() const { return mi_runs; }
+
+      /** @returns number of failed runs */
+      unsigned int failures() const { return mi_failures; }
+
+      /** @returns the summary statistics in a JSON object */
+      Json::Value toJSON() const;
+
+    private:
+
+      void add(const std::string& aCr_key, double ad_value);
+
+      /** running statistics of one result (Welford's method) */
+      struct Statistic {
+	unsigned long n;
+	double mean;
+	double m2;
+	double min;
+	double max;
+      };
+
+      /** statistics by result */
+      std::map<std::string, Statistic> mCC_statistics;
+
+      /** number of runs */
+      unsigned int mi_runs;
+
+      /** number of failed runs */
+      unsigned int mi_failures;
+
+    };				// class RunSummary
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_SWEEP_HPP
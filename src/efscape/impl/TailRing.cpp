@@ -0,0 +1,181 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : TailRing.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+
+#include <efscape/impl/TailRing.hpp>
+#include <efscape/utils/SharedRing.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+namespace efscape {
+
+  namespace impl {
+
+    // class variables
+    const char* TailRing::mScp_program_name = "eftail";
+    const char* TailRing::mScp_program_version =
+      "version 0.1.0 (2026/10/17)";
+
+    /** default constructor */
+    TailRing::TailRing() :
+      mb_unlink(false)
+    {
+      mC_extended_description.add_options()
+	("unlink", "remove the ring from shared memory once the run has ended")
+	;
+    }
+
+    /** destructor */
+    TailRing::~TailRing() {}
+
+    /**
+     * Returns the program name
+     *
+     * @returns the program name
+     */
+    const char* TailRing::program_name() {
+      return TailRing::mScp_program_name;
+    }
+
+    /**
+     * Returns the program name (class version)
+     *
+     * @returns the program name
+     */
+    const char* TailRing::ProgramName() {
+      return TailRing::mScp_program_name;
+    }
+
+    /**
+     * Returns the program version.
+     *
+     * @returns the program version
+     */
+    const char* TailRing::program_version() {
+      return TailRing::mScp_program_version;
+    }
+
+    /**
+     * Executes the TailRing command
+     *
+     * @returns exit state
+     */
+    int TailRing::execute() {
+
+      std::ofstream lC_file;
+      if (out_file() != "")
+	lC_file.open(out_file().c_str());
+      std::ostream lC_out(out_file() != "" ? lC_file.rdbuf() :
+			  std::cout.rdbuf());
+
+      try {
+	efscape::utils::SharedRingReader lC_reader((*this)[0]);
+
+	// read the records until the writer has closed the ring and the ring
+	// has been drained (the closed flag is checked before reading, so
+	// that no record published before the ring was closed is missed)
+	std::string lC_record;
+	std::uint64_t ll_sequence = 0;
+	std::uint64_t ll_lost = 0;
+	while (true) {
+	  bool lb_closed = lC_reader.closed();
+	  if (lC_reader.next(lC_record, ll_sequence)) {
+	    lC_out << lC_record << '\n';
+	    if (lC_reader.lost() != ll_lost) {
+	      std::cerr << program_name() << ": overrun, "
+			<< (lC_reader.lost() - ll_lost)
+			<< " records lost before record " << ll_sequence
+			<< '\n';
+	      ll_lost = lC_reader.lost();
+	    }
+	    continue;
+	  }
+	  if (lb_closed)
+	    break;
+
+	  lC_out.flush();
+	  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	lC_out.flush();
+
+	if (lC_reader.overruns() > 0)
+	  std::cerr << program_name() << ": " << lC_reader.lost()
+		    << " records lost in " << lC_reader.overruns()
+		    << " overruns\n";
+      }
+      catch(std::logic_error lC_excp) {
+	std::cerr << program_name() << ": " << lC_excp.what() << '\n';
+	return EXIT_FAILURE;
+      }
+
+      if (mb_unlink)
+	efscape::utils::SharedRingWriter::unlink((*this)[0]);
+
+      return EXIT_SUCCESS;
+    }
+
+    /**
+     * Parses the command line arguements and initializes the command
+     * configuration.
+     *
+     * @param argc number of command line arguments
+     * @param argv vector of command line arguments
+     * @returns exit status
+     */
+    int TailRing::parse_options(int argc, char *argv[]) {
+
+      int li_status = CommandOpt::parse_options(argc,argv);	// parent method
+      if (li_status != 0)
+	return li_status;
+
+      if (files() != 1) {
+	usage(1);
+	return 1;
+      }
+
+      mb_unlink = (mC_variable_map.count("unlink") > 0);
+
+      return li_status;
+    }
+
+    /**
+     * Prints out usage message for this command/program
+     *
+     * @args  exit_value exit value
+     */
+    void TailRing::usage( int exit_value )
+    {
+      std::cerr << "usage:\n"
+		<< program_name() << " "
+		<< "[-d] [-h] [-v]\n\t"
+		<< "[-o output_file]\n\t"
+		<< "[--unlink]\n\t"
+		<< "ring_name\n\n"
+		<< "where [] indicates optional option:\n\n"
+		<< mC_description
+		<< "examples:\n\t\t"
+		<< program_name() << " /run1\n\t\t"
+		<< program_name() << " --unlink -o run1.json /run1\n\n"
+		<< "The ring is published by efdriver with --shm ring_name,"
+		<< " and the reader starts at its latest record.\n";
+
+      exit( exit_value );
+    }
+
+  } // namespace impl
+
+} // namespace efscape
@@ -0,0 +1,68 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : TailRing.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_TAILRING_HPP
+#define EFSCAPE_IMPL_TAILRING_HPP
+
+#include <efscape/utils/CommandOpt.hpp>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Implements a live reader of the output that efdriver publishes to a
+     * shared-memory ring buffer (--shm). The command 'eftail' writes out the
+     * output records as they are published (JSON, one record per line),
+     * until the run ends. Records that the reader was too slow to read
+     * before they were overwritten are reported on stderr.
+     */
+    class TailRing : public efscape::utils::CommandOpt
+    {
+    public:
+
+      TailRing();
+      virtual ~TailRing();
+
+      int parse_options( int argc, char *argv[]);
+      int execute();
+
+      const char* program_name();
+      const char* program_version();
+
+      static const char* ProgramName();
+
+    protected:
+
+      void usage( int exit_value = 0 );
+
+    private:
+
+      /** whether to remove the ring once the run has ended */
+      bool mb_unlink;
+
+      /** program name */
+      static const char* mScp_program_name;
+
+      /** program version */
+      static const char* mScp_program_version;
+
+    };
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_TAILRING_HPP
@@ -0,0 +1,760 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : TimeWarpSimulator.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/impl/TimeWarpSimulator.hpp>
+
+#include <efscape/impl/AtomicIndex.hpp>
+#include <efscape/impl/Checkpointable.hpp>
+#include <efscape/impl/ModelHomeI.hpp>
+#include <efscape/utils/type.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * A partition of the model, executed optimistically: a logical process
+     * in Time Warp terms.
+     */
+    class TimeWarpSimulator::Partition
+    {
+    public:
+
+      /** an event sent from one partition to another, or its cancellation */
+      struct Message {
+	Time time;
+	std::size_t src;
+	unsigned long serial;
+	std::size_t dst;
+	DEVS* model;
+	IO_Type value;
+	bool anti;
+	bool operator<(const Message& aCr_message) const {
+	  if (time < aCr_message.time) return true;
+	  if (aCr_message.time < time) return false;
+	  if (src != aCr_message.src) return src < aCr_message.src;
+	  return serial < aCr_message.serial;
+	}
+      };
+
+      /** an output event, kept until it is committed */
+      struct Output {
+	Time time;
+	adevs::Event<IO_Type> event;
+	bool operator<(const Output& aCr_output) const {
+	  return time < aCr_output.time;
+	}
+      };
+
+      Partition(std::size_t ai_id, NETWORK* aCp_root,
+		const PartitionMap& aCr_owners, std::size_t ai_partitions) :
+	mi_id(ai_id),
+	mCp_root(aCp_root),
+	mCr_owners(aCr_owners),
+	mC1_outboxes(ai_partitions),
+	mb_replay(false),
+	mb_replayPending(false),
+	mi_window(1),
+	ml_serial(0),
+	ml_processed(0),
+	ml_rolledBack(0),
+	ml_rollbacks(0),
+	ml_antiMessages(0)
+      {}
+
+      /** adds a component of the root network */
+      void add(DEVS* aCp_component)
+      {
+	AtomicIndex lC_index(aCp_component);
+	const std::vector<ATOMIC*>& lC1_atomics = lC_index.atomics();
+	for (std::size_t k = 0; k < lC1_atomics.size(); k++) {
+	  Checkpointable* lCp_state =
+	    dynamic_cast<Checkpointable*>(lC1_atomics[k]);
+	  if (lCp_state == NULL)
+	    throw std::logic_error("TimeWarpSimulator: atomic model <" +
+				   efscape::utils::type<DEVS>(*lC1_atomics[k])
+				   + "> is not Checkpointable");
+	  mCC_indices[ lC1_atomics[k] ] = mC1_atomics.size();
+	  mC1_atomics.push_back(lC1_atomics[k]);
+	  mC1_states.push_back(lCp_state);
+	}
+      }
+
+      /** initializes the schedule, as adevs::Simulator does */
+      void initialize()
+      {
+	std::size_t ll_size = mC1_atomics.size();
+	Time lC_never = { adevs_inf<double>(), 0 };
+	mC1_tL.assign(ll_size, 0.);
+	mC1_tN.assign(ll_size, lC_never);
+	mC1_input.resize(ll_size);
+	mC1_output.resize(ll_size);
+	mC1_active.assign(ll_size, INACTIVE);
+	for (std::size_t i = 0; i < ll_size; i++) {
+	  double ld_ta = mC1_atomics[i]->ta();
+	  if (ld_ta < adevs_inf<double>())
+	    mC1_tN[i].t = ld_ta;
+	}
+	reschedule();
+      }
+
+      /** @returns time of the next unprocessed event */
+      Time nextTime()
+      {
+	Time lC_time = { adevs_inf<double>(), 0 };
+	while (!mC_schedule.empty()) {
+	  const Entry& lCr_top = mC_schedule.top();
+	  if (mC1_tN[lCr_top.index] == lCr_top.tN) {
+	    lC_time = lCr_top.tN;
+	    break;
+	  }
+	  mC_schedule.pop();
+	}
+	if (!mCC_pending.empty() && mCC_pending.begin()->time < lC_time)
+	  lC_time = mCC_pending.begin()->time;
+	return lC_time;
+      }
+
+      /** @returns time of the earliest message waiting to be sent */
+      Time nextSendTime() const
+      {
+	Time lC_time = { adevs_inf<double>(), 0 };
+	for (std::size_t q = 0; q < mC1_outboxes.size(); q++)
+	  for (std::size_t m = 0; m < mC1_outboxes[q].size(); m++)
+	    if (mC1_outboxes[q][m].time < lC_time)
+	      lC_time = mC1_outboxes[q][m].time;
+	return lC_time;
+      }
+
+      /**
+       * Absorbs the messages received since the last round, rolling back
+       * for stragglers and cancelled messages, then executes steps before
+       * the limit. The number of steps adapts to the rollbacks: it is
+       * halved after a rollback and doubled otherwise, up to ai_batch.
+       *
+       * @param ad_limit time limit
+       * @param ai_batch maximum number of steps
+       */
+      void run(double ad_limit, unsigned int ai_batch)
+      {
+	// a single rollback, to the earliest message, covers every straggler
+	if (!mC1_inbox.empty()) {
+	  Time lC_earliest = mC1_inbox[0].time;
+	  for (std::size_t m = 1; m < mC1_inbox.size(); m++)
+	    if (mC1_inbox[m].time < lC_earliest)
+	      lC_earliest = mC1_inbox[m].time;
+	  if ( (!mC1_steps.empty() && !(mC1_steps.back() < lC_earliest)) ||
+	       (mb_replayPending && lC_earliest < mC_replayTime) ) {
+	    rollback(lC_earliest);
+	    // throttle: run less far ahead after a rollback
+	    mi_window = std::max(1u, mi_window/2);
+	  }
+	  else
+	    mi_window = std::min(ai_batch, 2*mi_window);
+	}
+	else
+	  mi_window = std::min(ai_batch, 2*mi_window);
+
+	for (std::size_t m = 0; m < mC1_inbox.size(); m++) {
+	  const Message& lCr_message = mC1_inbox[m];
+	  if (lCr_message.anti)
+	    mCC_pending.erase(lCr_message);
+	  else
+	    mCC_pending.insert(lCr_message);
+	}
+	mC1_inbox.clear();
+
+	for (unsigned int n = 0; n < mi_window; n++) {
+	  Time lC_time = nextTime();
+	  if (lC_time.t >= ad_limit)
+	    break;
+	  step(lC_time);
+	}
+      }
+
+      /**
+       * Discards the history before the GVT and moves the output before it
+       * to the committed log.
+       *
+       * @param aCr_gvt global virtual time
+       * @param aCr_committed receives the committed output
+       */
+      void fossilCollect(const Time& aCr_gvt,
+			 std::vector<Output>& aCr_committed)
+      {
+	while (!mC1_checkpoints.empty() &&
+	       mC1_checkpoints.front().time < aCr_gvt)
+	  mC1_checkpoints.pop_front();
+	while (!mC1_processed.empty() && mC1_processed.front().time < aCr_gvt)
+	  mC1_processed.pop_front();
+	while (!mC1_sent.empty() && mC1_sent.front().time < aCr_gvt)
+	  mC1_sent.pop_front();
+	while (!mC1_steps.empty() && mC1_steps.front() < aCr_gvt)
+	  mC1_steps.pop_front();
+	while (!mC1_log.empty() && mC1_log.front().time < aCr_gvt) {
+	  aCr_committed.push_back(mC1_log.front());
+	  mC1_log.pop_front();
+	}
+      }
+
+      /**
+       * Moves the messages sent to another partition into its inbox.
+       *
+       * @param aCr_target receiving partition
+       */
+      void send(Partition& aCr_target)
+      {
+	std::vector<Message>& lCr_outbox = mC1_outboxes[aCr_target.mi_id];
+	aCr_target.mC1_inbox.insert(aCr_target.mC1_inbox.end(),
+				    lCr_outbox.begin(), lCr_outbox.end());
+	lCr_outbox.clear();
+      }
+
+      /** statistics */
+      unsigned long processed() const { return ml_processed; }
+      unsigned long rolledBack() const { return ml_rolledBack; }
+      unsigned long rollbacks() const { return ml_rollbacks; }
+      unsigned long antiMessages() const { return ml_antiMessages; }
+
+    private:
+
+      /** an entry in the schedule */
+      struct Entry {
+	Time tN;
+	std::size_t index;
+	bool operator>(const Entry& aCr_entry) const {
+	  return (aCr_entry.tN < tN ||
+		  (tN == aCr_entry.tN && index > aCr_entry.index));
+	}
+      };
+
+      /** the state of an atomic model before a transition */
+      struct Checkpoint {
+	Time time;
+	std::size_t index;
+	double tL;
+	Time tN;
+	std::string state;
+      };
+
+      /** activity flags */
+      enum { INACTIVE = 0, IMMINENT = 1, RECEIVER = 2 };
+
+      void schedule(std::size_t ai_index)
+      {
+	if (mC1_tN[ai_index].t < adevs_inf<double>()) {
+	  Entry lC_entry = { mC1_tN[ai_index], ai_index };
+	  mC_schedule.push(lC_entry);
+	}
+      }
+
+      void reschedule()
+      {
+	std::priority_queue< Entry, std::vector<Entry>, std::greater<Entry> >
+	  lC_schedule;
+	mC_schedule.swap(lC_schedule);
+	for (std::size_t i = 0; i < mC1_atomics.size(); i++)
+	  schedule(i);
+      }
+
+      /**
+       * Executes one Parallel DEVS step.
+       *
+       * @param aCr_time time of the step
+       */
+      void step(const Time& aCr_time)
+      {
+	mC_time = aCr_time;
+	mb_replay = (mb_replayPending && mC_time == mC_replayTime);
+	mb_replayPending = false;
+
+	while (!mC_schedule.empty() && mC_schedule.top().tN == mC_time) {
+	  std::size_t i = mC_schedule.top().index;
+	  mC_schedule.pop();
+	  if (mC1_tN[i] == mC_time && mC1_active[i] == INACTIVE) {
+	    mC1_active[i] = IMMINENT;
+	    mC1_imminent.push_back(i);
+	    mC1_activated.push_back(i);
+	  }
+	}
+
+	// input from other partitions
+	while (!mCC_pending.empty() && mCC_pending.begin()->time == mC_time) {
+	  const Message& lCr_message = *mCC_pending.begin();
+	  ATOMIC* lCp_atomic = lCr_message.model->typeIsAtomic();
+	  if (lCp_atomic != NULL)
+	    deliver(lCp_atomic, lCr_message.value);
+	  else			// input to a component network
+	    route(lCr_message.model->typeIsNetwork(), lCr_message.model,
+		  lCr_message.value, 0);
+	  mC1_processed.push_back(lCr_message);
+	  mCC_pending.erase(mCC_pending.begin());
+	}
+
+	// output of the imminent models
+	for (std::size_t k = 0; k < mC1_imminent.size(); k++) {
+	  std::size_t i = mC1_imminent[k];
+	  mC1_atomics[i]->output_func(mC1_output[i]);
+	}
+	for (std::size_t k = 0; k < mC1_imminent.size(); k++) {
+	  std::size_t i = mC1_imminent[k];
+	  ATOMIC* lCp_atomic = mC1_atomics[i];
+	  adevs::Bag<IO_Type>& lCr_output = mC1_output[i];
+	  for (adevs::Bag<IO_Type>::iterator iter = lCr_output.begin();
+	       iter != lCr_output.end(); iter++)
+	    route(lCp_atomic->getParent(), lCp_atomic, *iter, 0);
+	}
+
+	// save the state of the active models, then compute their transitions
+	std::sort(mC1_activated.begin(), mC1_activated.end());
+	for (std::size_t k = 0; k < mC1_activated.size(); k++) {
+	  std::size_t i = mC1_activated[k];
+	  ATOMIC* lCp_atomic = mC1_atomics[i];
+
+	  mC1_checkpoints.push_back(Checkpoint());
+	  Checkpoint& lCr_checkpoint = mC1_checkpoints.back();
+	  lCr_checkpoint.time = mC_time;
+	  lCr_checkpoint.index = i;
+	  lCr_checkpoint.tL = mC1_tL[i];
+	  lCr_checkpoint.tN = mC1_tN[i];
+	  mC1_states[i]->saveState(lCr_checkpoint.state);
+
+	  if (mC1_active[i] == IMMINENT) {
+	    if (mC1_input[i].empty())
+	      lCp_atomic->delta_int();
+	    else
+	      lCp_atomic->delta_conf(mC1_input[i]);
+	  }
+	  else
+	    lCp_atomic->delta_ext(mC_time.t - mC1_tL[i], mC1_input[i]);
+
+	  mC1_tL[i] = mC_time.t;
+	  double ld_ta = lCp_atomic->ta();
+	  double ld_next = (ld_ta < adevs_inf<double>() ? mC_time.t + ld_ta :
+			    adevs_inf<double>());
+	  if (ld_next == mC_time.t) { // next iteration at the same time
+	    mC1_tN[i].t = mC_time.t;
+	    mC1_tN[i].k = mC_time.k + 1;
+	  }
+	  else {
+	    mC1_tN[i].t = ld_next;
+	    mC1_tN[i].k = 0;
+	  }
+	  ml_processed++;
+	}
+
+	for (std::size_t k = 0; k < mC1_imminent.size(); k++) {
+	  std::size_t i = mC1_imminent[k];
+	  mC1_atomics[i]->gc_output(mC1_output[i]);
+	  mC1_output[i].clear();
+	}
+
+	for (std::size_t k = 0; k < mC1_activated.size(); k++) {
+	  std::size_t i = mC1_activated[k];
+	  mC1_input[i].clear();
+	  mC1_active[i] = INACTIVE;
+	  schedule(i);
+	}
+
+	mC1_imminent.clear();
+	mC1_activated.clear();
+	mC1_steps.push_back(mC_time);
+
+	// drop stale entries once they outnumber the live ones
+	if (mC_schedule.size() > 2*mC1_atomics.size() + 64)
+	  reschedule();
+      }
+
+      /**
+       * Undoes the transitions at or after the specified time. The output
+       * at that time depends only on the state before it, so it stands:
+       * only the messages and output after it are cancelled, and when the
+       * step is executed again its output is routed locally but not sent
+       * or logged again.
+       *
+       * @param aCr_time rollback time
+       */
+      void rollback(const Time& aCr_time)
+      {
+	ml_rollbacks++;
+
+	// restore the state before the earliest undone transition of each
+	// model: checkpoints are undone latest first
+	while (!mC1_checkpoints.empty() &&
+	       !(mC1_checkpoints.back().time < aCr_time)) {
+	  const Checkpoint& lCr_checkpoint = mC1_checkpoints.back();
+	  std::size_t i = lCr_checkpoint.index;
+	  mC1_states[i]->restoreState(lCr_checkpoint.state);
+	  mC1_tL[i] = lCr_checkpoint.tL;
+	  mC1_tN[i] = lCr_checkpoint.tN;
+	  mC1_checkpoints.pop_back();
+	  ml_rolledBack++;
+	}
+
+	// messages received are processed again
+	while (!mC1_processed.empty() &&
+	       !(mC1_processed.back().time < aCr_time)) {
+	  mCC_pending.insert(mC1_processed.back());
+	  mC1_processed.pop_back();
+	}
+
+	// messages sent after the rollback time are cancelled
+	while (!mC1_sent.empty() && aCr_time < mC1_sent.back().time) {
+	  Message& lCr_message = mC1_sent.back();
+	  lCr_message.anti = true;
+	  mC1_outboxes[lCr_message.dst].push_back(lCr_message);
+	  mC1_sent.pop_back();
+	  ml_antiMessages++;
+	}
+
+	while (!mC1_log.empty() && aCr_time < mC1_log.back().time)
+	  mC1_log.pop_back();
+
+	mb_replayPending = false;
+	while (!mC1_steps.empty() && !(mC1_steps.back() < aCr_time)) {
+	  if (mC1_steps.back() == aCr_time) {
+	    mb_replayPending = true;
+	    mC_replayTime = aCr_time;
+	  }
+	  mC1_steps.pop_back();
+	}
+
+	reschedule();
+      }
+
+      void route(NETWORK* aCp_parent, DEVS* aCp_src, const IO_Type& aCr_value,
+		 std::size_t ai_depth)
+      {
+	// mirrors adevs::Simulator::route (see ParallelSimulator::route);
+	// output that stood through a rollback is not logged or sent again
+	if (aCp_parent != aCp_src && !mb_replay) {
+	  Output lC_output = { mC_time,
+			       adevs::Event<IO_Type>(aCp_src, aCr_value) };
+	  mC1_log.push_back(lC_output);
+	}
+	if (aCp_parent == NULL)
+	  return;
+
+	if (mCC_receivers.size() <= ai_depth)
+	  mCC_receivers.resize(ai_depth + 1);
+	adevs::Bag< adevs::Event<IO_Type> >& lCr_receivers =
+	  mCC_receivers[ai_depth];
+	lCr_receivers.clear();
+
+	aCp_parent->route(aCr_value, aCp_src, lCr_receivers);
+
+	for (adevs::Bag< adevs::Event<IO_Type> >::iterator iter =
+	       lCr_receivers.begin(); iter != lCr_receivers.end(); iter++) {
+	  DEVS* lCp_model = (*iter).model;
+	  if (lCp_model == aCp_parent) { // output of the network
+	    route(aCp_parent->getParent(), aCp_parent, (*iter).value,
+		  ai_depth + 1);
+	    continue;
+	  }
+
+	  // input to a component of the root owned by another partition
+	  if (aCp_parent == mCp_root) {
+	    PartitionMap::const_iterator lC_owner = mCr_owners.find(lCp_model);
+	    if (lC_owner == mCr_owners.end())
+	      throw std::logic_error("TimeWarpSimulator: event routed to a "
+				     "model that is not part of the "
+				     "simulated hierarchy");
+	    if (lC_owner->second != mi_id) {
+	      if (mb_replay)
+		continue;
+	      Message lC_message = { mC_time, mi_id, ml_serial++,
+				     lC_owner->second, lCp_model,
+				     (*iter).value, false };
+	      mC1_outboxes[lC_owner->second].push_back(lC_message);
+	      mC1_sent.push_back(lC_message);
+	      continue;
+	    }
+	  }
+
+	  ATOMIC* lCp_atomic = lCp_model->typeIsAtomic();
+	  if (lCp_atomic != NULL)
+	    deliver(lCp_atomic, (*iter).value);
+	  else			// input to a component network
+	    route(lCp_model->typeIsNetwork(), lCp_model, (*iter).value,
+		  ai_depth + 1);
+	}
+      }
+
+      void deliver(ATOMIC* aCp_atomic, const IO_Type& aCr_value)
+      {
+	std::unordered_map<const DEVS*, std::size_t>::const_iterator iter =
+	  mCC_indices.find(aCp_atomic);
+	if (iter == mCC_indices.end())
+	  throw std::logic_error("TimeWarpSimulator: event routed to a "
+				 "model that is not part of the partition");
+
+	std::size_t i = iter->second;
+	if (mC1_active[i] == INACTIVE) {
+	  mC1_active[i] = RECEIVER;
+	  mC1_activated.push_back(i);
+	}
+	mC1_input[i].insert(aCr_value);
+      }
+
+      /** partition index */
+      std::size_t mi_id;
+
+      /** root network */
+      NETWORK* mCp_root;
+
+      /** partition that owns each model under the root */
+      const PartitionMap& mCr_owners;
+
+      /** atomic models, their state interfaces, and the index of each */
+      std::vector<ATOMIC*> mC1_atomics;
+      std::vector<Checkpointable*> mC1_states;
+      std::unordered_map<const DEVS*, std::size_t> mCC_indices;
+
+      /** time of last and next event of each atomic model */
+      std::vector<double> mC1_tL;
+      std::vector<Time> mC1_tN;
+
+      /** input and output bags of each atomic model */
+      std::vector< adevs::Bag<IO_Type> > mC1_input;
+      std::vector< adevs::Bag<IO_Type> > mC1_output;
+
+      /** activity flag of each atomic model for the current step */
+      std::vector<char> mC1_active;
+
+      /** imminent and active models at the current step */
+      std::vector<std::size_t> mC1_imminent;
+      std::vector<std::size_t> mC1_activated;
+
+      /** schedule: min-heap of next event times (may hold stale entries) */
+      std::priority_queue< Entry, std::vector<Entry>, std::greater<Entry> >
+      mC_schedule;
+
+      /** messages received since the last round, in arrival order */
+      std::vector<Message> mC1_inbox;
+
+      /** messages not yet processed, in (time, sender) order */
+      std::set<Message> mCC_pending;
+
+      /** messages processed since the GVT, in processing order */
+      std::deque<Message> mC1_processed;
+
+      /** messages sent since the GVT, in sending order */
+      std::deque<Message> mC1_sent;
+
+      /** messages (and anti-messages) to send, by receiving partition */
+      std::vector< std::vector<Message> > mC1_outboxes;
+
+      /** checkpoints since the GVT, in execution order */
+      std::deque<Checkpoint> mC1_checkpoints;
+
+      /** times of the steps since the GVT */
+      std::deque<Time> mC1_steps;
+
+      /** output events not yet committed */
+      std::deque<Output> mC1_log;
+
+      /** receiver bags, one per routing depth (deque: stable references) */
+      std::deque< adevs::Bag< adevs::Event<IO_Type> > > mCC_receivers;
+
+      /** current time */
+      Time mC_time;
+
+      /** whether the current step is executed again after a rollback */
+      bool mb_replay;
+
+      /** a step whose output stood through a rollback, to be executed again */
+      bool mb_replayPending;
+      Time mC_replayTime;
+
+      /** number of steps to run ahead in the next round */
+      unsigned int mi_window;
+
+      /** counter for the messages sent */
+      unsigned long ml_serial;
+
+      /** statistics */
+      unsigned long ml_processed;
+      unsigned long ml_rolledBack;
+      unsigned long ml_rollbacks;
+      unsigned long ml_antiMessages;
+
+    };				// class TimeWarpSimulator::Partition
+
+    TimeWarpSimulator::TimeWarpSimulator(DEVS* aCp_model,
+					 unsigned int ai_partitions,
+					 unsigned int ai_batch) :
+      md_timeEnd(adevs_inf<double>()),
+      mi_batch(ai_batch > 0 ? ai_batch : 1)
+    {
+      std::vector< std::vector<DEVS*> > lCC_components;
+      std::size_t ll_partitions =
+	partitionModel(aCp_model, ai_partitions, lCC_components, mCC_owners);
+
+      NETWORK* lCp_root = aCp_model->typeIsNetwork();
+      for (std::size_t p = 0; p < ll_partitions; p++) {
+	mC1_partitions.push_back(std::unique_ptr<Partition>
+				 (new Partition(p, lCp_root, mCC_owners,
+						ll_partitions)));
+	for (std::size_t c = 0; c < lCC_components[p].size(); c++)
+	  mC1_partitions[p]->add(lCC_components[p][c]);
+	mC1_partitions[p]->initialize();
+      }
+
+      mC_gvt.t = adevs_inf<double>();
+      mC_gvt.k = 0;
+      for (std::size_t p = 0; p < ll_partitions; p++) {
+	Time lC_time = mC1_partitions[p]->nextTime();
+	if (lC_time < mC_gvt)
+	  mC_gvt = lC_time;
+      }
+
+      mCp_pool.reset(new efscape::utils::ThreadPool(ll_partitions));
+    }
+
+    TimeWarpSimulator::~TimeWarpSimulator() {}
+
+    double TimeWarpSimulator::nextEventTime()
+    {
+      return mC_gvt.t;
+    }
+
+    void TimeWarpSimulator::execNextEvent()
+    {
+      round(md_timeEnd);
+    }
+
+    void TimeWarpSimulator::execUntil(double ad_tEnd)
+    {
+      // events at ad_tEnd are executed
+      double ld_limit = std::min(md_timeEnd,
+				 std::nextafter(ad_tEnd, adevs_inf<double>()));
+      while (mC_gvt.t < ld_limit)
+	round(ld_limit);
+    }
+
+    void TimeWarpSimulator::addEventListener(adevs::EventListener<IO_Type>*
+					     aCp_listener)
+    {
+      mC1_listeners.push_back(aCp_listener);
+    }
+
+    unsigned long TimeWarpSimulator::numProcessed() const
+    {
+      unsigned long ll_count = 0;
+      for (std::size_t p = 0; p < mC1_partitions.size(); p++)
+	ll_count += mC1_partitions[p]->processed();
+      return ll_count;
+    }
+
+    unsigned long TimeWarpSimulator::numRolledBack() const
+    {
+      unsigned long ll_count = 0;
+      for (std::size_t p = 0; p < mC1_partitions.size(); p++)
+	ll_count += mC1_partitions[p]->rolledBack();
+      return ll_count;
+    }
+
+    unsigned long TimeWarpSimulator::numRollbacks() const
+    {
+      unsigned long ll_count = 0;
+      for (std::size_t p = 0; p < mC1_partitions.size(); p++)
+	ll_count += mC1_partitions[p]->rollbacks();
+      return ll_count;
+    }
+
+    unsigned long TimeWarpSimulator::numAntiMessages() const
+    {
+      unsigned long ll_count = 0;
+      for (std::size_t p = 0; p < mC1_partitions.size(); p++)
+	ll_count += mC1_partitions[p]->antiMessages();
+      return ll_count;
+    }
+
+    double TimeWarpSimulator::efficiency() const
+    {
+      unsigned long ll_processed = numProcessed();
+      if (ll_processed == 0)
+	return 1.;
+      return double(ll_processed - numRolledBack())/ll_processed;
+    }
+
+    void TimeWarpSimulator::round(double ad_limit)
+    {
+      if (mC_gvt.t >= ad_limit)
+	return;
+
+      //------------------------------------------------------------------
+      // 1. deliver the messages sent in the last round, then let every
+      //    partition absorb them and run ahead
+      //------------------------------------------------------------------
+      exchange();
+
+      std::vector< std::unique_ptr<Partition> >& lCr_partitions =
+	mC1_partitions;
+      unsigned int li_batch = mi_batch;
+      mCp_pool->parallel_for(mC1_partitions.size(),
+			     [&lCr_partitions, ad_limit, li_batch]
+			     (std::size_t p) {
+			       lCr_partitions[p]->run(ad_limit, li_batch);
+			     });
+
+      //------------------------------------------------------------------
+      // 2. GVT: no message in transit other than those in the outboxes
+      //------------------------------------------------------------------
+      mC_gvt.t = adevs_inf<double>();
+      mC_gvt.k = 0;
+      for (std::size_t p = 0; p < mC1_partitions.size(); p++) {
+	Time lC_time = mC1_partitions[p]->nextTime();
+	if (lC_time < mC_gvt)
+	  mC_gvt = lC_time;
+	lC_time = mC1_partitions[p]->nextSendTime();
+	if (lC_time < mC_gvt)
+	  mC_gvt = lC_time;
+      }
+
+      //------------------------------------------------------------------
+      // 3. fossil collection, and commit the output before the GVT
+      //------------------------------------------------------------------
+      std::vector<Partition::Output> lC1_committed;
+      for (std::size_t p = 0; p < mC1_partitions.size(); p++)
+	mC1_partitions[p]->fossilCollect(mC_gvt, lC1_committed);
+      std::stable_sort(lC1_committed.begin(), lC1_committed.end());
+
+      for (std::size_t k = 0; k < lC1_committed.size(); k++)
+	for (std::size_t l = 0; l < mC1_listeners.size(); l++)
+	  mC1_listeners[l]->outputEvent(lC1_committed[k].event,
+					lC1_committed[k].time.t);
+    }
+
+    void TimeWarpSimulator::exchange()
+    {
+      for (std::size_t p = 0; p < mC1_partitions.size(); p++)
+	for (std::size_t q = 0; q < mC1_partitions.size(); q++)
+	  if (p != q)
+	    mC1_partitions[p]->send(*mC1_partitions[q]);
+    }
+
+  } // namespace impl
+
+} // namespace efscape
@@ -0,0 +1,179 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : TimeWarpSimulator.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_IMPL_TIMEWARPSIMULATOR_HPP
+#define EFSCAPE_IMPL_TIMEWARPSIMULATOR_HPP
+
+#include <efscape/impl/efscapelib.hpp>
+#include <efscape/impl/ModelPartition.hpp>
+#include <efscape/utils/ThreadPool.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace efscape {
+
+  namespace impl {
+
+    /**
+     * Implements an optimistic (Time Warp) parallel simulator for a
+     * network model. As with the PartitionedSimulator, the components of
+     * the root network are split into partitions, each simulated by its
+     * own thread. Here, though, a partition does not wait until it is safe
+     * to process an event. It runs ahead, and if a message arrives in its
+     * past (a straggler), it rolls back:
+     * - the state of every atomic model that changed after the straggler
+     *   is restored from the checkpoint saved before its transition (state
+     *   saving is incremental: only the models that take part in a
+     *   transition are saved);
+     * - the messages it received after the straggler are processed again;
+     *   and
+     * - the messages it sent after the straggler are cancelled with
+     *   anti-messages, which may roll back their receivers in turn.
+     *
+     * After each round the simulator computes the global virtual time
+     * (GVT), the earliest time that can still be rolled back. Checkpoints
+     * and messages older than the GVT are discarded (fossil collection).
+     * Output older than the GVT is committed and reported to listeners, in
+     * time order, on the calling thread.
+     *
+     * Time is superdense: events at the same time are ordered by their
+     * Parallel DEVS iteration, so transitions with a time advance of 0 are
+     * handled as adevs::Simulator handles them.
+     *
+     * Every atomic model must implement Checkpointable (e.g. through
+     * CerealCheckpointable) and must only change its state in its
+     * transition functions. The other requirements on the model are those
+     * of ParallelSimulator. State changes are not reported.
+     */
+    class TimeWarpSimulator
+    {
+    public:
+
+      /**
+       * constructor
+       *
+       * @param aCp_model handle to root model
+       * @param ai_partitions number of partitions (and threads)
+       * @param ai_batch maximum number of steps a partition executes
+       *                 optimistically in each round
+       * @throws std::logic_error if an atomic model is not Checkpointable
+       */
+      TimeWarpSimulator(DEVS* aCp_model, unsigned int ai_partitions,
+			unsigned int ai_batch = 64);
+
+      /** destructor */
+      ~TimeWarpSimulator();
+
+      /** @returns the global virtual time (adevs_inf if done) */
+      double nextEventTime();
+
+      /**
+       * Executes one round: each partition absorbs its messages (rolling
+       * back if necessary) and runs ahead, then the GVT is advanced and the
+       * output before it committed.
+       */
+      void execNextEvent();
+
+      /**
+       * Executes events until the GVT is greater than the specified time.
+       *
+       * @param ad_tEnd end time
+       */
+      void execUntil(double ad_tEnd);
+
+      /**
+       * Sets the end of the simulation: events at or after this time are
+       * not executed.
+       *
+       * @param ad_timeEnd end time
+       */
+      void setEndTime(double ad_timeEnd) { md_timeEnd = ad_timeEnd; }
+
+      /**
+       * Adds an event listener, notified of every committed output event.
+       *
+       * @param aCp_listener handle to listener
+       */
+      void addEventListener(adevs::EventListener<IO_Type>* aCp_listener);
+
+      /** @returns number of partitions */
+      std::size_t numPartitions() const { return mC1_partitions.size(); }
+
+      /** @returns number of transitions executed, including rolled back */
+      unsigned long numProcessed() const;
+
+      /** @returns number of transitions undone by rollbacks */
+      unsigned long numRolledBack() const;
+
+      /** @returns number of rollbacks */
+      unsigned long numRollbacks() const;
+
+      /** @returns number of anti-messages sent */
+      unsigned long numAntiMessages() const;
+
+      /** @returns fraction of the executed transitions that were kept */
+      double efficiency() const;
+
+    private:
+
+      TimeWarpSimulator(const TimeWarpSimulator&);
+      TimeWarpSimulator& operator=(const TimeWarpSimulator&);
+
+      /** superdense time: time and Parallel DEVS iteration */
+      struct Time {
+	double t;
+	unsigned long k;
+	bool operator<(const Time& aCr_time) const {
+	  return (t < aCr_time.t || (t == aCr_time.t && k < aCr_time.k));
+	}
+	bool operator==(const Time& aCr_time) const {
+	  return (t == aCr_time.t && k == aCr_time.k);
+	}
+      };
+
+      class Partition;
+
+      void round(double ad_limit);
+      void exchange();
+
+      /** partitions */
+      std::vector< std::unique_ptr<Partition> > mC1_partitions;
+
+      /** partition that owns each model under the root */
+      PartitionMap mCC_owners;
+
+      /** event listeners */
+      std::vector< adevs::EventListener<IO_Type>* > mC1_listeners;
+
+      /** thread pool, one thread per partition */
+      std::unique_ptr<efscape::utils::ThreadPool> mCp_pool;
+
+      /** global virtual time */
+      Time mC_gvt;
+
+      /** end time */
+      double md_timeEnd;
+
+      /** maximum number of optimistic steps per round */
+      unsigned int mi_batch;
+
+    };				// class TimeWarpSimulator
+
+  } // namespace impl
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_IMPL_TIMEWARPSIMULATOR_HPP
@@ -14,6 +14,7 @@
 // PERFORMANCE OF THIS SOFTWARE.
 // __COPYRIGHT_END__
 #include <efscape/impl/adevs_json.hpp>
+#include <efscape/impl/CompiledDigraph.hpp>
 
 #include <efscape/impl/ModelHomeI.hpp>
 
@@ -23,7 +24,8 @@ namespace efscape {
 
 
     // utility function for building a model from JSON
-    DEVS* buildModelFromJSON(Json::Value aC_config) {
+    DEVS* buildModelFromJSON(Json::Value aC_config,
+			     LookaheadMap* aCp_lookaheads) {
       // This function supports the following model type configurations:
       // 1. ATOMIC
       //    a. ModelWrapper (contains a "wrappedModel")
@@ -81,7 +83,8 @@ namespace efscape {
 	    LOG4CXX_DEBUG(ModelHomeI::getLogger(),
 			  "This is a Digraph");
 	    lCp_model = DigraphBuilder::build_digraph_from_json(aC_config,
-								lCp_digraph);
+								lCp_digraph,
+								aCp_lookaheads);
 	    if (!lCp_model)
 	      return lCp_model;	// should be NULL
 	    
@@ -111,7 +114,8 @@ namespace efscape {
 	      return NULL;
 	    }
 
-	    DEVSPtr lCp_wrappedModel( buildModelFromJSON(lC_wrappedModel ) );
+	    DEVSPtr lCp_wrappedModel( buildModelFromJSON(lC_wrappedModel,
+							  aCp_lookaheads) );
 	    
 	    if (lCp_wrappedModel) { // if the wrappedModel exists
 	      LOG4CXX_DEBUG(ModelHomeI::getLogger(),
@@ -132,9 +136,11 @@ namespace efscape {
 			  "Attempting to load properties for model <"
 			  << lC_modelTypeName << ">");
 
+	    static const PortType lC_propertiesPort("properties_in");
+
 	    adevs::Bag<efscape::impl::IO_Type> xb;
 	    efscape::impl::IO_Type e;
-	    e.port = "properties_in";
+	    e.port = lC_propertiesPort;
 	    e.value = lC_properties;
 	    
 	    xb.insert(e);
@@ -150,7 +156,7 @@ namespace efscape {
       
       return lCp_model;
       
-    } // buildModelFromJSON(const Json::Value&)
+    } // buildModelFromJSON(const Json::Value&, LookaheadMap*)
 
     //
     // DigraphBuilder
@@ -181,7 +187,8 @@ namespace efscape {
     }
 
     DEVS* DigraphBuilder::build_digraph_from_json(const Json::Value& aCr_value,
-						  DIGRAPH* aCp_digraph)
+						  DIGRAPH* aCp_digraph,
+						  LookaheadMap* aCp_lookaheads)
     {
       Json::Value lC_modelsAttribute = aCr_value["models"];
       Json::Value lC1_couplings = aCr_value["couplings"];
@@ -208,7 +215,8 @@ namespace efscape {
       
       for (int i = 0; i < lC_memberNames.size(); i++) {
 	DEVS* lCp_subModel =
-	  buildModelFromJSON(lC_modelsAttribute[ lC_memberNames[i] ] );
+	  buildModelFromJSON(lC_modelsAttribute[ lC_memberNames[i] ],
+			     aCp_lookaheads);
 	if (lCp_subModel) {
 	  LOG4CXX_DEBUG(ModelHomeI::getLogger(),
 			"Adding model <"
@@ -216,6 +224,13 @@ namespace efscape {
 			<< ">");
 	  lCC_modelMap[ lC_memberNames[i] ] = lCp_subModel;
 	  aCp_digraph->add(lCp_subModel);
+
+	  // record the declared lookahead of the component, if any
+	  Json::Value lC_lookahead =
+	    lC_modelsAttribute[ lC_memberNames[i] ].get("lookahead",
+							Json::Value());
+	  if (aCp_lookaheads && lC_lookahead.isNumeric())
+	    (*aCp_lookaheads)[lCp_subModel] = lC_lookahead.asDouble();
 	}
 	else {
 	  LOG4CXX_DEBUG(ModelHomeI::getLogger(),
@@ -229,7 +244,9 @@ namespace efscape {
 	}
       }
 
-      // add couplings
+      // add couplings (recorded in the routing table of a CompiledDigraph)
+      CompiledDigraph* lCp_compiled =
+	dynamic_cast<CompiledDigraph*>(aCp_digraph);
       for (int i = 0; i < lC1_couplings.size(); i++) {
 	Json::Value lC_edgeValue = lC1_couplings[i];
 	struct edge dgc;
@@ -249,17 +266,30 @@ namespace efscape {
 	}
 	DEVS* fromModel = lCC_modelMap[dgc.from.model];
 
-	if (lCC_modelMap.find(dgc.from.model) == lCC_modelMap.end()) {
+	if (lCC_modelMap.find(dgc.to.model) == lCC_modelMap.end()) {
 	  LOG4CXX_DEBUG(ModelHomeI::getLogger(),
-			"model <" << dgc.from.model << "> not found");
+			"model <" << dgc.to.model << "> not found");
 	  continue;
 	}
 	DEVS* toModel = lCC_modelMap[dgc.to.model];
 
-	aCp_digraph->couple(fromModel, dgc.from.port,
-			    toModel, dgc.to.port);
+	// resolve the port names to port symbols once, at build time
+	PortType lC_fromPort(dgc.from.port);
+	PortType lC_toPort(dgc.to.port);
+
+	if (lCp_compiled)
+	  lCp_compiled->couple(fromModel, lC_fromPort,
+			       toModel, lC_toPort);
+	else
+	  aCp_digraph->couple(fromModel, lC_fromPort,
+			      toModel, lC_toPort);
       }
 
+      // freeze the couplings into the routing table now, rather than when
+      // the first event is routed
+      if (lCp_compiled)
+	lCp_compiled->compile();
+
       return aCp_digraph;
     }
 
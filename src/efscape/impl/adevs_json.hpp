@@ -30,9 +30,13 @@ namespace efscape {
      * to build the specified adevs model.
      *
      * @param aC_config JSON value containing model configuration
+     * @param aCp_lookaheads if not null, receives the lookahead declared
+     *                       for each component of a digraph (see
+     *                       PartitionedSimulator)
      * @returns handle to model 
      */   
-    DEVS* buildModelFromJSON(Json::Value lC_config);
+    DEVS* buildModelFromJSON(Json::Value lC_config,
+			     LookaheadMap* aCp_lookaheads = NULL);
     
     /**
      * A simple class that provides scaffolding for building a Digraph
@@ -209,12 +213,17 @@ namespace efscape {
       /**
        * Builds a digraph from a JSON object
        *
+       * The configuration of each component may declare a "lookahead" (see
+       * PartitionedSimulator).
+       *
        * @param aCr_value JSON value
        * @param aCp_digraph pointer to digraph
+       * @param aCp_lookaheads if not null, receives the declared lookaheads
        * @returns pointer to DEVS model if successfull
        */
       static DEVS* build_digraph_from_json(const Json::Value& aCr_value,
-					   DIGRAPH* aCp_digraph);
+					   DIGRAPH* aCp_digraph,
+					   LookaheadMap* aCp_lookaheads = NULL);
 
     private:
       /** map of models */
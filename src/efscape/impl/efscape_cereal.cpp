@@ -26,6 +26,7 @@
 // efscape adevs definitions
 #include <efscape/impl/efscapelib.hpp>
 #include <efscape/impl/SimRunner.hpp>
+#include <efscape/impl/CompiledDigraph.hpp>
 
 // definitions for accessing the model home
 #include <efscape/impl/ModelHomeI.hpp>
@@ -49,14 +50,18 @@ namespace cereal
 	cereal::make_nvp("port", node.port) );
   }
 
+  template <class Archive>
+  struct specialize<Archive, efscape::impl::CompiledDigraph, cereal::specialization::member_load_save> {};
+
   template <class Archive>
   struct specialize<Archive, efscape::impl::ModelWrapperBase, cereal::specialization::non_member_load_save> {};
 
   template <class Archive>
-  struct specialize<Archive, efscape::impl::SimRunner, cereal::specialization::member_serialize> {};
+  struct specialize<Archive, efscape::impl::SimRunner, cereal::specialization::member_load_save> {};
 
 }
 
+#include <cereal/archives/portable_binary.hpp>
 #include <cereal/archives/json.hpp>
 #include <cereal/archives/xml.hpp>
 
@@ -64,6 +69,7 @@ CEREAL_REGISTER_TYPE(efscape::impl::DEVS);
 CEREAL_REGISTER_TYPE(efscape::impl::ATOMIC);
 CEREAL_REGISTER_TYPE(efscape::impl::NETWORK);
 CEREAL_REGISTER_TYPE(efscape::impl::DIGRAPH);
+CEREAL_REGISTER_TYPE(efscape::impl::CompiledDigraph);
 CEREAL_REGISTER_TYPE(efscape::impl::ModelWrapperBase);
 CEREAL_REGISTER_TYPE(efscape::impl::SimRunner);
 CEREAL_REGISTER_POLYMORPHIC_RELATION(efscape::impl::DEVS,
@@ -72,6 +78,8 @@ CEREAL_REGISTER_POLYMORPHIC_RELATION(efscape::impl::DEVS,
 				     efscape::impl::NETWORK );
 CEREAL_REGISTER_POLYMORPHIC_RELATION(efscape::impl::NETWORK,
 				     efscape::impl::DIGRAPH );
+CEREAL_REGISTER_POLYMORPHIC_RELATION(efscape::impl::DIGRAPH,
+				     efscape::impl::CompiledDigraph );
 CEREAL_REGISTER_POLYMORPHIC_RELATION(efscape::impl::ATOMIC,
 				     efscape::impl::ModelWrapperBase );
 CEREAL_REGISTER_POLYMORPHIC_RELATION(efscape::impl::ModelWrapperBase,
@@ -81,6 +89,9 @@ CEREAL_REGISTER_POLYMORPHIC_RELATION(efscape::impl::ModelWrapperBase,
 #include <efscape/impl/ModelHomeI.hpp>
 #include <efscape/impl/ModelHomeSingleton.hpp>
 
+#include <algorithm>
+#include <cstdint>
+
 namespace efscape {
   namespace impl {
 
@@ -129,6 +140,80 @@ namespace efscape {
       return lCp_model;
     }
 
+    /** leading bytes of an efscape binary snapshot (.efb) */
+    static const char gcp_efbMagic[4] = { 'E', 'F', 'S', 'B' };
+
+    /** current version of the efscape binary snapshot format */
+    static const std::uint32_t gi_efbVersion = 1;
+
+    /**
+     * This function attemps to serialize and save an adevs model hierarchy via
+     * the cereal serialization library portable binary archive, as an efscape
+     * binary snapshot (.efb). The snapshot starts with the bytes "EFSB",
+     * followed by the archive, which records its byte order, the format
+     * version and the model.
+     *
+     * @param aCp_model handle to model (reference)
+     * @param aCr_ostream output stream (opened in binary mode)
+     */
+    void saveAdevsToBinary(const DEVSPtr& aCp_model,
+			   std::ostream& aCr_ostream)
+    {
+      try {
+	aCr_ostream.write(gcp_efbMagic, sizeof(gcp_efbMagic));
+	cereal::PortableBinaryOutputArchive oa( aCr_ostream );
+
+	oa( cereal::make_nvp("version", gi_efbVersion),
+	    cereal::make_nvp("efscape",aCp_model) );
+      } catch(...) {
+	LOG4CXX_ERROR(ModelHomeI::getLogger(),
+		      "Exception encountered during serialization of adevs model");
+      }
+    }
+
+    /**
+     * This function attempts to load an adevs model hierarchy from an efscape
+     * binary snapshot (.efb). Snapshots written by a later version of the
+     * format are rejected.
+     *
+     * @param aCr_istream reference to input stream (opened in binary mode)
+     * @returns handle to loaded model
+     */
+    DEVSPtr loadAdevsFromBinary(std::istream& aCr_istream)
+    {
+      DEVSPtr lCp_model;
+
+      char lcp_magic[sizeof(gcp_efbMagic)];
+      if ( !aCr_istream.read(lcp_magic, sizeof(lcp_magic)) ||
+	   !std::equal(lcp_magic, lcp_magic + sizeof(lcp_magic),
+		       gcp_efbMagic) ) {
+	LOG4CXX_ERROR(ModelHomeI::getLogger(),
+		      "Input is not an efscape binary snapshot");
+	return lCp_model;
+      }
+
+      try {
+	cereal::PortableBinaryInputArchive ia( aCr_istream );
+
+	std::uint32_t li_version = 0;
+	ia( cereal::make_nvp("version", li_version) );
+	if (li_version > gi_efbVersion) {
+	  LOG4CXX_ERROR(ModelHomeI::getLogger(),
+			"Unsupported efscape binary snapshot version <"
+			<< li_version << ">");
+	  return lCp_model;
+	}
+
+	ia( cereal::make_nvp("efscape",lCp_model) );
+      } catch(...) {
+	LOG4CXX_ERROR(ModelHomeI::getLogger(),
+		      "Exception encountered during deserialization of adevs model");
+	lCp_model.reset();
+      }
+
+      return lCp_model;
+    }
+
   } // namespace impl
 
 } // namespace efscape
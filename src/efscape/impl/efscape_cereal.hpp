@@ -17,8 +17,10 @@
 #define EFSCAPE_IMPL_EFSCAPE_CEREAL_HPP
 
 #include <cereal/cereal.hpp>
+#include <cereal/types/string.hpp>
 
 #include <efscape/impl/ClockI.hpp>
+#include <efscape/impl/Payload.hpp>
 
 // cereal serialization
 namespace cereal {
@@ -58,6 +60,33 @@ namespace cereal {
 	cereal::make_nvp("time_units", lC_timeUnits) );
   }
 
+  //
+  // cereal serialization for Payload
+  //
+  template<class Archive>
+  struct PayloadArchiver
+  {
+    Archive& mCr_ar;
+    template<typename T>
+    void operator()(const char* acp_name, T& aCr_value) {
+      mCr_ar( cereal::make_nvp(acp_name, aCr_value) );
+    }
+  };
+
+  template<class Archive>
+  void load(Archive & ar, efscape::impl::Payload& aCr_payload)
+  {
+    PayloadArchiver<Archive> lC_archiver = { ar };
+    efscape::impl::loadPayload(aCr_payload, lC_archiver);
+  }
+
+  template<class Archive>
+  void save(Archive & ar, const efscape::impl::Payload& aCr_payload)
+  {
+    PayloadArchiver<Archive> lC_archiver = { ar };
+    efscape::impl::savePayload(aCr_payload, lC_archiver);
+  }
+
 } // namespace cereal
 
 #endif // #ifndef EFSCAPE_IMPL_EFSCAPE_CEREAL_HPP
@@ -27,6 +27,9 @@
 #include <efscape/impl/adevs_decorator_serialization.hpp>
 
 #include <efscape/impl/SimRunner.hpp>
+#include <efscape/impl/CompiledDigraph.hpp>
+
+#include <boost/serialization/base_object.hpp>
 
 // definitions for accessing the model home
 #include <efscape/impl/ModelHomeI.hpp>
@@ -87,6 +90,24 @@ namespace boost {
  }
 }
 BOOST_CLASS_EXPORT(efscape::impl::DIGRAPH)
+
+namespace boost {
+ namespace serialization {
+   template<class Archive>
+   void serialize(Archive & ar, efscape::impl::CompiledDigraph& digraph,
+		   const unsigned int version)
+   {
+     ar & boost::serialization::make_nvp
+       ("adevs::Digraph",
+	boost::serialization::base_object<efscape::impl::DIGRAPH>(digraph));
+
+     // the couplings of a restored digraph are not recorded
+     if (Archive::is_loading::value)
+       digraph.stopTracking();
+   }
+ }
+}
+BOOST_CLASS_EXPORT(efscape::impl::CompiledDigraph)
 BOOST_CLASS_EXPORT(efscape::impl::ModelWrapperBase)
 
 BOOST_CLASS_EXPORT(efscape::impl::CellDevs)
@@ -18,6 +18,9 @@
 // definitions for accessing the model factory
 #include <efscape/impl/ModelHomeI.hpp>
 #include <efscape/impl/ModelHomeSingleton.hpp>
+#include <efscape/impl/ParallelSimulator.hpp>
+#include <efscape/impl/Cloneable.hpp>
+#include <efscape/utils/MemoryBuffer.hpp>
 
 #include <boost/algorithm/string.hpp>
 
@@ -142,7 +145,54 @@ namespace efscape {
       return lCp_clone;
     }
 
-    void runSim( DEVS* aCp_model, double ad_timeMax ) {
+    DEVSPtr cloneModel( const DEVSPtr& aCp_model ) {
+
+      if (aCp_model == nullptr)
+	return DEVSPtr();
+
+      // 1. the deep copy of the model, if it provides one
+      const Cloneable* lCp_cloneable =
+	dynamic_cast<const Cloneable*>(aCp_model.get());
+      if (lCp_cloneable) {
+	DEVS* lCp_copy = lCp_cloneable->clone();
+	if (lCp_copy)
+	  return DEVSPtr(lCp_copy);
+      }
+
+      // 2. a binary archive, written to and read back from a buffer that is
+      // kept from one clone to the next
+      static thread_local efscape::utils::MemoryBuffer lC_buffer;
+      lC_buffer.reset();
+      {
+	std::ostream lC_buffer_out(&lC_buffer);
+	saveAdevsToBinary(aCp_model, lC_buffer_out);
+      }
+      if (lC_buffer.size() > 0) {
+	lC_buffer.rewind();
+	std::istream lC_buffer_in(&lC_buffer);
+	DEVSPtr lCp_clone = loadAdevsFromBinary(lC_buffer_in);
+	if (lCp_clone)
+	  return lCp_clone;
+      }
+
+      // 3. a JSON archive
+      LOG4CXX_DEBUG(ModelHomeI::getLogger(),
+		    "Binary clone failed: cloning the model using JSON");
+      return cloneModelUsingJSON(aCp_model);
+    }
+
+    void runSim( DEVS* aCp_model, double ad_timeMax,
+		 unsigned int ai_threads ) {
+      if (ai_threads > 1) {
+	ParallelSimulator lC_sim( aCp_model, ai_threads );
+
+	// simulate model until infinity
+	while (lC_sim.nextEventTime() < ad_timeMax) {
+	  lC_sim.execNextEvent();
+	}
+	return;
+      }
+
       adevs::Simulator<IO_Type> lC_sim( aCp_model );
 
       // simulate model until infinity
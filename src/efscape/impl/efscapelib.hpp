@@ -20,6 +20,11 @@
 #include <adevs.h>
 #include <efscape/impl/adevs_decorator.h>
 
+// port identifier and port value definitions
+#include <efscape/impl/PortSymbol.hpp>
+#include <efscape/impl/Payload.hpp>
+#include <efscape/impl/SharedJson.hpp>
+
 // boost libary definitions
 #include <boost/any.hpp>
 
@@ -39,8 +44,13 @@ namespace efscape {
     extern char const gcp_liburl[];  // library url
 
     // define the base adevs io type and cell event for the efscape library
-    typedef std::string PortType;
-    typedef adevs::PortValue<boost::any,PortType> IO_Type;
+    typedef PortSymbol PortType;
+#ifdef EFSCAPE_USE_PAYLOAD
+    typedef Payload ValueType;	// inline storage for small values
+#else
+    typedef boost::any ValueType;
+#endif
+    typedef adevs::PortValue<ValueType,PortType> IO_Type;
     typedef adevs::Devs<IO_Type> DEVS;
     typedef std::shared_ptr<DEVS> DEVSPtr;
     typedef adevs::Atomic<IO_Type> ATOMIC;
@@ -48,19 +58,88 @@ namespace efscape {
     typedef adevs::Network<IO_Type> NETWORK;
     typedef adevs::Network<IO_Type> NetworkModel;
     typedef adevs::ModelDecorator<IO_Type> ModelDecorator;
-    typedef adevs::SimpleDigraph<boost::any> SIMPLEDIGRAPH;
-    typedef adevs::Digraph<boost::any,PortType> DIGRAPH;
-    typedef adevs::CellEvent<boost::any> CellEvent;
+    typedef adevs::SimpleDigraph<ValueType> SIMPLEDIGRAPH;
+    typedef adevs::Digraph<ValueType,PortType> DIGRAPH;
+    typedef adevs::CellEvent<ValueType> CellEvent;
     typedef adevs::Devs<CellEvent> CellDevs;
     typedef adevs::Atomic<CellEvent> CellModelBase;
     typedef adevs::Network<CellEvent> CellNetwork;
-    typedef adevs::CellSpace<boost::any> CELLSPACE;
+    typedef adevs::CellSpace<ValueType> CELLSPACE;
     typedef adevs::ModelWrapper<IO_Type,CellEvent> CellSpaceWrapperBase;
     typedef adevs::ModelWrapper<CellEvent,IO_Type> CellWrapperBase;
     typedef adevs::EventListener<IO_Type> EventListener;
     typedef adevs::EventListener<CellEvent> CellEventListener;
 
+    // lookahead declared for individual models (see PartitionedSimulator)
+    typedef std::map<const DEVS*, double> LookaheadMap;
+
+    //------------------------------------------------------------------
+    // port value access that works with either ValueType implementation
+    //------------------------------------------------------------------
+    /**
+     * Non-throwing access to a port value.
+     *
+     * @tparam T value type
+     * @param aCp_value handle to port value
+     * @returns handle to value (null if the port value is not a T)
+     */
+    template <typename T>
+    const T* value_cast(const boost::any* aCp_value) {
+      return boost::any_cast<T>(aCp_value);
+    }
+
+    template <typename T>
+    T* value_cast(boost::any* aCp_value) {
+      return boost::any_cast<T>(aCp_value);
+    }
+
+    template <typename T>
+    const T* value_cast(const Payload* aCp_value) {
+      return payload_cast<T>(aCp_value);
+    }
+
+    template <typename T>
+    T* value_cast(Payload* aCp_value) {
+      return payload_cast<T>(aCp_value);
+    }
+
+    /**
+     * Throwing access to a port value.
+     *
+     * @tparam T value type
+     * @param aCr_value port value
+     * @returns copy of value
+     * @throws boost::bad_any_cast if the port value is not a T
+     */
+    template <typename T>
+    T value_cast(const boost::any& aCr_value) {
+      return boost::any_cast<T>(aCr_value);
+    }
+
+    template <typename T>
+    T value_cast(const Payload& aCr_value) {
+      return payload_cast<T>(aCr_value);
+    }
+
+    /**
+     * Non-throwing access to a JSON port value, which may be sent either as
+     * a Json::Value or as a SharedJson document.
+     *
+     * @tparam Holder port value type (boost::any or Payload)
+     * @param aCp_value handle to port value
+     * @returns handle to JSON document (null if the value is not JSON)
+     */
+    template <typename Holder>
+    const Json::Value* json_value_cast(const Holder* aCp_value) {
+      if (const Json::Value* lCp_value = value_cast<Json::Value>(aCp_value))
+	return lCp_value;
+      if (const SharedJson* lCp_shared = value_cast<SharedJson>(aCp_value))
+	return &lCp_shared->get();
+      return NULL;
+    }
+
     // injects a bag of events into a model
+    // (see AtomicIndex.hpp for versions that avoid re-traversing networks)
     void inject_events(double e, const adevs::Bag<IO_Type>& xb,
 		       DEVS* aCp_model);
 
@@ -78,6 +157,10 @@ namespace efscape {
 			 std::ostream& aCr_ostream);
     DEVSPtr loadAdevsFromJSON(std::istream& aCr_istream);
 
+    void saveAdevsToBinary(const DEVSPtr& aCp_model,
+			   std::ostream& aCr_ostream);
+    DEVSPtr loadAdevsFromBinary(std::istream& aCr_istream);
+
     /**
      * Helper function for creating an adevs model from the model factory.
      *
@@ -118,13 +201,27 @@ namespace efscape {
      */
     DEVSPtr cloneModelUsingJSON( const DEVSPtr& aCp_model );
 
+    /**
+     * Helper function for cloning an adevs model. Models that provide a
+     * deep copy (see Cloneable.hpp) copy themselves; other models are
+     * cloned through a binary archive held in memory, and as a last resort
+     * through a JSON archive.
+     *
+     * @param aCp_model handle to model
+     * @return handle to model clone (null if cloning fails)
+     */
+    DEVSPtr cloneModel( const DEVSPtr& aCp_model );
+
     /**
      * Helper function for running a simulation
      *
      * @param aCp_model pointer to model
      * @param ad_timeMax time max
+     * @param ai_threads number of threads (more than 1 selects the
+     *                   ParallelSimulator)
      */
-    void runSim( DEVS* aCp_model, double ad_timeMax = DBL_MAX );
+    void runSim( DEVS* aCp_model, double ad_timeMax = DBL_MAX,
+		 unsigned int ai_threads = 1 );
 
     /**
      * Helper function for create a simulation session that will
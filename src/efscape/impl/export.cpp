@@ -15,6 +15,7 @@
 // __COPYRIGHT_END__
 
 #include <efscape/impl/SimRunner.hpp>
+#include <efscape/impl/CompiledDigraph.hpp>
 
 // model factory definitions
 #include <efscape/impl/ModelHomeI.hpp>
@@ -25,6 +26,9 @@
 // efscape::utils::CommandOpt-derived classes
 //--------------------------------------------
 #include <efscape/impl/RunSim.hpp>
+#include <efscape/impl/RunSweep.hpp>
+#include <efscape/impl/ReadColumns.hpp>
+#include <efscape/impl/TailRing.hpp>
 
 #include <json/json.h>
 
@@ -36,7 +40,8 @@ namespace efscape {
     //-----------------
     // register classes
     //-----------------
-    // DIGRAPH class metadata
+    // DIGRAPH class metadata (digraphs are built as CompiledDigraph models,
+    // which route through a compiled coupling table)
     class DigraphType : public ModelType
     {
     public:
@@ -50,7 +55,7 @@ namespace efscape {
     const bool
     lb_Digraph_registered =
        Singleton<ModelHomeI>::Instance().getModelFactory().
-       registerType<DIGRAPH>(DigraphType().typeName(),
+       registerType<CompiledDigraph>(DigraphType().typeName(),
 			     DigraphType().toJSON());
 
     // SimRunner class metadata
@@ -75,5 +80,20 @@ namespace efscape {
       Singleton<ModelHomeI>::Instance().getCommandFactory().
       registerType<RunSim>( RunSim::ProgramName() );
 
+    const bool
+    lb_RunSweep_registered =
+      Singleton<ModelHomeI>::Instance().getCommandFactory().
+      registerType<RunSweep>( RunSweep::ProgramName() );
+
+    const bool
+    lb_ReadColumns_registered =
+      Singleton<ModelHomeI>::Instance().getCommandFactory().
+      registerType<ReadColumns>( ReadColumns::ProgramName() );
+
+    const bool
+    lb_TailRing_registered =
+      Singleton<ModelHomeI>::Instance().getCommandFactory().
+      registerType<TailRing>( TailRing::ProgramName() );
+
   } // namespace impl
 }   // namespace efscape
@@ -0,0 +1,278 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : ForkRunner.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/utils/ForkRunner.hpp>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <streambuf>
+#include <thread>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace efscape {
+
+  namespace utils {
+
+    namespace {
+
+      // writes a stream to a file descriptor
+      class PipeBuffer : public std::streambuf
+      {
+      public:
+	explicit PipeBuffer(int ai_fd) : mi_fd(ai_fd) {
+	  setp(mc1_buffer, mc1_buffer + sizeof(mc1_buffer));
+	}
+
+	~PipeBuffer() { sync(); }
+
+      protected:
+	int overflow(int c) {
+	  if (sync() != 0)
+	    return traits_type::eof();
+	  if (c != traits_type::eof()) {
+	    *pptr() = traits_type::to_char_type(c);
+	    pbump(1);
+	  }
+	  return traits_type::not_eof(c);
+	}
+
+	int sync() {
+	  const char* lcp_data = pbase();
+	  std::size_t li_size = pptr() - pbase();
+	  while (li_size > 0) {
+	    ssize_t li_written = ::write(mi_fd, lcp_data, li_size);
+	    if (li_written < 0) {
+	      if (errno == EINTR)
+		continue;
+	      return -1;
+	    }
+	    lcp_data += li_written;
+	    li_size -= li_written;
+	  }
+	  setp(mc1_buffer, mc1_buffer + sizeof(mc1_buffer));
+	  return 0;
+	}
+
+      private:
+	int mi_fd;
+	char mc1_buffer[1 << 16];
+      };
+
+      // a running child process
+      struct Child {
+	std::size_t mi_task;
+	pid_t mi_pid;
+      };
+
+      // waits for a child process, returning its exit status
+      int wait_child(pid_t ai_pid)
+      {
+	int li_status = 0;
+	while (::waitpid(ai_pid, &li_status, 0) < 0 && errno == EINTR)
+	  ;
+	return (WIFEXITED(li_status) ? WEXITSTATUS(li_status) : -1);
+      }
+
+      // kills and collects the running child processes
+      void kill_children(std::map<int, Child>& aCr_running)
+      {
+	for (const auto& i : aCr_running) {
+	  ::close(i.first);
+	  ::kill(i.second.mi_pid, SIGKILL);
+	  wait_child(i.second.mi_pid);
+	}
+	aCr_running.clear();
+      }
+
+    } // namespace
+
+    /**
+     * constructor
+     *
+     * @param ai_processes maximum number of child processes run at once
+     *                     (0: the number of hardware threads)
+     * @param ad_timeout maximum duration of a run in seconds (0: none)
+     */
+    ForkRunner::ForkRunner(unsigned int ai_processes, double ad_timeout) :
+      mi_processes(ai_processes),
+      md_timeout(ad_timeout)
+    {
+      if (mi_processes == 0)
+	mi_processes = std::thread::hardware_concurrency();
+      if (mi_processes == 0)
+	mi_processes = 1;
+    }
+
+    /**
+     * Runs the tasks, each in its own child process, at most processes() at
+     * a time, and returns what each task wrote. A task that throws, or whose
+     * process does not exit normally, has a non-zero status(). The tasks
+     * still running at the timeout() are killed, and those not yet started
+     * are not run (status -1).
+     *
+     * @param ai_tasks number of tasks
+     * @param aCr_task task, called with the task number in the child
+     * @returns output of each task
+     * @throws std::logic_error if a pipe or a process cannot be created (the
+     *         running tasks are then killed)
+     */
+    std::vector<std::string> ForkRunner::run(std::size_t ai_tasks,
+					     const Task& aCr_task)
+      throw(std::logic_error)
+    {
+      std::vector<std::string> lC1_output(ai_tasks);
+      mC1_status.assign(ai_tasks, -1);
+
+      std::map<int, Child> lCC_running; // by read end of the pipe
+      std::size_t li_next = 0;
+      char lc1_buffer[1 << 16];
+
+      const auto lC_deadline = std::chrono::steady_clock::now() +
+	std::chrono::duration_cast<std::chrono::steady_clock::duration>
+	(std::chrono::duration<double>(md_timeout));
+
+      try {
+	while (li_next < ai_tasks || !lCC_running.empty()) {
+	  //------------------------------------------------------------------
+	  // 1. start tasks up to the maximum number of processes
+	  //------------------------------------------------------------------
+	  while (li_next < ai_tasks && lCC_running.size() < mi_processes) {
+	    int li1_pipe[2];
+	    if (::pipe(li1_pipe) != 0)
+	      throw std::logic_error(std::string("unable to create a pipe: ")
+				     + std::strerror(errno));
+
+	    pid_t li_pid = ::fork();
+	    if (li_pid < 0) {
+	      ::close(li1_pipe[0]);
+	      ::close(li1_pipe[1]);
+	      throw std::logic_error(std::string("unable to fork: ")
+				     + std::strerror(errno));
+	    }
+
+	    if (li_pid == 0) {
+	      // child: run the task, then leave without unwinding the
+	      // state copied from the caller
+	      ::close(li1_pipe[0]);
+	      for (const auto& i : lCC_running)
+		::close(i.first);
+
+	      int li_status = 0;
+	      {
+		PipeBuffer lC_buffer(li1_pipe[1]);
+		std::ostream lC_out(&lC_buffer);
+		try {
+		  aCr_task(li_next, lC_out);
+		  lC_out.flush();
+		  if (!lC_out)
+		    li_status = 2;
+		}
+		catch (const std::exception& lC_exp) {
+		  std::fprintf(stderr, "task %lu: %s\n",
+			       (unsigned long)li_next, lC_exp.what());
+		  li_status = 1;
+		}
+		catch (...) {
+		  li_status = 1;
+		}
+	      }
+	      ::_exit(li_status);
+	    }
+
+	    ::close(li1_pipe[1]);
+	    Child lC_child = { li_next, li_pid };
+	    lCC_running[li1_pipe[0]] = lC_child;
+	    li_next++;
+	  }
+
+	  //------------------------------------------------------------------
+	  // 2. read the output of the running tasks until one finishes
+	  //------------------------------------------------------------------
+	  std::vector<struct pollfd> lC1_fds;
+	  for (const auto& i : lCC_running) {
+	    struct pollfd lC_fd = { i.first, POLLIN, 0 };
+	    lC1_fds.push_back(lC_fd);
+	  }
+
+	  int li_wait = -1;
+	  if (md_timeout > 0.) {
+	    auto li_left =
+	      std::chrono::duration_cast<std::chrono::milliseconds>
+	      (lC_deadline - std::chrono::steady_clock::now()).count();
+	    if (li_left <= 0) {
+	      kill_children(lCC_running);
+	      break;
+	    }
+	    li_wait = (li_left < 1000000 ? int(li_left) : 1000000);
+	  }
+
+	  if (::poll(lC1_fds.data(), lC1_fds.size(), li_wait) < 0) {
+	    if (errno == EINTR)
+	      continue;
+	    throw std::logic_error(std::string("unable to poll the tasks: ")
+				   + std::strerror(errno));
+	  }
+
+	  for (const auto& lC_fd : lC1_fds) {
+	    if (lC_fd.revents == 0)
+	      continue;
+
+	    Child lC_child = lCC_running[lC_fd.fd];
+	    ssize_t li_read = ::read(lC_fd.fd, lc1_buffer, sizeof(lc1_buffer));
+	    if (li_read > 0) {
+	      lC1_output[lC_child.mi_task].append(lc1_buffer, li_read);
+	      continue;
+	    }
+	    if (li_read < 0 && errno == EINTR)
+	      continue;
+
+	    // end of output: collect the process
+	    ::close(lC_fd.fd);
+	    lCC_running.erase(lC_fd.fd);
+
+	    mC1_status[lC_child.mi_task] = wait_child(lC_child.mi_pid);
+	  }
+	}
+      }
+      catch (...) {
+	kill_children(lCC_running);
+	throw;
+      }
+
+      return lC1_output;
+    }
+
+    /** @returns number of tasks of the last run that failed */
+    std::size_t ForkRunner::failures() const
+    {
+      std::size_t li_failures = 0;
+      for (int li_status : mC1_status)
+	if (li_status != 0)
+	  li_failures++;
+      return li_failures;
+    }
+
+  } // namespace utils
+
+} // namespace efscape
@@ -0,0 +1,91 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : ForkRunner.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_UTILS_FORKRUNNER_HPP
+#define EFSCAPE_UTILS_FORKRUNNER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace efscape {
+
+  namespace utils {
+
+    /**
+     * Runs tasks in child processes created with fork(). Each child starts
+     * from a copy-on-write image of the calling process, so a task sees the
+     * whole state of the caller at the time of the fork (e.g. a simulation
+     * run up to some time), and the children share the memory that none of
+     * them writes to. A task writes its results to a stream connected to a
+     * pipe, which the caller reads back.
+     *
+     * Only the calling thread exists in a child: tasks must not rely on
+     * other threads of the caller (e.g. a thread pool). A child leaves with
+     * _exit(), without running destructors or flushing the streams inherited
+     * from the caller, which should be flushed before run().
+     *
+     * Forking a multithreaded process (e.g. the efscape server) copies the
+     * locks held by its other threads at the time of the fork, which are
+     * never released in the child. A task that takes such a lock deadlocks:
+     * in particular, it must not log (log4cxx) or create port symbols
+     * (efscape::impl::PortSymbolTable), whose mutexes may be held by another
+     * thread of the caller. A timeout() bounds the run in that case.
+     */
+    class ForkRunner
+    {
+    public:
+
+      /** runs a task in a child process, writing its results to a stream */
+      typedef std::function<void(std::size_t, std::ostream&)> Task;
+
+      ForkRunner(unsigned int ai_processes = 0, double ad_timeout = 0.);
+
+      std::vector<std::string> run(std::size_t ai_tasks, const Task& aCr_task)
+	throw(std::logic_error);
+
+      /** @returns maximum number of child processes run at once */
+      unsigned int processes() const { return mi_processes; }
+
+      /** @returns maximum duration of a run in seconds (0: none) */
+      double timeout() const { return md_timeout; }
+
+      /** @returns exit status of each task of the last run (0: success) */
+      const std::vector<int>& status() const { return mC1_status; }
+
+      /** @returns number of tasks of the last run that failed */
+      std::size_t failures() const;
+
+    private:
+
+      /** maximum number of child processes run at once */
+      unsigned int mi_processes;
+
+      /** maximum duration of a run in seconds */
+      double md_timeout;
+
+      /** exit status of each task of the last run */
+      std::vector<int> mC1_status;
+
+    };				// class ForkRunner
+
+  } // namespace utils
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_UTILS_FORKRUNNER_HPP
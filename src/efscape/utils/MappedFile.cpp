@@ -0,0 +1,84 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : MappedFile.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/utils/MappedFile.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace efscape {
+
+  namespace utils {
+
+    /**
+     * constructor
+     *
+     * @param acp_filename name of the file
+     * @throws std::logic_error if the file cannot be mapped
+     */
+    MappedFile::MappedFile(const char* acp_filename)
+      throw(std::logic_error) :
+      mcp_data(NULL),
+      mi_size(0)
+    {
+      int li_fd = ::open(acp_filename, O_RDONLY);
+      if (li_fd < 0)
+	throw std::logic_error(std::string("MappedFile: can't open <")
+			       + acp_filename + ">: " + std::strerror(errno));
+
+      struct stat lC_stat;
+      if (::fstat(li_fd, &lC_stat) != 0) {
+	int li_errno = errno;
+	::close(li_fd);
+	throw std::logic_error(std::string("MappedFile: can't stat <")
+			       + acp_filename + ">: "
+			       + std::strerror(li_errno));
+      }
+
+      mi_size = static_cast<std::size_t>(lC_stat.st_size);
+      if (mi_size > 0) {
+	void* lp_data = ::mmap(NULL, mi_size, PROT_READ, MAP_PRIVATE, li_fd,
+			       0);
+	if (lp_data == MAP_FAILED) {
+	  int li_errno = errno;
+	  ::close(li_fd);
+	  throw std::logic_error(std::string("MappedFile: can't map <")
+				 + acp_filename + ">: "
+				 + std::strerror(li_errno));
+	}
+	::madvise(lp_data, mi_size, MADV_SEQUENTIAL);
+	mcp_data = static_cast<const char*>(lp_data);
+      }
+
+      // the mapping holds its own reference to the file
+      ::close(li_fd);
+    }
+
+    /** destructor */
+    MappedFile::~MappedFile()
+    {
+      if (mcp_data)
+	::munmap(const_cast<char*>(mcp_data), mi_size);
+    }
+
+  } // namespace utils
+
+} // namespace efscape
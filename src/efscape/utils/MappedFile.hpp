@@ -0,0 +1,105 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : MappedFile.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_UTILS_MAPPEDFILE_HPP
+#define EFSCAPE_UTILS_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <streambuf>
+
+namespace efscape {
+
+  namespace utils {
+
+    /**
+     * Implements a read-only stream buffer over a region of memory that it
+     * does not own, so that a stream can read a string or a mapped file in
+     * place instead of from a copy.
+     */
+    class ViewBuffer : public std::streambuf
+    {
+    public:
+
+      /**
+       * constructor
+       *
+       * @param acp_data start of the region
+       * @param ai_size size of the region
+       */
+      ViewBuffer(const char* acp_data, std::size_t ai_size) {
+	// the get area is never written through
+	char* lcp_begin = const_cast<char*>(acp_data);
+	setg(lcp_begin, lcp_begin, lcp_begin + ai_size);
+      }
+
+    protected:
+
+      pos_type seekoff(off_type ai_off, std::ios_base::seekdir ai_dir,
+		       std::ios_base::openmode ai_which) {
+	char* lcp_pos = (ai_dir == std::ios_base::beg ? eback() :
+			 ai_dir == std::ios_base::end ? egptr() : gptr());
+	lcp_pos += ai_off;
+	if (lcp_pos < eback() || lcp_pos > egptr())
+	  return pos_type(off_type(-1));
+	setg(eback(), lcp_pos, egptr());
+	return pos_type(lcp_pos - eback());
+      }
+
+      pos_type seekpos(pos_type ai_pos, std::ios_base::openmode ai_which) {
+	return seekoff(off_type(ai_pos), std::ios_base::beg, ai_which);
+      }
+
+    };				// class ViewBuffer
+
+    /**
+     * Maps a file read-only into memory. Pages are only read from the file
+     * when they are first touched, and the kernel is told that the mapping
+     * will be read sequentially, so that it reads ahead and may drop the
+     * pages behind the reader. A model snapshot can thus be deserialized
+     * straight from the file (see ViewBuffer) without holding a copy of it.
+     */
+    class MappedFile
+    {
+    public:
+
+      MappedFile(const char* acp_filename)
+	throw(std::logic_error);
+      ~MappedFile();
+
+      /** @returns start of the mapped file */
+      const char* data() const { return mcp_data; }
+
+      /** @returns size of the mapped file */
+      std::size_t size() const { return mi_size; }
+
+    private:
+
+      MappedFile(const MappedFile&);
+      MappedFile& operator=(const MappedFile&);
+
+      /** start of the mapping (null for an empty file) */
+      const char* mcp_data;
+
+      /** size of the mapping */
+      std::size_t mi_size;
+
+    };				// class MappedFile
+
+  } // namespace utils
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_UTILS_MAPPEDFILE_HPP
@@ -0,0 +1,90 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : MemoryBuffer.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_UTILS_MEMORYBUFFER_HPP
+#define EFSCAPE_UTILS_MEMORYBUFFER_HPP
+
+#include <streambuf>
+#include <vector>
+
+namespace efscape {
+
+  namespace utils {
+
+    /**
+     * Implements a growable in-memory stream buffer that keeps its storage
+     * between uses. Unlike a std::stringbuf, the contents can be read back
+     * in place (no copy into a second stream), and reset() empties the
+     * buffer without giving up its capacity, so a buffer that is reused
+     * for a series of archives stops allocating once it has grown to the
+     * size of the largest one.
+     *
+     *   MemoryBuffer lC_buffer;
+     *   std::ostream lC_out(&lC_buffer);	// write...
+     *   lC_buffer.rewind();
+     *   std::istream lC_in(&lC_buffer);	// ...then read back
+     */
+    class MemoryBuffer : public std::streambuf
+    {
+    public:
+
+      MemoryBuffer() { reset(); }
+
+      /** Empties the buffer (keeping its storage). */
+      void reset() {
+	mC1_data.clear();
+	setp(0, 0);
+	setg(0, 0, 0);
+      }
+
+      /** Positions the read pointer at the start of the contents. */
+      void rewind() {
+	char* lcp_begin = mC1_data.empty() ? 0 : &mC1_data[0];
+	setg(lcp_begin, lcp_begin, lcp_begin + mC1_data.size());
+      }
+
+      /** @returns contents of the buffer */
+      const char* data() const {
+	return mC1_data.empty() ? 0 : &mC1_data[0];
+      }
+
+      /** @returns size of the contents */
+      std::size_t size() const { return mC1_data.size(); }
+
+    protected:
+
+      std::streamsize xsputn(const char* acp_data, std::streamsize ai_size) {
+	mC1_data.insert(mC1_data.end(), acp_data, acp_data + ai_size);
+	return ai_size;
+      }
+
+      int_type overflow(int_type ai_char) {
+	if (!traits_type::eq_int_type(ai_char, traits_type::eof()))
+	  mC1_data.push_back(traits_type::to_char_type(ai_char));
+	return traits_type::not_eof(ai_char);
+      }
+
+    private:
+
+      /** contents */
+      std::vector<char> mC1_data;
+
+    };				// class MemoryBuffer
+
+  } // namespace utils
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_UTILS_MEMORYBUFFER_HPP
@@ -0,0 +1,295 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : SharedRing.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/utils/SharedRing.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace efscape {
+
+  namespace utils {
+
+    namespace {
+
+      // identifies a ring
+      const char gcp_magic[8] = { 'E', 'F', 'R', 'I', 'N', 'G', '1', '\0' };
+
+      // record header
+      struct RecordHeader {
+	std::uint32_t size;	// size of the record data
+	std::uint32_t flags;	// PADDING: skip to the start of the area
+	std::uint64_t sequence;	// sequence number
+      };
+
+      const std::uint32_t gi_padding = 1;
+
+      // rounds a size up to a multiple of 8 bytes
+      std::uint64_t align8(std::uint64_t al_size) {
+	return (al_size + 7) & ~std::uint64_t(7);
+      }
+
+      // the counters are shared between processes
+      static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+		    "shared rings need lock-free 64-bit atomics");
+      static_assert(sizeof(RecordHeader) == 16, "unexpected record header");
+      static_assert(sizeof(SharedRingHeader) <= SharedRingHeader::DATA_OFFSET,
+		    "ring header overlaps the data area");
+
+    } // namespace
+
+    const std::size_t SharedRingHeader::DATA_OFFSET;
+
+    //
+    // SharedRingWriter
+    //
+
+    /**
+     * constructor
+     *
+     * @param aCr_name name of the ring (e.g. "/efscape-out")
+     * @param ai_capacity size of the data area (rounded up to a power of 2)
+     * @throws std::logic_error if the shared memory cannot be created
+     */
+    SharedRingWriter::SharedRingWriter(const std::string& aCr_name,
+				       std::size_t ai_capacity)
+      throw(std::logic_error) :
+      mC_name(aCr_name),
+      mCp_header(NULL),
+      mcp_data(NULL),
+      mi_size(0),
+      ml_sequence(0),
+      ml_dropped(0)
+    {
+      std::size_t li_capacity = 4096;
+      while (li_capacity < ai_capacity)
+	li_capacity <<= 1;
+
+      // replace any ring of the same name
+      ::shm_unlink(mC_name.c_str());
+      int li_fd = ::shm_open(mC_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+      if (li_fd < 0)
+	throw std::logic_error("Unable to create shared memory <" + mC_name
+			       + ">: " + std::strerror(errno));
+
+      mi_size = SharedRingHeader::DATA_OFFSET + li_capacity;
+      void* lvp_map = MAP_FAILED;
+      if (::ftruncate(li_fd, mi_size) == 0)
+	lvp_map = ::mmap(NULL, mi_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			 li_fd, 0);
+      int li_errno = errno;
+      ::close(li_fd);
+      if (lvp_map == MAP_FAILED) {
+	::shm_unlink(mC_name.c_str());
+	throw std::logic_error("Unable to map shared memory <" + mC_name
+			       + ">: " + std::strerror(li_errno));
+      }
+
+      mCp_header = new (lvp_map) SharedRingHeader;
+      mcp_data = static_cast<char*>(lvp_map) + SharedRingHeader::DATA_OFFSET;
+      mCp_header->capacity = li_capacity;
+      mCp_header->closed.store(0, std::memory_order_relaxed);
+      mCp_header->head.store(0, std::memory_order_relaxed);
+      mCp_header->reserve.store(0, std::memory_order_relaxed);
+
+      // readers check the magic number last
+      std::atomic_thread_fence(std::memory_order_release);
+      std::memcpy(mCp_header->magic, gcp_magic, sizeof(gcp_magic));
+    }
+
+    /** destructor */
+    SharedRingWriter::~SharedRingWriter()
+    {
+      mCp_header->closed.store(1, std::memory_order_release);
+      ::munmap(mCp_header, mi_size);
+    }
+
+    bool SharedRingWriter::write(const char* acp_data, std::size_t ai_size)
+    {
+      std::uint64_t ll_capacity = mCp_header->capacity;
+      std::uint64_t ll_total = sizeof(RecordHeader) + align8(ai_size);
+      if (ll_total > ll_capacity / 2) {
+	ml_dropped++;
+	return false;
+      }
+
+      // a record that does not fit before the end of the area starts over
+      std::uint64_t ll_position =
+	mCp_header->head.load(std::memory_order_relaxed);
+      std::uint64_t ll_offset = ll_position & (ll_capacity - 1);
+      std::uint64_t ll_remaining = ll_capacity - ll_offset;
+      std::uint64_t ll_start =
+	ll_position + (ll_remaining < ll_total ? ll_remaining : 0);
+      std::uint64_t ll_end = ll_start + ll_total;
+
+      // announce the bytes about to be overwritten
+      mCp_header->reserve.store(ll_end, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+
+      if (ll_start != ll_position && ll_remaining >= sizeof(RecordHeader)) {
+	RecordHeader lC_padding = {
+	  std::uint32_t(ll_remaining - sizeof(RecordHeader)), gi_padding, 0
+	};
+	std::memcpy(mcp_data + ll_offset, &lC_padding, sizeof(lC_padding));
+      }
+
+      RecordHeader lC_header = { std::uint32_t(ai_size), 0, ml_sequence++ };
+      char* lcp_record = mcp_data + (ll_start & (ll_capacity - 1));
+      std::memcpy(lcp_record, &lC_header, sizeof(lC_header));
+      std::memcpy(lcp_record + sizeof(lC_header), acp_data, ai_size);
+
+      // publish the record
+      mCp_header->head.store(ll_end, std::memory_order_release);
+      return true;
+    }
+
+    void SharedRingWriter::unlink(const std::string& aCr_name)
+    {
+      ::shm_unlink(aCr_name.c_str());
+    }
+
+    //
+    // SharedRingReader
+    //
+
+    /**
+     * constructor
+     *
+     * @param aCr_name name of the ring
+     * @throws std::logic_error if the ring cannot be attached
+     */
+    SharedRingReader::SharedRingReader(const std::string& aCr_name)
+      throw(std::logic_error) :
+      mCp_header(NULL),
+      mcp_data(NULL),
+      mi_size(0),
+      ml_position(0),
+      ml_sequence(0),
+      mb_synchronized(false),
+      ml_lost(0),
+      ml_overruns(0)
+    {
+      int li_fd = ::shm_open(aCr_name.c_str(), O_RDONLY, 0);
+      if (li_fd < 0)
+	throw std::logic_error("Unable to open shared memory <" + aCr_name
+			       + ">: " + std::strerror(errno));
+
+      struct stat lC_stat;
+      void* lvp_map = MAP_FAILED;
+      if (::fstat(li_fd, &lC_stat) == 0 &&
+	  std::size_t(lC_stat.st_size) > SharedRingHeader::DATA_OFFSET) {
+	mi_size = lC_stat.st_size;
+	lvp_map = ::mmap(NULL, mi_size, PROT_READ, MAP_SHARED, li_fd, 0);
+      }
+      ::close(li_fd);
+      if (lvp_map == MAP_FAILED)
+	throw std::logic_error("Unable to map shared memory <" + aCr_name
+			       + ">");
+
+      mCp_header = static_cast<const SharedRingHeader*>(lvp_map);
+      mcp_data =
+	static_cast<const char*>(lvp_map) + SharedRingHeader::DATA_OFFSET;
+
+      std::uint64_t ll_capacity = mCp_header->capacity;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (std::memcmp(mCp_header->magic, gcp_magic, sizeof(gcp_magic)) != 0 ||
+	  ll_capacity == 0 || (ll_capacity & (ll_capacity - 1)) != 0 ||
+	  SharedRingHeader::DATA_OFFSET + ll_capacity > mi_size) {
+	::munmap(const_cast<SharedRingHeader*>(mCp_header), mi_size);
+	throw std::logic_error("Shared memory <" + aCr_name
+			       + "> is not a ring buffer");
+      }
+
+      // start from the latest record
+      ml_position = mCp_header->head.load(std::memory_order_acquire);
+    }
+
+    /** destructor */
+    SharedRingReader::~SharedRingReader()
+    {
+      ::munmap(const_cast<SharedRingHeader*>(mCp_header), mi_size);
+    }
+
+    bool SharedRingReader::next(std::string& aCr_record,
+				std::uint64_t& aCr_sequence)
+    {
+      std::uint64_t ll_capacity = mCp_header->capacity;
+      for (;;) {
+	std::uint64_t ll_head =
+	  mCp_header->head.load(std::memory_order_acquire);
+	if (ml_position == ll_head)
+	  return false;
+	if (ll_head - ml_position > ll_capacity) {
+	  resync();
+	  continue;
+	}
+
+	std::uint64_t ll_offset = ml_position & (ll_capacity - 1);
+	std::uint64_t ll_remaining = ll_capacity - ll_offset;
+	if (ll_remaining < sizeof(RecordHeader)) {
+	  ml_position += ll_remaining;
+	  continue;
+	}
+
+	// copy the record, then check that the writer has not overwritten
+	// it in the meantime
+	RecordHeader lC_header;
+	std::memcpy(&lC_header, mcp_data + ll_offset, sizeof(lC_header));
+	std::uint64_t ll_total = ll_remaining;
+	bool lb_valid = true;
+	if (lC_header.flags != gi_padding) {
+	  ll_total = sizeof(RecordHeader) + align8(lC_header.size);
+	  lb_valid = (ll_total <= ll_remaining);
+	  if (lb_valid)
+	    aCr_record.assign(mcp_data + ll_offset + sizeof(lC_header),
+			      lC_header.size);
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (mCp_header->reserve.load(std::memory_order_relaxed) - ml_position
+	    > ll_capacity || !lb_valid) {
+	  resync();
+	  continue;
+	}
+
+	ml_position += ll_total;
+	if (lC_header.flags == gi_padding)
+	  continue;
+
+	if (mb_synchronized && lC_header.sequence > ml_sequence)
+	  ml_lost += lC_header.sequence - ml_sequence;
+	ml_sequence = lC_header.sequence + 1;
+	mb_synchronized = true;
+	aCr_sequence = lC_header.sequence;
+	return true;
+      }
+    }
+
+    void SharedRingReader::resync()
+    {
+      // skip to the latest record: the sequence number of the next record
+      // read tells how many were lost
+      ml_overruns++;
+      ml_position = mCp_header->head.load(std::memory_order_acquire);
+    }
+
+  } // namespace utils
+
+} // namespace efscape
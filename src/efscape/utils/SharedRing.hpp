@@ -0,0 +1,206 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : SharedRing.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_UTILS_SHAREDRING_HPP
+#define EFSCAPE_UTILS_SHAREDRING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace efscape {
+
+  namespace utils {
+
+    /**
+     * Layout of a ring buffer of records in POSIX shared memory, written by
+     * one process (SharedRingWriter) and read by any number of others
+     * (SharedRingReader). The header is followed by the data area:
+     *
+     *   record: size (u32) | flags (u32) | sequence number (u64) | data
+     *           | padding to 8 bytes
+     *
+     * A record that would not fit before the end of the data area is
+     * preceded by a padding record (or by fewer than 16 unused bytes), and
+     * written from the start of the area.
+     *
+     * The writer never waits for the readers: it announces the end of the
+     * record it is about to write (reserve), writes it over the oldest
+     * records, then publishes it (head). A reader that falls more than the
+     * capacity of the ring behind the writer (an overrun), or whose record
+     * was overwritten while it was read, skips ahead to the latest record;
+     * the sequence numbers tell it how many records it lost.
+     */
+    struct SharedRingHeader
+    {
+      /** identifies a ring ("EFRING1") */
+      char magic[8];
+
+      /** size of the data area (a power of 2) */
+      std::uint64_t capacity;
+
+      /** whether the writer has closed the ring */
+      std::atomic<std::uint32_t> closed;
+
+      /** end of the published records (bytes written since creation) */
+      alignas(64) std::atomic<std::uint64_t> head;
+
+      /** end of the record being written */
+      alignas(64) std::atomic<std::uint64_t> reserve;
+
+      /** offset of the data area */
+      static const std::size_t DATA_OFFSET = 256;
+    };
+
+    /**
+     * Implements the writer of a ring buffer of records in POSIX shared
+     * memory (see SharedRingHeader). Creating a writer replaces any ring of
+     * the same name; readers attached to the old ring keep it until they
+     * detach. The ring is left in place (closed) when the writer is
+     * destroyed, so that readers can drain it, and is removed by the next
+     * writer or by unlink().
+     */
+    class SharedRingWriter
+    {
+    public:
+
+      SharedRingWriter(const std::string& aCr_name, std::size_t ai_capacity)
+	throw(std::logic_error);
+      ~SharedRingWriter();
+
+      /**
+       * Publishes a record. The writer does not wait for readers.
+       *
+       * @param acp_data record data
+       * @param ai_size size of the record
+       * @returns whether the record was written (i.e. not larger than half
+       *          the capacity of the ring)
+       */
+      bool write(const char* acp_data, std::size_t ai_size);
+
+      /** @returns name of the ring */
+      const std::string& name() const { return mC_name; }
+
+      /** @returns number of records written */
+      std::uint64_t written() const { return ml_sequence; }
+
+      /** @returns number of records that were too large to be written */
+      std::uint64_t dropped() const { return ml_dropped; }
+
+      /**
+       * Removes a ring from the shared memory namespace.
+       *
+       * @param aCr_name name of the ring
+       */
+      static void unlink(const std::string& aCr_name);
+
+    private:
+
+      SharedRingWriter(const SharedRingWriter&);
+      SharedRingWriter& operator=(const SharedRingWriter&);
+
+      /** name of the ring */
+      std::string mC_name;
+
+      /** handle to the ring header */
+      SharedRingHeader* mCp_header;
+
+      /** start of the data area */
+      char* mcp_data;
+
+      /** size of the mapping */
+      std::size_t mi_size;
+
+      /** next sequence number */
+      std::uint64_t ml_sequence;
+
+      /** number of records that were too large */
+      std::uint64_t ml_dropped;
+
+    };				// class SharedRingWriter
+
+    /**
+     * Implements a reader of a ring buffer of records in POSIX shared memory
+     * (see SharedRingHeader). A reader starts at the latest record and never
+     * blocks the writer; it counts the records lost to overruns.
+     */
+    class SharedRingReader
+    {
+    public:
+
+      SharedRingReader(const std::string& aCr_name)
+	throw(std::logic_error);
+      ~SharedRingReader();
+
+      /**
+       * Reads the next record, if any.
+       *
+       * @param aCr_record record data (output)
+       * @param aCr_sequence sequence number of the record (output)
+       * @returns whether a record was read
+       */
+      bool next(std::string& aCr_record, std::uint64_t& aCr_sequence);
+
+      /** @returns whether the writer has closed the ring */
+      bool closed() const {
+	return mCp_header->closed.load(std::memory_order_acquire) != 0;
+      }
+
+      /** @returns number of records lost to overruns */
+      std::uint64_t lost() const { return ml_lost; }
+
+      /** @returns number of overruns */
+      std::uint64_t overruns() const { return ml_overruns; }
+
+    private:
+
+      SharedRingReader(const SharedRingReader&);
+      SharedRingReader& operator=(const SharedRingReader&);
+
+      void resync();
+
+      /** handle to the ring header */
+      const SharedRingHeader* mCp_header;
+
+      /** start of the data area */
+      const char* mcp_data;
+
+      /** size of the mapping */
+      std::size_t mi_size;
+
+      /** position of the next record */
+      std::uint64_t ml_position;
+
+      /** expected sequence number of the next record */
+      std::uint64_t ml_sequence;
+
+      /** whether the sequence number of the next record is known */
+      bool mb_synchronized;
+
+      /** number of records lost to overruns */
+      std::uint64_t ml_lost;
+
+      /** number of overruns */
+      std::uint64_t ml_overruns;
+
+    };				// class SharedRingReader
+
+  } // namespace utils
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_UTILS_SHAREDRING_HPP
@@ -0,0 +1,184 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : ThreadPool.cpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#include <efscape/utils/ThreadPool.hpp>
+
+#include <algorithm>
+
+namespace efscape {
+
+  namespace utils {
+
+    ThreadPool::ThreadPool(unsigned int ai_threads) :
+      ml_generation(0),
+      ml_pending(0),
+      mb_stop(false)
+    {
+      if (ai_threads == 0)
+	ai_threads = std::max(1u, std::thread::hardware_concurrency());
+
+      for (unsigned int i = 0; i < ai_threads; i++)
+	mC1_queues.push_back( std::unique_ptr<Queue>(new Queue) );
+
+      for (unsigned int i = 1; i < ai_threads; i++)
+	mC1_threads.push_back( std::thread(&ThreadPool::worker, this, i) );
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+      {
+	std::lock_guard<std::mutex> lC_lock(mC_mutex);
+	mb_stop = true;
+      }
+      mC_start.notify_all();
+      for (std::size_t i = 0; i < mC1_threads.size(); i++)
+	mC1_threads[i].join();
+    }
+
+    void ThreadPool::parallel_for(std::size_t ai_count,
+				  const std::function<void(std::size_t)>&
+				  aCr_body,
+				  std::size_t ai_grain)
+    {
+      if (ai_count == 0)
+	return;
+
+      // run small loops (and all loops on a single thread) in place
+      std::size_t ll_threads = mC1_queues.size();
+      if (ll_threads == 1 || ai_count <= ai_grain) {
+	for (std::size_t i = 0; i < ai_count; i++)
+	  aCr_body(i);
+	return;
+      }
+
+      // several chunks per thread leave room for stealing
+      std::size_t ll_chunk =
+	std::max(std::max<std::size_t>(ai_grain, 1),
+		 ai_count/(4*ll_threads));
+
+      {
+	std::lock_guard<std::mutex> lC_lock(mC_mutex);
+	ml_pending = ai_count;
+	mCp_error = std::exception_ptr();
+      }
+
+      std::size_t ll_queue = 0;
+      for (std::size_t i = 0; i < ai_count; i += ll_chunk) {
+	Task lC_task = { i, std::min(ai_count, i + ll_chunk), &aCr_body };
+	Queue& lCr_queue = *mC1_queues[ll_queue];
+	{
+	  std::lock_guard<std::mutex> lC_lock(lCr_queue.mutex);
+	  lCr_queue.tasks.push_back(lC_task);
+	}
+	ll_queue = (ll_queue + 1) % ll_threads;
+      }
+
+      {
+	std::lock_guard<std::mutex> lC_lock(mC_mutex);
+	++ml_generation;
+      }
+      mC_start.notify_all();
+
+      // the caller works too, then waits for chunks still in progress
+      drain(0);
+
+      std::exception_ptr lCp_error;
+      {
+	std::unique_lock<std::mutex> lC_lock(mC_mutex);
+	while (ml_pending > 0)
+	  mC_finish.wait(lC_lock);
+	lCp_error = mCp_error;
+	mCp_error = std::exception_ptr();
+      }
+
+      if (lCp_error)
+	std::rethrow_exception(lCp_error);
+    }
+
+    void ThreadPool::worker(unsigned int ai_index)
+    {
+      unsigned long ll_seen = 0;
+      for (;;) {
+	{
+	  std::unique_lock<std::mutex> lC_lock(mC_mutex);
+	  while (!mb_stop && ml_generation == ll_seen)
+	    mC_start.wait(lC_lock);
+	  if (mb_stop)
+	    return;
+	  ll_seen = ml_generation;
+	}
+	drain(ai_index);
+      }
+    }
+
+    bool ThreadPool::pop(unsigned int ai_index, Task& aCr_task)
+    {
+      Queue& lCr_queue = *mC1_queues[ai_index];
+      std::lock_guard<std::mutex> lC_lock(lCr_queue.mutex);
+      if (lCr_queue.tasks.empty())
+	return false;
+      aCr_task = lCr_queue.tasks.back();
+      lCr_queue.tasks.pop_back();
+      return true;
+    }
+
+    bool ThreadPool::steal(unsigned int ai_index, Task& aCr_task)
+    {
+      std::size_t ll_threads = mC1_queues.size();
+      for (std::size_t i = 1; i < ll_threads; i++) {
+	Queue& lCr_queue = *mC1_queues[(ai_index + i) % ll_threads];
+	std::lock_guard<std::mutex> lC_lock(lCr_queue.mutex);
+	if (!lCr_queue.tasks.empty()) {
+	  aCr_task = lCr_queue.tasks.front();
+	  lCr_queue.tasks.pop_front();
+	  return true;
+	}
+      }
+      return false;
+    }
+
+    void ThreadPool::drain(unsigned int ai_index)
+    {
+      Task lC_task;
+      while (pop(ai_index, lC_task) || steal(ai_index, lC_task))
+	execute(lC_task);
+    }
+
+    void ThreadPool::execute(const Task& aCr_task)
+    {
+      std::exception_ptr lCp_error;
+      try {
+	for (std::size_t i = aCr_task.begin; i < aCr_task.end; i++)
+	  (*aCr_task.body)(i);
+      }
+      catch (...) {
+	lCp_error = std::current_exception();
+      }
+
+      bool lb_done = false;
+      {
+	std::lock_guard<std::mutex> lC_lock(mC_mutex);
+	if (lCp_error && !mCp_error)
+	  mCp_error = lCp_error;
+	ml_pending -= (aCr_task.end - aCr_task.begin);
+	lb_done = (ml_pending == 0);
+      }
+      if (lb_done)
+	mC_finish.notify_all();
+    }
+
+  } // namespace utils
+
+} // namespace efscape
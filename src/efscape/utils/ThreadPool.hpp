@@ -0,0 +1,131 @@
+// __COPYRIGHT_START__
+// Package Name : efscape
+// File Name : ThreadPool.hpp
+// Copyright (C) 2006-2019 Jon C. Cline
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH// REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+// AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+// INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+// LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR// OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+// __COPYRIGHT_END__
+#ifndef EFSCAPE_UTILS_THREADPOOL_HPP
+#define EFSCAPE_UTILS_THREADPOOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace efscape {
+
+  namespace utils {
+
+    /**
+     * Implements a fixed-size, work-stealing thread pool for data-parallel
+     * loops. A loop is split into chunks that are dealt out to per-thread
+     * queues. Each thread works through its own queue from the back and,
+     * when it runs dry, steals chunks from the front of the other queues,
+     * which balances loops whose iterations vary in cost.
+     *
+     * The calling thread takes part in each loop, so a pool of size N
+     * starts N-1 worker threads. Loops must not be nested.
+     */
+    class ThreadPool
+    {
+    public:
+
+      /**
+       * constructor
+       *
+       * @param ai_threads number of threads, including the caller (0 for
+       *                   the number of hardware threads)
+       */
+      explicit ThreadPool(unsigned int ai_threads = 0);
+
+      /** destructor: stops and joins the worker threads */
+      ~ThreadPool();
+
+      /** @returns number of threads, including the caller */
+      unsigned int size() const { return mC1_queues.size(); }
+
+      /**
+       * Calls aCr_body(i) for every i in [0, ai_count) and returns when all
+       * calls have completed. If any call throws, the first exception is
+       * rethrown in the caller once the loop has finished.
+       *
+       * @param ai_count number of iterations
+       * @param aCr_body loop body
+       * @param ai_grain minimum number of iterations per chunk
+       */
+      void parallel_for(std::size_t ai_count,
+			const std::function<void(std::size_t)>& aCr_body,
+			std::size_t ai_grain = 1);
+
+    private:
+
+      ThreadPool(const ThreadPool&);
+      ThreadPool& operator=(const ThreadPool&);
+
+      /** a chunk of loop iterations */
+      struct Task {
+	std::size_t begin;
+	std::size_t end;
+	const std::function<void(std::size_t)>* body;
+      };
+
+      /** a per-thread task queue */
+      struct Queue {
+	std::mutex mutex;
+	std::deque<Task> tasks;
+      };
+
+      void worker(unsigned int ai_index);
+      bool pop(unsigned int ai_index, Task& aCr_task);
+      bool steal(unsigned int ai_index, Task& aCr_task);
+      void drain(unsigned int ai_index);
+      void execute(const Task& aCr_task);
+
+      /** task queues (index 0 belongs to the calling thread) */
+      std::vector< std::unique_ptr<Queue> > mC1_queues;
+
+      /** worker threads */
+      std::vector<std::thread> mC1_threads;
+
+      /** guards the loop state below */
+      std::mutex mC_mutex;
+
+      /** signals workers that a loop has started or the pool is stopping */
+      std::condition_variable mC_start;
+
+      /** signals the caller that the loop has finished */
+      std::condition_variable mC_finish;
+
+      /** loop counter, used to wake workers once per loop */
+      unsigned long ml_generation;
+
+      /** number of iterations not yet completed */
+      std::size_t ml_pending;
+
+      /** first exception thrown by the loop body */
+      std::exception_ptr mCp_error;
+
+      /** whether the pool is stopping */
+      bool mb_stop;
+
+    };				// class ThreadPool
+
+  } // namespace utils
+
+} // namespace efscape
+
+#endif	// #ifndef EFSCAPE_UTILS_THREADPOOL_HPP
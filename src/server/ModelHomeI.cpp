@@ -24,8 +24,13 @@
 
 #include <json/json.h>
 
+#include <boost/filesystem/path.hpp>
+
+#include <algorithm>
 #include <sstream>
 
+namespace fs = boost::filesystem;
+
 /**
  * Create a new efscape::Model proxy from the specified model class name.
  *
@@ -152,16 +157,17 @@ ModelHomeI::createFromParameters(std::string parameters,
 				   const Ice::Current& current)
 {
   try {
-    // attempt create the model
+    // Load JSON from buffer into Json::Value
+    std::stringstream lC_buffer(parameters);
+    Json::Value lC_parameters;
+    lC_buffer >> lC_parameters;
+
+    // attempt create the model (clients requesting the same scenario get
+    // clones of a cached prototype)
     efscape::impl::DEVSPtr lCp_modelI =
-      efscape::impl::Singleton<efscape::impl::ModelHomeI>::Instance().createModelFromParameters(parameters);
+      efscape::impl::Singleton<efscape::impl::ModelHomeI>::Instance().createModelFromPrototype(lC_parameters);
 
     if (lCp_modelI != nullptr) {
-      // Load JSON from buffer into Json::Value
-      std::stringstream lC_buffer(parameters);
-      Json::Value lC_parameters;
-      lC_buffer >> lC_parameters;
-
       // tie the model
       auto modelI =
 	Ice::uncheckedCast<efscape::ModelPrx>(current.adapter
@@ -186,6 +192,58 @@ ModelHomeI::createFromParameters(std::string parameters,
 
 }
 
+/**
+ * Create a new efscape::Model proxy from a model snapshot file saved under
+ * the home directory of the server.
+ *
+ * @param name name of the snapshot file (relative to the home directory)
+ * @param current method invocation
+ * @returns efscape::Model proxy
+ */
+std::shared_ptr<efscape::ModelPrx>
+ModelHomeI::createFromSnapshot(std::string name,
+			       const Ice::Current& current)
+{
+  // only files under the home directory may be restored
+  fs::path lC_name(name);
+  if (name.empty() || lC_name.is_absolute() ||
+      std::find(lC_name.begin(), lC_name.end(), fs::path("..")) !=
+      lC_name.end()) {
+    LOG4CXX_ERROR(efscape::impl::ModelHomeI::getLogger(),
+		  "efscape::server::ModelHomeI::createFromSnapshot(): "
+		  "invalid snapshot name <" << name << ">");
+    return nullptr;
+  }
+
+  try {
+    fs::path lC_path =
+      fs::path(efscape::impl::ModelHomeI::getHomeDir()) / lC_name;
+
+    // attempt to restore the model
+    efscape::impl::DEVSPtr lCp_modelI =
+      efscape::impl::Singleton<efscape::impl::ModelHomeI>::Instance().createModelFromSnapshot(lC_path.string().c_str());
+
+    if (lCp_modelI != nullptr) {
+      auto modelI = Ice::uncheckedCast<efscape::ModelPrx>(current.adapter
+							    ->addWithUUID(std::make_shared<ModelI>(lCp_modelI)));
+
+      return modelI;
+    }
+    else {
+      LOG4CXX_DEBUG(efscape::impl::ModelHomeI::getLogger(),
+		    "efscape::server::ModelHomeI::createFromSnapshot(): unable to restore the model!");
+    }
+  }
+  catch (std::logic_error exp) {
+    LOG4CXX_ERROR(efscape::impl::ModelHomeI::getLogger(),
+		  "efscape::server::ModelHomeI::createFromSnapshot(): "
+		  << exp.what() );
+  }
+
+  return nullptr;
+
+} // ModelHomeI::createFromSnapshot(...)
+
 /**
  * Returns a list of available models.
  *
@@ -54,6 +54,11 @@ public:
   createFromParameters(std::string,
 		       const Ice::Current&) override;
 
+  virtual
+  std::shared_ptr<efscape::ModelPrx>
+  createFromSnapshot(std::string,
+		     const Ice::Current&) override;
+
   virtual
   efscape::ModelNameList getModelList(const Ice::Current&) override;
 
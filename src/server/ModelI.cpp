@@ -19,10 +19,12 @@
 #include <efscape/impl/ModelHomeI.hpp>
 #include <efscape/impl/ModelHomeSingleton.hpp>
 
+#include <efscape/utils/ForkRunner.hpp>
 #include <efscape/utils/type.hpp>
 
 #include <json/json.h>
 #include <fstream>
+#include <sstream>
 
 /**
  * Returns the name of the entity.
@@ -72,8 +74,8 @@ bool ModelI::initialize(const Ice::Current& current)
 
       // now output the initial state of the wrapped model
       adevs::Bag<efscape::impl::IO_Type> xb;
-      efscape::impl::get_output(xb, lCp_model);
-      for (auto i : xb)
+      efscape::impl::get_output(xb, mC_atomics);
+      for (const auto& i : xb)
       {
         adevs::Event<efscape::impl::IO_Type> y(lCp_model, i);
         this->outputEvent(y, 0.0);
@@ -191,6 +193,224 @@ ModelI::outputFunction(const Ice::Current& current)
   return lC_message;
 }
 
+/**
+ * Branches the model from its current state into variants, each of which
+ * receives its own input on the <properties_in> port at the specified time
+ * and is then run until the end time. The events of the session before the
+ * time of the branch are executed in each variant first. Each variant runs
+ * in a child process forked from the server (see
+ * efscape::utils::ForkRunner): the state of the model is shared
+ * copy-on-write rather than cloned, and the model of this session is left
+ * unchanged.
+ *
+ * A child only runs the simulator and writes to its pipe: the Ice runtime
+ * (and any thread of the server) does not exist in the child. Its output
+ * is sent back as lines of <port> TAB <value in JSON>.
+ *
+ * @param time time of the branch
+ * @param variants input of each variant (JSON)
+ * @param timeMax end time of the variants
+ * @param current method invocation
+ * @returns output of each variant (empty if the variant failed)
+ */
+efscape::MessageSeq
+ModelI::branch(double time, efscape::JsonSeq variants, double timeMax,
+	       const Ice::Current& current)
+{
+  efscape::MessageSeq lC1_results;
+  if (!mCp_simulator) {
+    LOG4CXX_ERROR(efscape::impl::ModelHomeI::getLogger(),
+		  "ModelI::branch(): the model has not been initialized");
+    return lC1_results;
+  }
+
+  // the variants receive their input between the current time and the end
+  if ( !(time <= timeMax) ) {
+    LOG4CXX_ERROR(efscape::impl::ModelHomeI::getLogger(),
+		  "ModelI::branch(): the time of the branch (" << time
+		  << ") is after the end time (" << timeMax << ")");
+    return lC1_results;
+  }
+
+  // parse the input of the variants before forking
+  Json::CharReaderBuilder lC_builder;
+  std::unique_ptr<Json::CharReader> lCp_reader(lC_builder.newCharReader());
+  std::vector<Json::Value> lC1_variants(variants.size());
+  for (std::size_t i = 0; i < variants.size(); i++) {
+    std::string lC_errors;
+    const char* lcp_begin = variants[i].c_str();
+    if ( !lCp_reader->parse(lcp_begin, lcp_begin + variants[i].size(),
+			    &lC1_variants[i], &lC_errors) ) {
+      LOG4CXX_ERROR(efscape::impl::ModelHomeI::getLogger(),
+		    "ModelI::branch(): unable to parse variant " << i
+		    << ": " << lC_errors);
+      return lC1_results;
+    }
+  }
+
+  static const efscape::impl::PortType lC_propertiesPort("properties_in");
+
+  Json::StreamWriterBuilder lC_writer;
+  lC_writer["indentation"] = "";
+
+  efscape::utils::ForkRunner lC_runner;
+  std::vector<std::string> lC1_output;
+  try {
+    lC1_output =
+      lC_runner.run
+      (lC1_variants.size(),
+       [&](std::size_t ai_variant, std::ostream& aCr_out) {
+	// writes out the buffered output
+	auto lC_flush = [&]() {
+	  for (const auto& i : mCC_OutputBuffer) {
+	    const Json::Value* lCp_value =
+	      efscape::impl::json_value_cast( &i.value.value );
+	    if (lCp_value)
+	      aCr_out << i.value.port.name() << '\t'
+		      << Json::writeString(lC_writer, *lCp_value) << '\n';
+	  }
+	  mCC_OutputBuffer.clear();
+	};
+
+	// advance to the time of the branch: the output of the session
+	// before the branch is not part of the variant
+	while (mCp_simulator->nextEventTime() < time)
+	  mCp_simulator->execNextEvent();
+	mCC_OutputBuffer.clear();
+
+	adevs::Bag< adevs::Event<efscape::impl::IO_Type> > lC_input;
+	lC_input.insert
+	  ( adevs::Event<efscape::impl::IO_Type>
+	    (mCp_WrappedModel.get(),
+	     efscape::impl::IO_Type(lC_propertiesPort,
+				    lC1_variants[ai_variant])) );
+	mCp_simulator->computeNextState(lC_input, time);
+
+	while (mCp_simulator->nextEventTime() < timeMax) {
+	  mCp_simulator->execNextEvent();
+	  lC_flush();
+	}
+
+	// output of the final state
+	adevs::Bag<efscape::impl::IO_Type> xb;
+	efscape::impl::get_output(xb, mC_atomics);
+	for (const auto& i : xb)
+	  if (mC_ports.accepts(i.port))
+	    bufferFinalOutput(i);
+	if (mCp_reducer)
+	  mCp_reducer->flush();
+	lC_flush();
+      });
+  }
+  catch (const std::logic_error& lC_exp) {
+    LOG4CXX_ERROR(efscape::impl::ModelHomeI::getLogger(),
+		  "ModelI::branch(): " << lC_exp.what());
+    return lC1_results;
+  }
+
+  // convert the output of each variant
+  lC1_results.resize(lC1_output.size());
+  for (std::size_t i = 0; i < lC1_output.size(); i++) {
+    if (lC_runner.status()[i] != 0) {
+      LOG4CXX_ERROR(efscape::impl::ModelHomeI::getLogger(),
+		    "ModelI::branch(): variant " << i << " failed (status "
+		    << lC_runner.status()[i] << ")");
+      continue;
+    }
+
+    std::istringstream lC_lines(lC1_output[i]);
+    std::string lC_line;
+    while (std::getline(lC_lines, lC_line)) {
+      std::size_t li_tab = lC_line.find('\t');
+      if (li_tab == std::string::npos)
+	continue;
+      efscape::Content lC_content;
+      lC_content.port = lC_line.substr(0, li_tab);
+      lC_content.valueToJson = lC_line.substr(li_tab + 1);
+      lC1_results[i].push_back(lC_content);
+    }
+  }
+
+  return lC1_results;
+
+} // ModelI::branch(...)
+
+/**
+ * Subscribes to the output on the specified ports: output on other ports is
+ * dropped as it is produced, before it is converted to JSON. An empty list
+ * subscribes to all ports (the default).
+ *
+ * @param ports names of the ports
+ * @param current method invocation
+ */
+void
+ModelI::subscribe(efscape::PortNameSeq ports, const Ice::Current& current)
+{
+  mC_ports = efscape::impl::PortFilter(ports);
+  LOG4CXX_DEBUG(efscape::impl::ModelHomeI::getLogger(),
+		"ModelI::subscribe(): output on "
+		<< (mC_ports.empty() ? std::string("all") :
+		    std::to_string(mC_ports.size()))
+		<< " ports");
+
+  // drop buffered output the client has not yet retrieved
+  if (!mC_ports.empty()) {
+    adevs::Bag< adevs::Event<efscape::impl::IO_Type> > lCC_buffer;
+    for (const auto& i : mCC_OutputBuffer)
+      if (mC_ports.accepts(i.value.port))
+	lCC_buffer.insert(i);
+    mCC_OutputBuffer = lCC_buffer;
+  }
+} // ModelI::subscribe(...)
+
+/**
+ * Sets the reducers of the output of high-rate ports (see
+ * efscape::impl::OutputReducer), which decimate or aggregate the output
+ * before it is converted to JSON. An empty string removes the reducers.
+ *
+ * @param reducers reducer of each port (JSON object)
+ * @param current method invocation
+ * @returns whether the reducers were set
+ */
+bool
+ModelI::reduce(std::string reducers, const Ice::Current& current)
+{
+  if (reducers.empty()) {
+    mCp_reducer.reset();
+    return true;
+  }
+
+  Json::Value lC_config;
+  Json::CharReaderBuilder lC_builder;
+  std::unique_ptr<Json::CharReader> lCp_reader(lC_builder.newCharReader());
+  std::string lC_errors;
+  if ( !lCp_reader->parse(reducers.c_str(), reducers.c_str() + reducers.size(),
+			  &lC_config, &lC_errors) ) {
+    LOG4CXX_ERROR(efscape::impl::ModelHomeI::getLogger(),
+		  "ModelI::reduce(): unable to parse the reducers: "
+		  << lC_errors);
+    return false;
+  }
+
+  try {
+    mCp_reducer.reset
+      ( new efscape::impl::OutputReducer
+	(lC_config,
+	 [this](const efscape::impl::IO_Type& aCr_value, double) {
+	  mCC_OutputBuffer.insert
+	    (adevs::Event<efscape::impl::IO_Type>(mCp_WrappedModel.get(),
+						  aCr_value));
+	}) );
+  }
+  catch (const std::exception& lC_exp) {
+    LOG4CXX_ERROR(efscape::impl::ModelHomeI::getLogger(),
+		  "ModelI::reduce(): " << lC_exp.what());
+    return false;
+  }
+
+  return true;
+} // ModelI::reduce(...)
+
 /**
  * Returns the type of the model.
  *
@@ -291,7 +511,12 @@ ModelI::~ModelI() {}
  */
 void ModelI::outputEvent(adevs::Event<efscape::impl::IO_Type> x, double t)
 {
-  mCC_OutputBuffer.insert(x);
+  if (!mC_ports.accepts(x.value.port))
+    return;
+  if (mCp_reducer)
+    mCp_reducer->push(x.value, t);
+  else
+    mCC_OutputBuffer.insert(x);
 } // end of ModelI::outputEvent(...)
 
 /**
@@ -308,9 +533,48 @@ ModelI::translateInput(const Ice::Current& aCr_current,
 			 adevs::Bag<adevs::Event<efscape::impl::IO_Type> >&
 			 aCr_internal_input)
 {
-  /** @todo Convert JSON inputs into Json::Value objects */
+  Json::CharReaderBuilder lC_builder;
+  std::unique_ptr<Json::CharReader> lCp_reader(lC_builder.newCharReader());
+
+  for (const auto& i : aCr_external_input) {
+    // resolve the port name once; the symbol is shared by every event
+    // created from this content
+    efscape::impl::PortType lC_port(i.port);
+
+    Json::Value lC_value;
+    std::string lC_errors;
+    const char* lcp_begin = i.valueToJson.c_str();
+    if ( !lCp_reader->parse(lcp_begin, lcp_begin + i.valueToJson.size(),
+			    &lC_value, &lC_errors) ) {
+      LOG4CXX_ERROR(efscape::impl::ModelHomeI::getLogger(),
+		    "Unable to parse input on port <"
+		    << lC_port << ">: " << lC_errors);
+      continue;
+    }
+
+    aCr_internal_input.insert(adevs::Event<efscape::impl::IO_Type>
+			      (mCp_WrappedModel.get(),
+			       efscape::impl::IO_Type(lC_port, lC_value)));
+  }
 }
 
+/**
+ * Buffers output of the final model state, through the reducers if any (at
+ * the time of the latest output).
+ *
+ * @param aCr_value output value
+ */
+void
+ModelI::bufferFinalOutput(const efscape::impl::IO_Type& aCr_value)
+{
+  if (mCp_reducer)
+    mCp_reducer->push(aCr_value, mCp_reducer->time());
+  else
+    mCC_OutputBuffer.insert
+      (adevs::Event<efscape::impl::IO_Type>(mCp_WrappedModel.get(),
+					    aCr_value));
+} // ModelI::bufferFinalOutput(...)
+
 /**
  * Converts messages from the wrapped model for output.
  *
@@ -334,26 +598,33 @@ void ModelI::translateOutput(const Ice::Current& aCr_current,
 		  "Done with simulation! Need to retrieve final output...");
     
     adevs::Bag<efscape::impl::IO_Type> xb;
-    efscape::impl::get_output(xb, mCp_WrappedModel.get());
+    efscape::impl::get_output(xb, mC_atomics);
+
+    // reduced output is passed on with the buffered output (below)
+    if (mCp_reducer) {
+      for (const auto& i : xb)
+	if (mC_ports.accepts(i.port))
+	  bufferFinalOutput(i);
+      mCp_reducer->flush();
+      xb.clear();
+    }
+
     // adevs::Bag<efscape::impl::IO_Type>::iterator i = xb.begin();
     // for (auto i = xb.begin(); i != xb.end(); i++) {
-    for (auto i : xb) {
-      try {
-	Json::Value lC_value =
-	  boost::any_cast<Json::Value>( i.value );
-
+    for (const auto& i : xb) {
+      if (!mC_ports.accepts(i.port))
+	continue;
+      const Json::Value* lCp_value =
+	efscape::impl::json_value_cast( &i.value );
+      if (lCp_value) {
 	efscape::Content lC_content;
-	lC_content.port = i.port;
+	lC_content.port = i.port.name();
 	
 	std::ostringstream lC_buffer_out;
-	lC_buffer_out << lC_value;
+	lC_buffer_out << *lCp_value;
 	lC_content.valueToJson = lC_buffer_out.str();
 
 	aCr_external_output.push_back( lC_content );
-
-      }
-      catch(const boost::bad_any_cast &) {
-	;
       }
     }
   }
@@ -364,24 +635,23 @@ void ModelI::translateOutput(const Ice::Current& aCr_current,
   
   // adevs::Bag< adevs::Event<efscape::impl::IO_Type> >::iterator
   //   i = mCC_OutputBuffer.begin();
-  for (auto i : mCC_OutputBuffer) {
+  for (const auto& i : mCC_OutputBuffer) {
     LOG4CXX_DEBUG(efscape::impl::ModelHomeI::getLogger(),
 		  "Processing event on port<"
 		  << i.value.port << ">...");
-    try {
-      Json::Value lC_value =
-	boost::any_cast<Json::Value>( i.value.value );
-
+    const Json::Value* lCp_value =
+      efscape::impl::json_value_cast( &i.value.value );
+    if (lCp_value) {
       efscape::Content lC_content;
-      lC_content.port = i.value.port;
+      lC_content.port = i.value.port.name();
 	
       std::ostringstream lC_buffer_out;
-      lC_buffer_out << lC_value;
+      lC_buffer_out << *lCp_value;
       lC_content.valueToJson = lC_buffer_out.str();
 
       aCr_external_output.push_back( lC_content );
     }
-    catch (const boost::bad_any_cast &) {
+    else {
       LOG4CXX_DEBUG(efscape::impl::ModelHomeI::getLogger(),
 		    "Unable to translate output");
     }
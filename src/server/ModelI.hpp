@@ -21,6 +21,9 @@
 #include <efscape/Model.h>
 
 #include <efscape/impl/efscapelib.hpp>
+#include <efscape/impl/AtomicIndex.hpp>
+#include <efscape/impl/OutputReducer.hpp>
+#include <efscape/impl/PortFilter.hpp>
 #include <json/json.h>
 
 /**
@@ -61,6 +64,17 @@ public:
 
   virtual efscape::Message outputFunction(const Ice::Current&) override;
 
+  virtual efscape::MessageSeq branch(double,
+				     efscape::JsonSeq,
+				     double,
+				     const Ice::Current&) override;
+
+  virtual void subscribe(efscape::PortNameSeq,
+			 const Ice::Current&) override;
+
+  virtual bool reduce(std::string,
+		      const Ice::Current&) override;
+
   virtual std::string getType(const Ice::Current&) const override;
   virtual void setName(std::string,
 		       const Ice::Current&) override;
@@ -83,6 +97,7 @@ public:
    */
   void setWrappedModel(const efscape::impl::DEVSPtr& aCp_model) {
     mCp_WrappedModel = aCp_model;
+    mC_atomics.reset(aCp_model.get());
   }
 
   /** @returns handle to associated model */
@@ -101,6 +116,8 @@ protected:
 		      adevs::Bag<adevs::Event<efscape::impl::IO_Type> >&
 		      aCr_internal_input);
 
+  void bufferFinalOutput(const efscape::impl::IO_Type& aCr_value);
+
   /** handle to simulator */
   std::unique_ptr< adevs::Simulator<efscape::impl::IO_Type> >
   mCp_simulator;
@@ -108,9 +125,18 @@ protected:
   /** handle to model */
   efscape::impl::DEVSPtr mCp_WrappedModel;
 
+  /** flattened index of the wrapped model's atomic components */
+  efscape::impl::AtomicIndex mC_atomics;
+
   /** output buffer */
   adevs::Bag< adevs::Event<efscape::impl::IO_Type> > mCC_OutputBuffer;
 
+  /** ports the client subscribes to (empty: all ports) */
+  efscape::impl::PortFilter mC_ports;
+
+  /** reducers of the output of high-rate ports (null: none) */
+  std::unique_ptr<efscape::impl::OutputReducer> mCp_reducer;
+
   /** model metadata (may include scenario/session-specific info) */
   Json::Value mC_info;
 